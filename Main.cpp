@@ -1,9 +1,43 @@
 #include <iostream>
 #include <vector>
+#include <deque>
+#include <list>
+#include <map>
 #include <queue>
+#include <set>
+#include <unordered_map>
 #include <unordered_set>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <climits>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
 #include <math.h>
+#include <fcntl.h>
+#include <linux/perf_event.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
+#include <termios.h>
 #include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MAZE_X86 1
+#endif
 
 using namespace std;
 
@@ -15,6 +49,7 @@ using namespace std;
 #define SYMBOL_CURSER '+'
 #define SYMBOL_EXPLORED '@'
 #define SYMBOL_VISITED '*'
+#define SYMBOL_FRONTIER 'o'
 
 // Buffer clear bits for Game Class 
 #define BUFFER_BIT_EXPLORED 1<<0
@@ -23,6 +58,11 @@ using namespace std;
 #define BUFFER_BIT_PARENT 1<<3
 #define BUFFER_ALL_BIT BUFFER_BIT_EXPLORED | BUFFER_BIT_VISITED | BUFFER_BIT_COST | BUFFER_BIT_PARENT
 
+// Default cell layout of the board (ROW_MAJOR, TILED or MORTON), e.g. -DMAZE_LAYOUT=MORTON 
+#ifndef MAZE_LAYOUT
+#define MAZE_LAYOUT ROW_MAJOR
+#endif
+
 // Class (or struct) declaration section -->
 struct Position
 {
@@ -48,18 +88,56 @@ public:
     void setPosition(Position pos);
 
     friend class NodeHandle;
+    friend class MazeGenerator;
+};
+// The board's Nodes in one block, in one of three orders: row-major, 8x8 tiles, or Morton 
+// (Z-order) inside 64x64 tiles, so neighbours above and below share cache lines and pages. 
+// board[row][col] picks the Node wherever the layout put it, so code indexing the board 
+// does not know which layout it runs on. Tiled layouts pad the block to whole tiles. 
+class Board
+{
+public:
+    enum Layout {ROW_MAJOR, TILED, MORTON};
+
+private:
+    Node *cells;
+    int size, tiles_per_row;
+    Layout layout;
+
+    static size_t spread(size_t bits);
+
+public:
+    class Row
+    {
+        const Board &board;
+        int row;
+
+    public:
+        Row(const Board &board, int row);
+        Node& operator [] (int col) const;
+    };
+
+    Board();
+    Board(int size, Layout layout);
+    Node* begin() const;
+    Node* end() const;
+    size_t getCellCount() const;
+    Layout getLayout() const;
+    static string getName(Layout layout);
+    size_t index(int row, int col) const;
+    Row operator [] (int row) const;
+    void release();
 };
 class NodeHandle
 {
     Node* node;
-    static NodeHandle *start, *end;
 public:
 
     NodeHandle(Node *ptr=NULL);
     NodeHandle(Node& node);
     float getGCost() const;
-    float getHCost() const;
-    float getFCost() const;
+    float getHCost(const NodeHandle &goal) const;
+    float getFCost(const NodeHandle &goal) const;
     Node* getParent();
     Position getPosition() const;
     void insertWall();
@@ -85,1188 +163,12597 @@ public:
 
 };
 
-NodeHandle* NodeHandle::start=NULL;
-NodeHandle* NodeHandle::end=NULL;
 
 class Result
 {
     string algorithm;
     int search_cost, path_cost;
     string status;
+    float bound;                // suboptimality bound of the path, 0 when not reported 
+    double first_solution_ms;   // -1 when not reported 
+    bool budget_exhausted;
 
 public:
     Result();
     void reset();
+    int getPathCost() const;
+    int getSearchCost() const;
     void incSearchCost();
+    void addSearchCost(long long count);
     void incPathCost();
     void display();
+    bool isBudgetExhausted() const;
+    bool isCancelled() const;
+    void setBound(float bound);
+    void setBudgetExhausted(bool found);
+    void setFirstSolutionMs(double ms);
     void setSuccess();
     void setFailure();
+    void setCancelled();
+    void setCached(bool found);
     void setAlgorithm(string algo);
 
 };
 
-class Game
+// Deterministic pseudo random generator (splitmix64), so that a seed gives the same board everywhere 
+struct Random
+{
+    uint64_t state;
+
+    Random(uint64_t seed=0);
+    uint64_t next();
+    uint32_t nextInt(uint32_t bound);
+    float nextFloat();
+    static uint64_t mix(uint64_t seed, uint64_t stream);
+};
+
+class MazeGenerator
 {
+public:
+    enum GeneratorType {RECURSIVE_BACKTRACKER, PRIM, KRUSKAL, CELLULAR_AUTOMATA, ROOMS_AND_CORRIDORS, RANDOM_FILL};
+
 private:
-    Node** board;
+    Board board;
     int size;
-    bool should_close;
-    NodeHandle curser, start, end;
-    enum GameEnum {EDIT, PATH_FINDING, MENU, SETTINGS} gameMode;
-    enum CurserMode {SELECT, INSERT_WALL, REMOVE_WALL} curserMode;
-    bool diagonalMovesAllowed;
-    Result result;
+    uint64_t seed;
 
+    void carveCell(uint32_t cell);
+    void carvePassage(uint32_t from, uint32_t to);
+    void carveRect(int row, int col, int height, int width);
+    void fill(bool walkable);
+    int mazeCols() const;
+    int mazeRows() const;
 
 public:
-    Game(int size=10);
-    void applyCurser();
-    void aStarSearch();
-    bool breadthFirstSearch();
-    void changeCurserMode(CurserMode mode);
-    void clean();
-    void clearBuffer(int buffer_clear_bit);
-    bool depthFirstSearch(NodeHandle &curr);
-    bool bestFirstSearch();
-    void display();
-    void displayEditControls();
-    void displayEditUI();
-    void displayEditMode();
-    void displayGameState();
-    void displayPath();
-    void enterEditMode();
-    void exitGame();
-    void findPath();
-    static float getChessBoardDistance(const NodeHandle src, const NodeHandle end);
-    string getCurserMode();
-    static float getEuclidianDistance(const NodeHandle src, const NodeHandle end);
-    void getInput();
-    static float getManhattanDistance(const NodeHandle src, const NodeHandle end);
-    bool greedyBestFirstSearch();
-    vector<NodeHandle> getNeighbours(const NodeHandle &curr);
-    bool isOutOfBounds(Position curr) const;
-    void moveUp();
-    void moveDown();
-    void moveLeft();
-    void moveRight();
-    void putEnd();
-    void putStart();
-    void retracePath();
-    bool shouldClose();
-    void updateNeighbourCost(NodeHandle curr);
+    MazeGenerator(Board board, int size, uint64_t seed);
+    void cellularAutomata(float density, int iterations=4);
+    void generate(GeneratorType type, float density=0.45f);
+    static string getName(GeneratorType type);
+    void kruskal();
+    void randomFill(float density);
+    void randomizedPrim();
+    void recursiveBacktracker();
+    void roomsAndCorridors();
 };
 
-
-// Main program logic -->
-int main(int argc, char** argv)
+// Open addressing map from a (cell, time step) pair to an int, clear() only touches the used slots 
+class SpaceTimeTable
 {
+    vector<uint64_t> keys;
+    vector<int> values;
+    vector<size_t> used;
+    size_t mask;
+    int shift;
 
-    // Create a game object and initialize it 
-    Game game(30);
+    static const uint64_t EMPTY = ~0ULL;
+    size_t findSlot(uint64_t key) const;
+    void grow();
 
-    // Rendering Loop 
-    while(!game.shouldClose())
-    {
-        // clear the screen 
-        system("clear");
+public:
+    SpaceTimeTable(int capacity_bits=10);
+    void clear();
+    int get(uint32_t cell, uint32_t time) const;
+    void put(uint32_t cell, uint32_t time, int value);
+    size_t size() const;
+};
 
-        // Display game and menu
-        game.display();
-        
-        // Get input and execute them 
-        game.getInput();                // blocking call
-    }
+// Open list policies. Every policy stores the priority given at push time (key, then tie, 
+// smaller first) and hands out Items, so any search can be paired with any policy at 
+// compile time; the flat grid engines take one over int cells, GameSearch over NodeHandles. 
+// forEach() visits the queued Items in no particular order. The bucket based policies 
+// quantize the key and assume it never drops below the last popped key (true for f in A* 
+// with a consistent heuristic and for g); a smaller key is clamped to the current minimum 
+// and ties are not ordered. Each policy says so with MONOTONE, and KEY_STEP is the width 
+// its keys are quantized to, 0 if exact. 
+template<typename Item>
+struct OpenListEntry
+{
+    Item item;
+    float key, tie;
 
+    bool operator < (const OpenListEntry &other) const;
+};
 
-    // Clean and Exit the game 
-    game.clean();
+// Implicit D-ary heap in one vector 
+template<typename Item, int D>
+class DAryHeapOpenList
+{
+    vector<OpenListEntry<Item> > heap;
 
+public:
+    static constexpr bool MONOTONE = false;
+    static constexpr float KEY_STEP = 0;
+
+    void clear();
+    bool empty() const;
+    template<typename Function>
+    void forEach(Function fn) const;
+    Item pop();
+    void push(const Item &item, float key, float tie=0);
+    size_t size() const;
+};
 
-    return 0;
-}
+template<typename Item>
+using BinaryHeapOpenList = DAryHeapOpenList<Item, 2>;
+template<typename Item>
+using QuaternaryHeapOpenList = DAryHeapOpenList<Item, 4>;
 
-// Helper class/struct
-struct NodeHandleHashFunction
+// Pairing heap, nodes live in a pool and are recycled through a free list 
+template<typename Item>
+class PairingHeapOpenList
 {
-    int operator() (const NodeHandle &nodeHandle) const
+    struct HeapNode
     {
-        return (nodeHandle.getPosition().row)^(nodeHandle.getPosition().col);
-    }
+        OpenListEntry<Item> entry;
+        int child, sibling;
+    };
+    vector<HeapNode> nodes;
+    vector<int> free_nodes, pairs;
+    int root;
+    size_t count;
+
+    int meld(int a, int b);
+
+public:
+    static constexpr bool MONOTONE = false;
+    static constexpr float KEY_STEP = 0;
+
+    PairingHeapOpenList();
+    void clear();
+    bool empty() const;
+    template<typename Function>
+    void forEach(Function fn) const;
+    Item pop();
+    void push(const Item &item, float key, float tie=0);
+    size_t size() const;
 };
 
-struct NodeHandleComparatorFCost
+// Monotone radix heap over keys quantized to 1/256 
+template<typename Item>
+class RadixHeapOpenList
 {
-    bool operator() (const NodeHandle &lhs, const NodeHandle &rhs) const 
-    {
-        if(lhs.getFCost() > rhs.getFCost())
-            return true;
-        else if((lhs.getFCost() == rhs.getFCost()) && (lhs.getHCost() > rhs.getHCost()) )
-            return true;
-        else 
-            return false;
-    }
+    vector<OpenListEntry<Item> > buckets[33];
+    vector<uint32_t> bucket_keys[33];
+    uint32_t last;
+    size_t count;
+
+    static int bucketOf(uint32_t key, uint32_t last);
+    static uint32_t quantize(float key);
+
+public:
+    static constexpr bool MONOTONE = true;
+    static constexpr float KEY_STEP = 1.0f/256;
+
+    RadixHeapOpenList();
+    void clear();
+    bool empty() const;
+    template<typename Function>
+    void forEach(Function fn) const;
+    Item pop();
+    void push(const Item &item, float key, float tie=0);
+    size_t size() const;
 };
 
-struct NodeHandleComparatorGCost
+// One bucket per 1/16 of a cost unit, scanned by a cursor that only moves forward; a bucket 
+// pops its newest item first, the tie key is not stored 
+template<typename Item>
+class BucketQueueOpenList
 {
-    bool operator() (const NodeHandle &lhs, const NodeHandle &rhs) const 
-    {
-        return lhs.getGCost() > rhs.getGCost();
-    }
+    vector<vector<Item> > buckets;
+    size_t cursor, count;
+
+public:
+    static constexpr bool MONOTONE = true;
+    static constexpr float KEY_STEP = 1.0f/16;
+
+    BucketQueueOpenList();
+    void clear();
+    bool empty() const;
+    template<typename Function>
+    void forEach(Function fn) const;
+    Item pop();
+    void push(const Item &item, float key, float tie=0);
+    size_t size() const;
 };
 
-struct NodeHandleComparatorHCost
+// Two level bucket queue: coarse buckets of 64 fine buckets, only the coarse bucket under 
+// the cursor is split into fine ones, so sparse wide key ranges stay cheap; ties pop newest 
+// first like the single level queue 
+template<typename Item>
+class TwoLevelBucketOpenList
 {
-    bool operator() (const NodeHandle &lhs, const NodeHandle &rhs) const 
-    {
-        return lhs.getHCost() > rhs.getHCost();
-    }
+    vector<vector<pair<uint32_t, Item> > > coarse;
+    vector<Item> fine[64];
+    size_t coarse_cursor, fine_cursor, count;
+
+public:
+    static constexpr bool MONOTONE = true;
+    static constexpr float KEY_STEP = 1.0f/16;
+
+    TwoLevelBucketOpenList();
+    void clear();
+    bool empty() const;
+    template<typename Function>
+    void forEach(Function fn) const;
+    Item pop();
+    void push(const Item &item, float key, float tie=0);
+    size_t size() const;
 };
 
+// Search algorithms selectable from the path finding menu, in menu order 
+enum SearchAlgorithm {DEPTH_FIRST_SEARCH, BREADTH_FIRST_SEARCH, BEST_FIRST_SEARCH, GREEDY_BEST_FIRST_SEARCH, A_STAR_SEARCH, THETA_STAR_SEARCH, LAZY_THETA_STAR_SEARCH,
+                      WEIGHTED_A_STAR_SEARCH, ARA_STAR_SEARCH, SUBGOAL_GRAPH_SEARCH, JUNCTION_GRAPH_SEARCH, PORTFOLIO_SEARCH, ADAPTIVE_A_STAR_SEARCH,
+                      MEMORY_BOUNDED_SEARCH};
 
-// Game Method definations --> 
-Game::Game(int size)
+// Hard limit for the anytime searches, -1 means no limit 
+struct SearchBudget
 {
-    this->size=size;
-    should_close = false;
-
-    diagonalMovesAllowed = true;
+    long long max_expansions, max_micros;
 
-    // Create the board
-    board = new Node*[size];
-    for(int i=0; i<size; i++)
-    {
-        board[i] = new Node[size];
-        for(int j=0; j<size; j++)
-        {
-            board[i][j].setPosition(Position(i, j));            
-        }
-    }
+    SearchBudget(long long max_expansions=-1, long long max_micros=-1);
+};
 
+// Inclusive bounding box of cells 
+struct Bounds
+{
+    int top, left, bottom, right;
 
-    // Initialize the board 
-    start.setNodeHandle(board[size/5][size/5]);
-    end.setNodeHandle(board[size/3][size/2]);
-    curser.setNodeHandle(board[size/2][size/2]);
+    Bounds();
+    bool contains(Position pos, int margin=0) const;
+    void include(Position pos);
+    bool isEmpty() const;
+};
 
-    NodeHandle::start = &start;
-    NodeHandle::end = &end;
+struct PathQuery
+{
+    Position start, end;
+    int algorithm;
+    bool diagonal;
 
-    // set cost of start as zero
-    start.setGCost(0);    
+    PathQuery(Position start=Position(), Position end=Position(), int algorithm=0, bool diagonal=true);
+    bool operator == (const PathQuery &other) const;
+};
 
-}
-void Game::applyCurser()
+struct PathQueryHashFunction
 {
-    if(curserMode == CurserMode::INSERT_WALL)
-        curser.insertWall();
-    else if(curserMode == CurserMode::REMOVE_WALL)
-        curser.removeWall();
-}
-void Game::aStarSearch()
+    size_t operator() (const PathQuery &query) const;
+};
+
+// Owned path buffer: the start cell plus run-length encoded moves. A run is one byte, the low
+// 3 bits hold the direction (N, NE, E, SE, S, SW, W, NW) and the high 5 bits the steps (1..31).
+// A zero byte escapes a jump to a cell that is not a neighbour (any-angle waypoints) and is
+// followed by the int16 row and col offsets. Iterators expand the positions lazily.
+class CompactPath
 {
-    priority_queue<NodeHandle, vector<NodeHandle>,  NodeHandleComparatorFCost> openList;
-    unordered_set<NodeHandle, NodeHandleHashFunction> open;
-    openList.push(start);
+public:
+    class Iterator
+    {
+        const uint8_t *runs;
+        size_t offset;
+        int index, length, left, direction;
+        Position pos;
+
+    public:
+        Iterator(const uint8_t *runs=NULL, int index=0, int length=0, Position pos=Position());
+        bool operator != (const Iterator &other) const;
+        const Position& operator * () const;
+        Iterator& operator ++ ();
+    };
+    static const int MAX_RUN = 31;
+    static const int DROW[8], DCOL[8];
+    static const size_t HEADER_BYTES = 8;   // uint16 start row and col, uint32 length
 
-    while(!openList.empty())
+private:
+    Position start, last;
+    int length;                 // positions, 0 when there is no path
+    int last_run;               // offset of the last run byte, -1 after a jump
+    vector<uint8_t> runs;
+
+    static int directionOf(int drow, int dcol);
+
+public:
+    CompactPath();
+    CompactPath(const vector<Position> &path);
+    void append(Position pos);
+    Iterator begin() const;
+    void clear();
+    bool decode(const uint8_t *data, size_t bytes);
+    void encode(string &out) const;
+    bool empty() const;
+    Iterator end() const;
+    size_t getByteSize() const;
+    Position getEnd() const;
+    float getLength() const;
+    Position getStart() const;
+    bool load(const string &file);
+    void reverse();
+    bool save(const string &file) const;
+    int size() const;
+    vector<Position> toVector() const;
+};
+
+// LRU cache of search results, tagged with the board version they were computed on. 
+// Wall edits invalidate only the entries they can affect: 
+//  - a new wall only breaks paths that run through it (costs can only grow elsewhere), 
+//  - a removed wall only matters if the search could have seen it, i.e. it lies in the 
+//    explored bounding box grown by one cell (failed searches explored their whole component). 
+class PathCache
+{
+public:
+    struct Entry
     {
+        PathQuery query;
+        CompactPath path;           // empty when there is no path 
+        Bounds path_bounds, explored_bounds;
+        uint64_t version;
+        size_t bytes;
+    };
 
-        NodeHandle curr = openList.top();
-        openList.pop();
-        open.erase(curr);
-        curr.markAsExplored();
+private:
+    list<Entry> entries;            // most recently used first 
+    unordered_map<PathQuery, list<Entry>::iterator, PathQueryHashFunction> index;
+    size_t budget, bytes;
+    long long hits, misses, invalidations, evictions;
 
-        result.incSearchCost();
+    void erase(list<Entry>::iterator it);
 
-        // Display the progress and add a delay 
-        system("clear");
-        cout<<"Finding a path ... "<<endl;
-        displayGameState();
-        usleep(50000);
+public:
+    PathCache(size_t budget_bytes = 16u<<20);
+    void clear();
+    void display() const;
+    size_t getBytes() const;
+    long long getEvictions() const;
+    long long getHits() const;
+    long long getInvalidations() const;
+    long long getMisses() const;
+    const Entry* lookup(const PathQuery &query, uint64_t version);
+    void onWallInserted(Position pos, uint64_t version);
+    void onWallRemoved(Position pos, uint64_t version);
+    void setBudget(size_t budget_bytes);
+    void store(const PathQuery &query, uint64_t version, const vector<Position> &path, const Bounds &explored);
+};
 
+struct Agent
+{
+    Position start, goal;
+    vector<Position> path;      // one position per time step, path[0] is start 
 
-        // if current is the target node 
-            // return 
-        if(curr == end)
-        {
-            retracePath();
-            result.setSuccess();
-            return;
-        }
-        
-        // for each neighbour of the current node 
-            // if neighbour is not traversable OR neighbour is in Closed 
-            //     skip to the next neighbour 
-            
-            // if new path to neighbour is shorter OR neighbour is not in Open
-            //     set f_cost of neighbour 
-            //     set parent of neighbour 
-            //     if neighbour is not in Open  
-            //         add neighbour to Open  
-        vector<NodeHandle> neighbourList = getNeighbours(curr);
-        for(int i=0; i<neighbourList.size(); i++)
-        {
-            NodeHandle &neighbour = neighbourList[i];
+    Agent(Position start=Position(), Position goal=Position());
+};
 
-            if(!neighbour.isWalkable() || neighbour.isExplored())
-                continue;
-            
-            float new_cost_to_neighbour;
-            new_cost_to_neighbour = curr.getGCost() + getChessBoardDistance(curr, neighbour);
-            if(new_cost_to_neighbour < neighbour.getGCost() || open.find(neighbour) == open.end())
-            {
-                neighbour.setGCost(new_cost_to_neighbour);
-                neighbour.setParent(curr);
-                // no need to set f cost as it is calculated dynamically 
-                if(open.find(neighbour) == open.end())
-                {
-                    openList.push(neighbour);
-                    open.insert(neighbour);
-                }
-            }
-        }
+struct MultiAgentStats
+{
+    int agents, reached, makespan;
+    long long sum_of_costs;
+    long long reservation_blocks;       // successors rejected by the reservation table 
+    long long conflicts_avoided;        // conflicts independent shortest paths would have had 
+    long long residual_conflicts;       // conflicts left in the cooperative plan, should be 0 
+    double plan_ms;
+
+    MultiAgentStats();
+    double agentsPerSecond() const;
+    void display() const;
+};
 
-    }
+// Keyboard input through termios (no echo, no line buffering) and poll, 
+// instead of forking stty around every key press 
+class Terminal
+{
+    termios original;
+    bool raw, interactive, closed;
 
-    result.setFailure();
-}
+public:
+    enum {KEY_READY = 1, FD_READY = 2};
+
+    Terminal();
+    ~Terminal();
+    static void clearScreen();
+    static void getSize(int &rows, int &cols);
+    bool isClosed() const;
+    int readKey(int timeout_ms=-1);
+    void setRawMode(bool enable);
+    int waitForInput(int fd, int timeout_ms);
+};
 
-bool Game::breadthFirstSearch()
+// Walls, explored and visited cells counted per TILE x TILE tile, kept up to date by the 
+// Game as it marks cells, so a minimap of the whole board reads one entry per tile 
+// instead of visiting every cell 
+class TileSummary
 {
-    // Declare and Initialize data-structures
-    queue<NodeHandle> que;
-    unordered_set<NodeHandle, NodeHandleHashFunction> open;
-    que.push(start);
-    open.insert(start);
-    start.markAsExplored();
+public:
+    enum Mark {WALL, EXPLORED, VISITED, MARKS};
+    static constexpr int TILE = 16;
 
-    while(!que.empty())
+    struct Counts
     {
-        // get the first node from the list
-        NodeHandle curr = que.front();
+        long long cells;
+        long long marks[MARKS];
+    };
 
-        // increment the search cost
-        result.incSearchCost();
+private:
+    int size, tiles_per_row;
+    vector<uint16_t> counts;            // MARKS entries per tile, tiles in row-major order 
 
-        
-        // Display the progress and add a delay 
-        system("clear");
-        cout<<"Finding a path ... "<<endl;
-        displayGameState();
-        usleep(50000);
-            
-        
-        // check if its the end node 
-        if(curr == end) 
-        {
-            retracePath();
-            result.setSuccess();
-            return true;
-        }
-        
-        // update its neighbours
-        updateNeighbourCost(curr);
+public:
+    TileSummary(int size=0);
+    void add(Position pos, Mark mark, int delta);
+    void clear(Mark mark);
+    int getTilesPerRow() const;
+    void rebuild(const Board &board);
+    Counts sum(int tile_top, int tile_left, int tile_bottom, int tile_right) const;
+};
 
-        // push its neighbours 
-        vector<NodeHandle> neighbours = getNeighbours(curr);
-        for(int i=0; i<neighbours.size(); i++)
-        {
-            
-            if(!neighbours[i].isWalkable() || open.find(neighbours[i]) != open.end() || neighbours[i].isExplored()) 
-                continue;
-            
-            que.push(neighbours[i]);
-            open.insert(neighbours[i]);
-        }
+// The part of the board a frame shows. Boards up to WHOLE cells, or small enough for the 
+// terminal, are shown whole as they always were; larger ones get a window sized to the 
+// terminal, scrolled to keep a focus cell MARGIN cells inside its edges, and a minimap of 
+// the whole board beside it, one block of tiles per character. 
+class Viewport
+{
+    int size, tiles_per_row;
+    int top, left, rows, cols;
+    int blocks;                         // minimap blocks per side, 0 without a minimap 
+    Position focus;                     // followed again whenever the window is resized 
 
-        // pop the current node
-        que.pop();
-        open.erase(curr);
+    void scroll();
 
-        // Mark as explored
-        curr.markAsExplored();
+public:
+    static constexpr int WHOLE = 32, MIN_CELLS = 16, MARGIN = 4;
+    static constexpr int RESERVED_ROWS = 8; // header, status and key lines around the board 
+
+    Viewport(int size=0);
+    bool contains(Position pos) const;
+    void fit(int terminal_rows, int terminal_cols);
+    void follow(Position focus);
+    int getBlocks() const;
+    int getCols() const;
+    int getLeft() const;
+    int getRows() const;
+    int getTop() const;
+    bool isWhole() const;
+};
 
-        
-    }    
+// Shared state between the UI thread and a search running on a worker thread. 
+// The worker publishes rendered frames and then waits out the delay; the UI wakes 
+// up through a pipe whenever a new frame is ready. 
+class SearchControl
+{
+    atomic<bool> cancelled, paused, finished;
+    atomic<int> delay_us;
+    mutex state_mutex;
+    condition_variable wake;
+    string frame;
+    uint64_t frame_id;
+    int notify_pipe[2];
 
-    result.setFailure();
-    return false;
+public:
+    SearchControl(int delay_us=50000);
+    ~SearchControl();
+    void cancel();
+    void drainNotifications();
+    void finish();
+    int getDelay() const;
+    int getNotifyFd() const;
+    bool isCancelled() const;
+    bool isFinished() const;
+    bool isPaused() const;
+    bool publish(const string &new_frame, int delay_factor=1);
+    void setDelay(int delay_us);
+    bool takeFrame(string &out, uint64_t &seen_id);
+    void togglePause();
+};
 
-}
-void Game::changeCurserMode(CurserMode mode)
-{
-    curserMode = mode;
-    applyCurser();
-}
-void Game::clean() 
+// Time from reading a key to the end of the redraw it caused 
+class LatencyMeter
 {
+    chrono::steady_clock::time_point key_time;
+    bool pending;
+    long long count;
+    double total_ms, max_ms, last_ms;
 
-}
-void Game::clearBuffer(int buffer_clear_bit)
+public:
+    LatencyMeter();
+    void keyPressed();
+    void redrawn();
+    string summary() const;
+};
+
+// Hardware cache misses of the calling thread through perf_event_open, where the kernel and 
+// the machine provide the counter; isAvailable() is false otherwise (VMs, containers) 
+class CacheMissCounter
 {
-    for(int i=0; i<size; i++)
-    {
-        for(int j=0; j<size; j++)
-        {
-            NodeHandle curr = board[i][j];
-            if(buffer_clear_bit & BUFFER_BIT_EXPLORED)
-                curr.markAsExplored(false);
-            if(buffer_clear_bit & BUFFER_BIT_VISITED)
-                curr.markAsVisited(false);
-            if(buffer_clear_bit & BUFFER_BIT_COST)
-                curr.setGCost(100000);
-            if(buffer_clear_bit & BUFFER_BIT_PARENT)
-                curr.setParent(NULL);
-        }
-    }
-    start.setGCost(0);
-}
-bool Game::depthFirstSearch(NodeHandle &curr)
+    int fd;
+
+public:
+    CacheMissCounter();
+    ~CacheMissCounter();
+    bool isAvailable() const;
+    void start();
+    long long stop();
+};
+
+// Reusable barrier for a fixed team of threads: wait() returns once all of them have called it 
+class ThreadBarrier
 {
-    // Display the progress and add a delay 
-    system("clear");
-    curr.markAsExplored();
-    cout<<"Finding a path ... "<<endl;
-    result.incSearchCost();
-    displayGameState();
-    usleep(50000);
+    mutex lock;
+    condition_variable released;
+    int count, waiting;
+    uint64_t generation;
 
+public:
+    ThreadBarrier(int count);
+    void wait();
+};
 
-    // Implement the algorithm here
-    if(curr == end)
+#ifdef MAZE_TRACE
+// Scoped tracing, compiled in with -DMAZE_TRACE and out (to nothing) otherwise. Every thread 
+// records into a buffer only it writes to, so recording takes no lock. The buffers are written 
+// as Chrome trace-event JSON (chrome://tracing, Perfetto) when the program exits, to the file 
+// named by $MAZE_TRACE_FILE or maze_trace.json, with a per-phase summary on stderr. 
+class Tracer
+{
+public:
+    struct Event
     {
-        retracePath();
-        result.setSuccess();
-        return true;
-    }
+        const char *name;
+        uint64_t begin_ns;
+        long long value;                // duration in ns, or the value of a counter 
+        int sample_rate;                // 0 for a counter 
+    };
+    struct Buffer
+    {
+        int tid;
+        vector<Event> events;
+        long long dropped;
+    };
+    static const unsigned SAMPLE_RATE = 256;
+    static const size_t MAX_EVENTS = 1 << 20;   // per thread, later events are counted as dropped 
+
+    static void counter(const char *name, long long value);
+    static uint64_t now();
+    static void record(const char *name, uint64_t begin_ns, long long duration_ns, int sample_rate);
+    static void summary(ostream &os);
+    static bool write(const string &file);
 
+private:
+    static mutex registry_mutex;
+    static vector<Buffer*> buffers;     // never freed, a thread's events outlive the thread 
+    static chrono::steady_clock::time_point epoch;
 
-    // update the neighbours 
-    updateNeighbourCost(curr);
+    static Buffer& local();
+    static void writeAtExit();
+};
 
-    // Recursive call on all directions
-    vector<NodeHandle> neighbours = getNeighbours(curr);
-    for(int i=0; i<neighbours.size(); i++)
-    {
-        if(!neighbours[i].isWalkable() || neighbours[i].isExplored())
-            continue;
-            
-        if(depthFirstSearch(neighbours[i])) {
-            return true;
-        }
+// Times the enclosing block; with a sample rate of 0 it reads no clock and records nothing 
+class TraceScope
+{
+    const char *name;
+    uint64_t begin_ns;
+    int sample_rate;
 
-    }
-    
-    // If not found, return false
-    result.setFailure();
-    return false;
-}
-bool Game::bestFirstSearch()
+public:
+    TraceScope(const char *name, int sample_rate=1);
+    ~TraceScope();
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+// coarse phases: one event per call 
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(trace_scope_, __LINE__)(name)
+// hot phases: one call in SAMPLE_RATE (per thread and call site) is timed 
+#define TRACE_SAMPLE(name) static thread_local unsigned TRACE_CONCAT(trace_calls_, __LINE__) = 0; \
+    TraceScope TRACE_CONCAT(trace_scope_, __LINE__)(name, TRACE_CONCAT(trace_calls_, __LINE__)++ % Tracer::SAMPLE_RATE == 0 ? Tracer::SAMPLE_RATE : 0)
+#define TRACE_COUNTER(name, value) Tracer::counter(name, value)
+#else
+#define TRACE_SCOPE(name)
+#define TRACE_SAMPLE(name)
+#define TRACE_COUNTER(name, value)
+#endif
+
+// One immutable version of the walls, cut into 64x64 tiles that later versions share until 
+// they edit them. The tiles are held a row of tiles at a time, so a version that changes one 
+// tile copies one row of tile pointers and the table of rows, not a pointer per tile. 
+// Holding a snapshot pins its version: it is freed with the last snapshot that refers to it, 
+// so a query can keep reading while newer versions are published. 
+class BoardSnapshot
 {
-    // Declare and Initialize data-structures
-    priority_queue<NodeHandle, vector<NodeHandle>, NodeHandleComparatorGCost> que;
-    unordered_set<NodeHandle, NodeHandleHashFunction> open;
-    que.push(start);
-    open.insert(start);
-    start.markAsExplored();
+public:
+    static const int TILE = 64;
+
+private:
+    friend class VersionedBoard;
+    friend class WalkableBitset;
 
-    while(!que.empty())
+    struct Tile
     {
-        // pop the first node 
-        NodeHandle curr = que.top();
-        que.pop();
-        open.erase(curr);
-        curr.markAsExplored();
-        
-        // Display the progress and add a delay 
-        system("clear");
-        cout<<"Finding a path ... "<<endl;
-        displayGameState();
-        usleep(50000);
-        result.incSearchCost();
-            
-        
-        // check if its the end node 
-        if(curr == end) 
+        uint64_t rows[TILE];            // bit j of rows[i] set when the cell is walkable 
+    };
+    typedef vector<shared_ptr<const Tile> > TileRow;
+    struct Version
+    {
+        uint64_t number;
+        int size, tiles_per_row;
+        vector<shared_ptr<const TileRow> > tile_rows;
+
+        const Tile& getTile(int row, int col) const;
+    };
+
+    shared_ptr<const Version> version;
+
+    BoardSnapshot(shared_ptr<const Version> version);
+
+public:
+    BoardSnapshot();
+    int getSize() const;
+    uint64_t getVersion() const;
+    bool isWalkable(int row, int col) const;
+};
+
+template<class OpenList = BinaryHeapOpenList<int> >
+class SubgoalGraph;
+template<class OpenList = BinaryHeapOpenList<int> >
+class JunctionGraph;
+template<class OpenList = BinaryHeapOpenList<int> >
+class AdaptiveAStar;
+template<class OpenList = BinaryHeapOpenList<int> >
+class AlternativeRoutes;
+class VersionedBoard;
+class PortfolioSolver;
+
+class Game
+{
+private:
+    Board board;
+    int size;
+    bool should_close;
+    NodeHandle curser, start, end;
+    enum GameEnum {EDIT, PATH_FINDING, MENU, SETTINGS} gameMode;
+    enum CurserMode {SELECT, INSERT_WALL, REMOVE_WALL} curserMode;
+    bool diagonalMovesAllowed;
+    bool visualize;
+    Result result;
+    uint64_t board_version;
+    PathCache path_cache;
+    Terminal terminal;
+    SearchControl *search_control;
+    int search_delay_us;
+    LatencyMeter latency;
+    float search_epsilon, epsilon_step;
+    SearchBudget search_budget;
+    SubgoalGraph<> *subgoal_graph;      // built on the first query, repaired on wall edits 
+    JunctionGraph<> *junction_graph;    // same lifetime as subgoal_graph 
+    AdaptiveAStar<> *adaptive_search;   // same lifetime, its learned tables are repaired on edits 
+    AlternativeRoutes<> *route_search;  // same lifetime, its tree is grown again after edits 
+    int route_count;
+    float route_penalty;
+    string route_report;                // of the last findRoutes, shown once 
+    VersionedBoard *board_versions;     // walls as published to snapshot readers 
+    PortfolioSolver *portfolio;         // racing contexts, kept between queries 
+    vector<SearchAlgorithm> portfolio_algorithms;
+    float portfolio_ratio;
+    size_t memory_budget;               // bytes SMA* may use for one query 
+    SearchBudget memory_search_budget;
+    TileSummary tiles;                  // per tile marks, for the minimap 
+    Viewport viewport;
+    int terminal_rows, terminal_cols;   // 0 asks the terminal every frame 
+
+    template<class OpenList> friend class GameSearch;
+    friend class PortfolioSolver;
+
+public:
+    Game(int size=10, Board::Layout layout=Board::MAZE_LAYOUT);
+    Game(const Game &other) = delete;
+    Game& operator = (const Game &other) = delete;
+    ~Game();
+    void applyCurser();
+    vector<Position> anyAngleSearch(bool lazy, Bounds *explored=NULL);
+    vector<Position> anytimeSearch(bool repeat, Bounds *explored=NULL);
+    vector<Position> adaptiveSearch(Bounds *explored=NULL);
+    template<class OpenList = BinaryHeapOpenList<NodeHandle> >
+    void aStarSearch();
+    const PathCache::Entry* beginSolve(SearchAlgorithm algorithm);
+    bool breadthFirstSearch();
+    void changeCurserMode(CurserMode mode);
+    void clean();
+    void clearBuffer(int buffer_clear_bit);
+    bool depthFirstSearch();
+    template<class OpenList = BinaryHeapOpenList<NodeHandle> >
+    bool bestFirstSearch();
+    void display();
+    void displayEditControls();
+    void displayEditUI();
+    void displayEditMode();
+    void displayGameState();
+    void displayPath();
+    vector<Position> endSolve(SearchAlgorithm algorithm, vector<Position> path, Bounds explored);
+    void enterEditMode();
+    void exitGame();
+    Bounds exploredBounds() const;
+    void findPath();
+    Position findNearestWalkable(Position pos) const;
+    int findRoutes(bool diverse);
+    void generateBoard(MazeGenerator::GeneratorType type, uint64_t seed, float density=0.45f);
+    void generateMaze();
+    static string getAlgorithmName(SearchAlgorithm algorithm);
+    static float getChessBoardDistance(const NodeHandle src, const NodeHandle end);
+    string getCurserMode();
+    PathCache& getPathCache();
+    Result& getResult();
+    const TileSummary& getTileSummary() const;
+    Viewport& getViewport();
+    CompactPath getCompactPath();
+    vector<Position> getPath();
+    int getSize() const;
+    static float getEuclidianDistance(const NodeHandle src, const NodeHandle end);
+    void getInput();
+    static float getManhattanDistance(const NodeHandle src, const NodeHandle end);
+    template<class OpenList = BinaryHeapOpenList<NodeHandle> >
+    bool greedyBestFirstSearch();
+    void insertWall(NodeHandle cell);
+    vector<NodeHandle> getNeighbours(const NodeHandle &curr);
+    bool isOutOfBounds(Position curr) const;
+    vector<Position> junctionSearch(Bounds *explored=NULL);
+    void markExplored(NodeHandle cell);
+    void markPath(const vector<Position> &path);
+    void markVisited(NodeHandle cell);
+    void markWaypoints(const vector<Position> &waypoints);
+    vector<Position> memoryBoundedSearch(Bounds *explored=NULL);
+    MultiAgentStats planAgents(vector<Agent> &agents, int window=16);
+    vector<Position> portfolioSearch(Bounds *explored=NULL);
+    void moveUp();
+    void moveDown();
+    void moveLeft();
+    void moveRight();
+    void putEnd();
+    void putStart();
+    TileSummary recountTiles() const;
+    void removeWall(NodeHandle cell);
+    string renderFrame(bool show_explored, bool show_visited, const vector<Position> &frontier=vector<Position>(),
+                       Position curser_pos=Position());
+    vector<string> renderMinimap(bool show_explored, bool show_visited) const;
+    void runSearch(SearchAlgorithm algorithm);
+    void setAnytimeOptions(float epsilon, float epsilon_step, SearchBudget budget=SearchBudget());
+    void setEndpoints(Position start_pos, Position end_pos);
+    void setMemoryBudget(size_t bytes, SearchBudget budget=SearchBudget(-1, 2000000));
+    void setPortfolioOptions(const vector<SearchAlgorithm> &algorithms, float max_cost_ratio);
+    void setRouteOptions(int count, float penalty=1.0f);
+    void setTerminalSize(int rows, int cols);
+    void setWall(Position pos, bool wall);
+    void setVisualize(bool visualize);
+    bool shouldClose();
+    BoardSnapshot snapshot() const;
+    vector<Position> solve(SearchAlgorithm algorithm);
+    void stepSearch(SearchAlgorithm algorithm);
+    vector<Position> subgoalSearch(Bounds *explored=NULL);
+    void updateNeighbourCost(NodeHandle curr);
+    bool wallAt(int row, int col) const;
+};
+
+struct NodeHandleHashFunction
+{
+    int operator() (const NodeHandle &nodeHandle) const
+    {
+        return (nodeHandle.getPosition().row)^(nodeHandle.getPosition().col);
+    }
+};
+
+// The five Node based searches (depth-first, breadth-first, best-first, greedy best-first 
+// and A*) as resumable state machines over the Game's board: step(n) makes up to n 
+// expansions and returns, and the frontier can be read between steps. Headless callers run 
+// a search in one step, with nothing done per expansion besides the search itself; the 
+// terminal UI steps it a frame at a time. Finding the goal only records the path: retrace(n) 
+// marks n more of its cells, so the UI can animate it the same way. Greedy keys (the estimate left) go up and down, 
+// so with a MONOTONE policy greedy is queued in a binary heap instead. 
+template<class OpenList = BinaryHeapOpenList<NodeHandle> >
+class GameSearch
+{
+public:
+    enum Status {RUNNING, FOUND, NOT_FOUND};
+
+private:
+    struct Branch
+    {
+        NodeHandle node;
+        vector<NodeHandle> neighbours;
+        size_t next;                    // first neighbour not tried yet 
+    };
+
+    Game &game;
+    SearchAlgorithm algorithm;
+    Status status;
+    OpenList open_list;                 // best-first and A* 
+    typename conditional<OpenList::MONOTONE, BinaryHeapOpenList<NodeHandle>, OpenList>::type greedy_list;
+    deque<NodeHandle> fifo;             // breadth-first 
+    vector<Branch> branches;            // depth-first, what used to be its recursion 
+    unordered_set<NodeHandle, NodeHandleHashFunction> open;    // queued and not expanded, except in A* 
+    NodeHandle current;
+    long long expansions;
+    vector<NodeHandle> path;            // found, from the goal back, without the endpoints 
+    size_t retraced;                    // cells of path marked so far 
+
+    bool expandAStar();
+    bool expandBreadthFirst();
+    bool expandDepthFirst();
+    template<class List>
+    bool expandOrdered(List &list, bool greedy);
+    bool finish(bool found);
+
+public:
+    GameSearch(Game &game, SearchAlgorithm algorithm);
+    template<typename Function>
+    void forEachFrontier(Function fn) const;
+    NodeHandle getCurrent() const;
+    long long getExpansions() const;
+    size_t getFrontierSize() const;
+    Status getStatus() const;
+    static bool isSteppable(SearchAlgorithm algorithm);
+    bool retrace(long long max_cells=LLONG_MAX);
+    Status step(long long max_expansions=LLONG_MAX);
+};
+
+// Races some of the Node based searches on private copies of a Game's board, one thread each. 
+// Each algorithm has a worst case cost ratio: 1 for A* and best-first, sqrt(2) for breadth-first 
+// (fewest moves, each costing at most sqrt(2)), none for greedy and depth-first. The first racer 
+// to finish within the requested ratio wins, or to prove there is no path, and the others are 
+// cancelled between steps. With cancel_losers off every racer runs to the end, which measures 
+// the margin; the wins and margins per algorithm are kept to pick per-map defaults. 
+class PortfolioSolver
+{
+public:
+    struct Racer
+    {
+        SearchAlgorithm algorithm;
+        Game *context;                  // private board, synced from the game before a race 
+        uint64_t synced_version;
+        double ms;                      // until it finished or was cancelled 
+        long long expansions;
+        float cost;                     // INFINITY without a path 
+        bool finished, found;
+        long long wins;
+        double won_ms, lead_ms;         // summed over wins, lead over the next qualifying racer 
+        long long leads;                // wins where a qualifying runner-up finished 
+    };
+    static const long long STEP = 1024; // expansions between cancellation checks 
+
+private:
+    Game &game;
+    vector<Racer> racers;
+    atomic<int> winner;
+    float max_cost_ratio;
+    bool cancel_losers;
+    long long races;
+
+    bool qualifies(const Racer &racer) const;
+    void race(int index, chrono::steady_clock::time_point begin, const SearchControl *control);
+    void sync(Racer &racer);
+
+public:
+    PortfolioSolver(Game &game, const vector<SearchAlgorithm> &algorithms);
+    ~PortfolioSolver();
+    Bounds getExploredBounds() const;
+    static float getCostRatio(SearchAlgorithm algorithm);
+    const vector<Racer>& getRacers() const;
+    int getWinner() const;
+    string report() const;
+    void setCancelLosers(bool cancel_losers);
+    vector<Position> solve(float max_cost_ratio=1.0f, const SearchControl *control=NULL);
+    string summary() const;
+};
+
+// Windowed hierarchical cooperative A* (WHCA*): agents plan one after the other in a
+// space-time grid, respecting the moves reserved by the agents planned before them. 
+// Only half of each window is executed before everybody replans. 
+class MultiAgentPlanner
+{
+    const Game &game;
+    int size;
+    bool diagonal;
+    int window;
+    SpaceTimeTable reservations, closed;
+    unordered_map<uint32_t, vector<uint32_t> > distance_maps;
+    long long reservation_blocks;
+
+    static const uint32_t UNREACHABLE = ~0u;
+    long long countConflicts(const vector<vector<uint32_t> > &paths) const;
+    const vector<uint32_t>& distancesTo(uint32_t goal);
+    bool planWindow(int agent, uint32_t from, uint32_t goal, int t0, vector<uint32_t> &window_path);
+    int successors(uint32_t cell, uint32_t out[9]) const;
+
+public:
+    MultiAgentPlanner(const Game &game, bool diagonal=true, int window=16);
+    MultiAgentStats plan(vector<Agent> &agents, int max_time=-1);
+};
+
+// One bit per cell (1 = walkable), rows padded to whole 64 bit words. Cells can also be 
+// addressed as row*size + col, with the moves and octile costs of aStarSearch between them. 
+class WalkableBitset
+{
+    int size, words_per_row;
+    vector<uint64_t> bits;
+
+public:
+    WalkableBitset(const Game &game);
+    WalkableBitset(int size, bool walkable=false);
+    WalkableBitset(const BoardSnapshot &snapshot);
+    long long countWalkable() const;
+    template<typename Function>
+    void forEachNeighbour(int cell, Function fn) const;
+    int getSize() const;
+    bool isSpanWalkable(int row, int col_lo, int col_hi) const;
+    uint64_t checksum() const;
+    bool isWalkable(int row, int col) const;
+    bool lineOfSight(Position a, Position b) const;
+    unsigned neighbourMask(int row, int col) const;
+    float octile(int a, int b) const;
+    void setWalkable(int row, int col, bool walkable);
+    float stepCost(int a, int b) const;
+};
+
+// Evaluates the 8 neighbours of an expanded cell of a flat size*size grid in one go: walkable 
+// bits, tentative g, the improvement test and the weighted key g + epsilon*octile(next, target). 
+// Bit k of the masks is neighbour k of the 3x3 window in row-major order, centre skipped, the 
+// order the scalar loops visit them in. The float operations are the scalar ones in the same 
+// order, so every kind returns identical values. The best kind this CPU runs is picked at 
+// startup; SSE2 and AVX2 are compiled per function, the binary still runs on any x86-64. 
+class NeighbourKernel
+{
+public:
+    enum Kind {SCALAR, SSE2, AVX2};
+    struct Batch
+    {
+        int cells[8];
+        float costs[8], keys[8];
+    };
+    typedef unsigned (*Function)(const float *g, int curr, int size, unsigned walkable, int target, float epsilon, Batch &batch);
+
+private:
+    static unsigned avx2(const float *g, int curr, int size, unsigned walkable, int target, float epsilon, Batch &batch);
+    static unsigned scalar(const float *g, int curr, int size, unsigned walkable, int target, float epsilon, Batch &batch);
+    static unsigned sse2(const float *g, int curr, int size, unsigned walkable, int target, float epsilon, Batch &batch);
+
+public:
+    static Kind best();
+    static Function get(Kind kind);
+    static string getName(Kind kind);
+    static bool isSupported(Kind kind);
+};
+
+// Publishes board versions for concurrent readers. An edit copies the tiles it changes and 
+// the rows of tile pointers that hold them, then swaps the new version in atomically; readers take a 
+// snapshot() without waiting for writers, and writers queue behind each other. 
+class VersionedBoard
+{
+    shared_ptr<const BoardSnapshot::Version> current;  // only read and written with atomic_load/atomic_store 
+    mutex writer;
+    long long tiles_copied, pointers_copied, edits;
+
+    void publish(shared_ptr<const BoardSnapshot::Version> next);
+
+public:
+    VersionedBoard(const Game &game);
+    void apply(const vector<pair<Position, bool> > &walls);
+    long long getEdits() const;
+    long long getPointersCopied() const;
+    long long getTilesCopied() const;
+    uint64_t getVersion() const;
+    void reset(const Game &game);
+    void setWall(Position pos, bool wall);
+    BoardSnapshot snapshot() const;
+};
+
+// Any-angle search over a WalkableBitset: Theta*, Lazy Theta* and post-process smoothing. 
+// Paths are returned as waypoints joined by straight, obstacle free segments. 
+class AnyAngleSearch
+{
+    const WalkableBitset &grid;
+    int size;
+    long long expansions, los_checks;
+    Bounds explored;
+
+    bool lineOfSight(int a, int b);
+    static float distance(int a, int b, int size);
+
+public:
+    AnyAngleSearch(const WalkableBitset &grid);
+    Bounds getExploredBounds() const;
+    long long getExpansions() const;
+    long long getLineOfSightChecks() const;
+    static float pathLength(const vector<Position> &path);
+    vector<Position> smoothPath(const vector<Position> &path);
+    vector<Position> thetaStar(Position start, Position goal, bool lazy=false);
+    static vector<Position> turningPoints(const vector<Position> &path);
+};
+
+// Weighted A* and ARA* over a WalkableBitset, with the moves and octile costs of aStarSearch. 
+// ARA* finds a first path with a large heuristic weight, then lowers the weight and improves 
+// it by reusing the previous search. Both stop at the budget and return the best path so far. 
+// Inflated keys can drop below the last one popped, so the open list must not be MONOTONE. 
+template<class OpenList = BinaryHeapOpenList<int> >
+class AnytimeSearch
+{
+    static_assert(!OpenList::MONOTONE, "weighted A* keys are not monotone");
+
+    const WalkableBitset &grid;
+    int size;
+    vector<float> g;
+    vector<int> parent;
+    vector<uint32_t> closed_in;     // iteration that last expanded the cell 
+    vector<uint8_t> in_open, in_incons;
+    vector<int> incons;             // expanded cells whose g improved later in the same iteration 
+    long long expansions;
+    uint32_t iterations;
+    float bound, path_cost;
+    double first_solution_ms;
+    bool exhausted;
+    Bounds explored;
+    CompactPath route;              // best path of the last search, its buffer is reused 
+    NeighbourKernel::Function expand_neighbours;
+
+    bool improvePath(int target, float epsilon, OpenList &openList, const SearchBudget &budget, chrono::steady_clock::time_point begin);
+    float lowerBound(int target, OpenList &openList, vector<int> &frontier);
+    void search(Position start, Position goal, float initial_epsilon, float epsilon_step, SearchBudget budget);
+
+public:
+    AnytimeSearch(const WalkableBitset &grid);
+    vector<Position> araStar(Position start, Position goal, float initial_epsilon=3.0f, float epsilon_step=0.5f, SearchBudget budget=SearchBudget());
+    const CompactPath& araStarRoute(Position start, Position goal, float initial_epsilon=3.0f, float epsilon_step=0.5f, SearchBudget budget=SearchBudget());
+    float getBound() const;
+    long long getExpansions() const;
+    Bounds getExploredBounds() const;
+    double getFirstSolutionMs() const;
+    int getIterations() const;
+    float getPathCost() const;
+    bool isBudgetExhausted() const;
+    void setKernel(NeighbourKernel::Kind kind);
+    vector<Position> weightedAStar(Position start, Position goal, float epsilon, SearchBudget budget=SearchBudget());
+    const CompactPath& weightedAStarRoute(Position start, Position goal, float epsilon, SearchBudget budget=SearchBudget());
+};
+
+// Simple subgoal graph (SSG) over a WalkableBitset, with an optional two-level layer (TSG). 
+// Moves may cut corners as in getNeighbours, so a taut path only bends beside the end of a run 
+// of walls: a subgoal is a free cell with a wall next to it whose neighbour along the run is free. 
+// Subgoals are joined when a "diagonal first, then straight" octile path between them is free 
+// (scans stop at the first subgoal). A query links start and goal the same way, searches the 
+// small graph and refines the edges back to cells, with the cost of aStarSearch. 
+template<class OpenList>
+class SubgoalGraph
+{
+    struct Edge
+    {
+        int to;
+        float cost;
+        int via;                        // subgoal the shortcut was contracted over 
+    };
+    enum {DIAGONAL_FIRST = 1, STRAIGHT_FIRST = 2};
+
+    WalkableBitset grid;
+    int size;
+    vector<int> subgoal_at;             // per cell, -1 when the cell is not a subgoal 
+    vector<int> cells;                  // per subgoal, -1 once an edit removed it 
+    vector<vector<int> > scans;         // subgoals found by the scans from each subgoal 
+    vector<vector<int> > found_by;      // reverse of scans 
+    vector<vector<Edge> > shortcuts;    // two-level shortcuts, stored on both ends 
+    vector<uint8_t> local;
+    bool two_level, two_level_valid;
+    long long expansions;
+    float path_cost;
+
+    // scratch, reused between searches 
+    vector<float> dist;
+    vector<int> parent, parent_via, stamp, closed, region, linked;
+    int current_stamp;
+
+    void addSubgoal(int cell);
+    void build();
+    void buildTwoLevel();
+    float distanceOf(int node) const;
+    template<class Visit>
+    void forEachEdge(int id, Visit visit) const;
+    bool isSubgoalCell(int row, int col) const;
+    int nextStamp(int nodes);
+    void refine(int a, int b, int via, vector<Position> &path) const;
+    void removeSubgoal(int id);
+    void rescan(int id);
+    void scan(int cell, int orders, int target, vector<int> &found, bool &reached, bool direct_only=true) const;
+    void setDistance(int node, float distance);
+    int viaOf(int a, int b) const;
+    void witnessSearch(int from, int skip, float limit);
+
+public:
+    SubgoalGraph(const WalkableBitset &grid, bool two_level=true, const string &index_file="");
+    vector<Position> findPath(Position start, Position goal);
+    long long getEdgeCount() const;
+    long long getExpansions() const;
+    int getGlobalCount();
+    float getPathCost() const;
+    int getSubgoalCount() const;
+    bool load(const string &file);
+    bool save(const string &file);
+    void setWall(Position pos, bool wall);
+};
+
+// Compressed path database (CPD): for every source the first move of a shortest path to every 
+// target, with targets ordered along a Hilbert curve and run-length compressed per source. 
+// Built offline with one Dijkstra per source; a saved database is memory-mapped when loaded. 
+// Moves and octile costs are those of aStarSearch. 
+class CompressedPathDatabase
+{
+    WalkableBitset grid;
+    int size;
+    vector<uint32_t> rank;              // position of each cell along the curve 
+    vector<uint64_t> owned_offsets;     // per source, first run (cells+1 entries) 
+    vector<uint32_t> owned_runs;        // start rank << 4 | move 
+    const uint64_t *offsets;
+    const uint32_t *runs;
+    void *mapping;
+    size_t mapping_bytes;
+
+    void build();
+    void release();
+
+public:
+    static const int MOVES[8][2];
+    enum {NO_PATH = 8, ANY_MOVE = 15};
+
+    CompressedPathDatabase(const WalkableBitset &grid, const string &file="");
+    CompressedPathDatabase(const CompressedPathDatabase &other) = delete;
+    CompressedPathDatabase& operator = (const CompressedPathDatabase &other) = delete;
+    ~CompressedPathDatabase();
+    int firstMove(Position from, Position to) const;
+    size_t getBytes() const;
+    long long getRunCount() const;
+    bool isMapped() const;
+    bool load(const string &file);
+    vector<Position> path(Position from, Position to) const;
+    bool save(const string &file) const;
+};
+
+// Searches towards a set of targets at once, with the moves and octile costs of aStarSearch. 
+// nearest() stops at the first target it settles, using Dijkstra, BFS (fewest moves) or A* 
+// guided by the distance to the closest target. A grid of buckets over the targets finds that 
+// distance without looking at every target. distances() settles all targets in one Dijkstra. 
+class MultiTargetSearch
+{
+public:
+    enum Mode {DIJKSTRA, BREADTH_FIRST, A_STAR, A_STAR_LINEAR};
+
+private:
+    const WalkableBitset &grid;
+    int size;
+    vector<Position> targets;
+    vector<int> target_at;              // per cell, first index in targets, valid when target_stamp matches 
+    vector<uint32_t> target_stamp;
+    int bucket_size, buckets_per_row;
+    vector<vector<int> > buckets;       // target cells in each bucket 
+    long long expansions, heuristic_probes;
+    int found;
+    float path_cost;
+
+    // scratch, reused between searches 
+    vector<float> g, h;
+    vector<int> parent;
+    vector<uint32_t> seen, closed, h_stamp;
+    uint32_t current_stamp;
+
+    float nearestTargetDistance(int cell);
+    float nearestTargetLinear(int cell);
+    uint32_t nextStamp();
+    void setTargets(const vector<Position> &targets, uint32_t stamp);
+
+public:
+    MultiTargetSearch(const WalkableBitset &grid);
+    vector<float> distances(Position start, const vector<Position> &targets);
+    long long getExpansions() const;
+    int getFoundTarget() const;
+    long long getHeuristicProbes() const;
+    float getPathCost() const;
+    vector<Position> nearest(Position start, const vector<Position> &targets, Mode mode=A_STAR);
+};
+
+// Junction graph: runs of cells with exactly two walkable neighbours (corridors) collapse into 
+// weighted edges between the other cells (junctions), with the moves and octile costs of 
+// aStarSearch. Dead ends are pruned first: a cell whose open neighbours all touch each other 
+// is never needed to go past it, so it is removed, which eats dead-end branches from the tip 
+// and the inner corner of every bend. A start or goal in a pruned cell climbs to the graph 
+// through cells pruned after it. A wall edit re-prunes and re-traces only around the edit. 
+template<class OpenList>
+class JunctionGraph
+{
+    struct Edge
+    {
+        int a, b;                       // end junctions, a == -1 once removed 
+        float cost;
+        vector<int> cells;              // corridor cells from a to b 
+        vector<float> along;            // cost from a to each corridor cell 
+    };
+
+    WalkableBitset grid;
+    int size;
+    vector<int> pruned_at;              // per cell, 0 while in the graph, otherwise the order it was pruned in 
+    int prune_count;
+    vector<int> node_at;                // per cell, junction id or -1 
+    vector<int> edge_at, index_at;      // per corridor cell, its edge and place along it 
+    vector<int> nodes;                  // per junction, its cell or -1 once removed 
+    vector<vector<int> > incident;      // per junction, the edges touching it 
+    vector<Edge> edges;
+    vector<int> free_nodes, free_edges;
+    long long expansions;
+    float path_cost;
+
+    // scratch, reused between searches 
+    vector<float> dist, goal_dist;
+    vector<int> parent, via_edge, via_from, via_to, stamp, closed;
+    vector<int> goal_parent, goal_stamp, goal_closed;
+    int current_stamp;
+
+    int addEdge(int u, int v, float cost, const vector<int> &cells, const vector<float> &along);
+    int addNode(int cell);
+    void appendCells(int edge, int from, int to, vector<Position> &path) const;
+    void build();
+    int degree(int cell) const;
+    bool hasDirectEdge(int u, int v) const;
+    bool isDeadEnd(int cell, int turn=INT_MAX) const;
+    bool isKept(int row, int col, int turn=INT_MAX) const;
+    int nextStamp(int count);
+    void prune(vector<int> &queue, vector<int> &pruned);
+    void removeEdge(int edge);
+    void removeNode(int u);
+    void retrace(const vector<int> &dirty);
+    void trace(int u);
+
+public:
+    JunctionGraph(const WalkableBitset &grid);
+    vector<Position> findPath(Position start, Position goal);
+    long long getEdgeCount() const;
+    long long getExpansions() const;
+    int getJunctionCount() const;
+    float getPathCost() const;
+    int getPrunedCount() const;
+    void setWall(Position pos, bool wall);
+};
+
+// Adaptive A* for a stream of queries to the same goals, with the moves and octile costs of 
+// aStarSearch. After a search reaches the goal every expanded cell s learns 
+// h(s) = g(goal) - g(s) in a table kept per goal. Learned values stay consistent, so later 
+// queries to that goal are still optimal and expand fewer cells. A new wall only makes paths 
+// longer and keeps the tables consistent; a removed wall can shorten them, and the tables are 
+// repaired by propagating the decrease from the opened cell (the consistency procedure of 
+// Generalized Adaptive A*). Past max_goals the least recently used table is dropped. 
+template<class OpenList>
+class AdaptiveAStar
+{
+    struct GoalTable
+    {
+        vector<float> h;                // learned h per cell, negative where nothing was learned 
+        uint64_t last_used;
+    };
+
+    WalkableBitset grid;
+    int size, max_goals;
+    bool learning;
+    unordered_map<int, GoalTable> tables;   // by goal cell 
+    uint64_t clock;
+    long long expansions, learned, repaired;
+    float path_cost;
+
+    // scratch, reused between searches 
+    vector<float> g;
+    vector<int> parent, expanded;
+    vector<uint32_t> seen, closed;
+    uint32_t current_stamp;
+
+    float heuristic(const GoalTable *table, int cell, int goal) const;
+    uint32_t nextStamp();
+    void repair(GoalTable &table, int goal, int cell);
+
+public:
+    AdaptiveAStar(const WalkableBitset &grid, int max_goals=16);
+    void clear();
+    vector<Position> findPath(Position start, Position goal);
+    long long getExpansions() const;
+    int getGoalCount() const;
+    long long getLearnedCount() const;
+    float getPathCost() const;
+    long long getRepairedCount() const;
+    void setLearning(bool learning);
+    void setWall(Position pos, bool wall);
+};
+
+// One block of memory handed out by a bump pointer. Nothing is allocated past the capacity, 
+// which is how a search is held to a byte budget, and the high-water mark is the peak in use. 
+class Arena
+{
+    char *memory;
+    size_t capacity, used, peak;
+
+public:
+    Arena(size_t capacity);
+    Arena(const Arena &other) = delete;
+    Arena& operator = (const Arena &other) = delete;
+    ~Arena();
+    void* allocate(size_t bytes, size_t alignment=16);
+    size_t getCapacity() const;
+    size_t getPeak() const;
+    size_t getUsed() const;
+    void reset();
+};
+
+// SMA* (simplified memory-bounded A*) over a WalkableBitset, with the moves and octile costs 
+// of aStarSearch, inside a byte budget. Every structure of the search lives in an Arena of 
+// that size: the open and leaf heaps and the cell index are sized to the most nodes that fit, 
+// and nodes come from the rest of the arena, recycled through a free list. A selected node 
+// generates one successor at a time. When the arena is full the worst leaf (highest f, then 
+// shallowest) is dropped and its parent remembers its f, and regenerates it once that is the 
+// best f left. A node's f is backed up to the least f of its successors once all were 
+// generated. The path is optimal whenever it fits in memory; a successor past the deepest 
+// path memory can hold gets f = inf. A cell reached again at no lower g is pruned. With little 
+// more memory than the path needs, subtrees are forgotten and regenerated over and over, and 
+// proving that no path fits can take exponential time: the SearchBudget bounds both. 
+class MemoryBoundedSearch
+{
+    struct SearchNode
+    {
+        int cell, depth;
+        float g, f;
+        float key;                      // in open: f, or the best forgotten f once all were generated 
+        SearchNode *parent, *next_in_bucket;
+        SearchNode *child[8];           // successors in memory, in the neighbour order of NeighbourKernel 
+        float child_f[8];               // NAN until generated, then its f, kept once it is forgotten 
+        int open_pos, leaf_pos;         // -1 when not in the heap 
+        uint8_t direction;              // index in the parent's arrays 
+        uint8_t children;               // successors in memory 
+    };
+    struct Heap
+    {
+        SearchNode **items;
+        int count;
+        bool worst_first;               // leaves: highest f and shallowest on top; open: lowest key and deepest 
+        int SearchNode::*pos;
+    };
+
+    WalkableBitset grid;
+    int size, target;
+    Arena arena;
+    size_t max_nodes, live_nodes, peak_nodes;
+    SearchNode **buckets;
+    size_t bucket_mask;
+    SearchNode *free_nodes;
+    Heap open, leaves;
+    long long expansions, regenerations, forgotten;
+    float path_cost;
+    bool out_of_budget;
+
+    SearchNode* allocateNode();
+    void backup(SearchNode *node);
+    bool before(const Heap &heap, const SearchNode *a, const SearchNode *b) const;
+    void forget(SearchNode *node, float f);
+    void heapRemove(Heap &heap, SearchNode *node);
+    void heapSet(Heap &heap, SearchNode *node, bool member);
+    void refresh(SearchNode *node);
+    void siftDown(Heap &heap, int hole);
+    void siftUp(Heap &heap, int hole);
+
+public:
+    MemoryBoundedSearch(const WalkableBitset &grid, size_t budget_bytes);
+    vector<Position> findPath(Position start, Position goal, SearchBudget budget=SearchBudget());
+    size_t getBudget() const;
+    long long getExpansions() const;
+    long long getForgottenCount() const;
+    size_t getMaxNodes() const;
+    float getPathCost() const;
+    size_t getPeakBytes() const;
+    size_t getPeakNodes() const;
+    long long getRegenerations() const;
+    static size_t getBytesPerNode();
+    bool isOutOfBudget() const;
+    void setWall(Position pos, bool wall);
+};
+
+// A cell of a VoxelGrid: row and col as in Position, layer is the floor or the height 
+struct Voxel
+{
+    int row, col, layer;
+
+    Voxel(int row=-1, int col=-1, int layer=-1);
+    bool operator == (const Voxel &other) const;
+};
+
+// One bit per voxel (1 = walkable) of a rows x cols x layers volume, rows padded to whole 64 
+// bit words as in WalkableBitset; 512^3 voxels take 16 MiB. A move joins voxels that share a 
+// face (6 neighbours), a face or an edge (18) or any of those or a corner (26) and costs 1, 
+// sqrt(2) or sqrt(3) by the number of axes it changes. As on the board, a move only needs its 
+// target to be walkable. 
+class VoxelGrid
+{
+public:
+    enum Connectivity {FACES = 6, EDGES = 18, CORNERS = 26};
+    static const int DROW[26], DCOL[26], DLAYER[26];   // the 6 faces, then 12 edges, then 8 corners 
+
+private:
+    int rows, cols, layers, words_per_row;
+    vector<uint64_t> bits;
+
+public:
+    VoxelGrid(int rows=0, int cols=0, int layers=0, bool walkable=false);
+    long long countWalkable() const;
+    uint64_t checksum() const;
+    static float distance(Voxel a, Voxel b, Connectivity connectivity);
+    void fillBuilding(uint64_t seed, int storey, float density);
+    void fillRandom(uint64_t seed, float density);
+    int getCols() const;
+    int getLayers() const;
+    int getRows() const;
+    bool isWalkable(int row, int col, int layer) const;
+    bool load(const string &file);
+    bool save(const string &file) const;
+    void setWalkable(int row, int col, int layer, bool walkable);
+    static float stepCost(int direction);
+};
+
+// Breadth-first search and A* over a VoxelGrid, as resumable state machines like GameSearch: 
+// begin() sets up a query and step(n) makes up to n expansions. A* takes any open list policy 
+// and the exact free space distance of the connectivity as its heuristic. The scratch (g and 
+// the move that reached a voxel) lives in 16x16x16 bricks, allocated the first time a search 
+// touches one and reset by stamp when a later search does, so a query on a 512^3 volume only 
+// pays for the bricks around what it explores. The grid is not copied and must outlive it. 
+template<class OpenList = BinaryHeapOpenList<uint32_t> >
+class VoxelSearch
+{
+public:
+    enum Status {RUNNING, FOUND, NOT_FOUND};
+
+private:
+    struct Brick
+    {
+        uint32_t stamp;
+        float g[4096];
+        uint8_t from[4096];             // the move into the voxel, START, or NONE if not reached 
+    };
+    static const uint8_t START = 26, NONE = 0x7f, CLOSED = 0x80;
+
+    const VoxelGrid &grid;
+    VoxelGrid::Connectivity connectivity;
+    SearchAlgorithm algorithm;
+    Status status;
+    OpenList open_list;                 // A* 
+    deque<uint32_t> fifo;               // breadth-first 
+    vector<Brick*> bricks;
+    int brick_rows, brick_cols;
+    size_t touched_bricks;
+    uint32_t current_stamp, source, target;
+    long long expansions;
+    float path_cost;
+
+    size_t brickOf(int row, int col, int layer, int &slot) const;
+    bool expandAStar();
+    bool expandBreadthFirst();
+    bool finish(bool found);
+    float heuristic(uint32_t cell) const;
+    Voxel toVoxel(uint32_t cell) const;
+    Brick* touch(size_t brick);
+
+public:
+    VoxelSearch(const VoxelGrid &grid, VoxelGrid::Connectivity connectivity=VoxelGrid::CORNERS);
+    VoxelSearch(const VoxelSearch &other) = delete;
+    VoxelSearch& operator = (const VoxelSearch &other) = delete;
+    ~VoxelSearch();
+    void begin(SearchAlgorithm algorithm, Voxel start, Voxel goal);
+    vector<Voxel> findPath(SearchAlgorithm algorithm, Voxel start, Voxel goal);
+    long long getExpansions() const;
+    vector<Voxel> getPath() const;
+    float getPathCost() const;
+    size_t getScratchBytes() const;
+    Status getStatus() const;
+    static bool isSupported(SearchAlgorithm algorithm);
+    Status step(long long max_expansions=LLONG_MAX);
+};
+
+// Several routes between the same two cells over a WalkableBitset, with the moves and octile 
+// costs of aStarSearch: Yen's k shortest loopless paths, spurring only past the point where a 
+// route left its parent (Lawler), and a faster penalty method that raises the cost of cells on 
+// the routes found so far to push the next one elsewhere. Both start from a Dijkstra tree grown 
+// backwards from the goal and kept while the goal and walls stay. Its exact distances are the h 
+// of every later A*: bans and penalties only lengthen the way to the goal, so h stays consistent, 
+// and a spur whose tree path is not banned is read off the tree without a search. 
+template<class OpenList>
+class AlternativeRoutes
+{
+public:
+    struct Route
+    {
+        vector<Position> path;
+        float cost;                     // octile length, penalties left out 
+        float overlap;                  // share of its inner cells already on an earlier route 
+        double ms;                      // since the previous route, the tree included for the first 
+        long long expansions;
+    };
+
+private:
+    struct Candidate
+    {
+        vector<int> cells;
+        float cost;
+        int deviation;                  // first cell that is not on the route it was spurred from 
+    };
+
+    WalkableBitset grid;
+    int size;
+    bool reuse_tree;
+    int tree_goal;                      // -1 without a tree 
+    vector<float> to_goal;              // exact distance to tree_goal, INFINITY where cut off 
+    vector<int> next_hop;               // next cell on a shortest path to tree_goal 
+    long long expansions, tree_builds;
+    double tree_ms;
+    bool penalized;
+    vector<Route> routes;               // of the last query 
+
+    // scratch, reused between searches 
+    vector<float> g, extra;             // extra: cost added per unit of a move into the cell 
+    vector<int> parent, uses;
+    vector<uint32_t> seen, closed, banned;
+    uint32_t current_stamp, banned_stamp;
+
+    void addRoute(const vector<int> &cells, chrono::steady_clock::time_point &since, long long &counted);
+    bool begin(Position start, Position goal, int &source, int &target);
+    void buildTree(int target);
+    float heuristic(int cell, int target) const;
+    uint32_t nextStamp();
+    float search(int source, int target, const vector<int> &banned_moves, vector<int> &cells);
+
+public:
+    AlternativeRoutes(const WalkableBitset &grid);
+    const vector<Route>& diverse(Position start, Position goal, int k, float penalty=1.0f);
+    long long getExpansions() const;
+    const vector<Route>& getRoutes() const;
+    long long getTreeBuilds() const;
+    double getTreeMs() const;
+    const vector<Route>& kShortest(Position start, Position goal, int k);
+    string report() const;
+    void setTreeReuse(bool reuse);
+    void setWall(Position pos, bool wall);
+};
+
+// Level-synchronous BFS over a WalkableBitset on a team of threads, giving the number of moves 
+// (those of breadthFirstSearch) from one cell to every cell in a flat array. A level expands 
+// top-down while the frontier is small: threads claim chunks of the frontier and collect what 
+// they reach in their own buffers. Once the frontier holds many of the edges left to check it 
+// goes bottom-up instead, every unvisited cell looking for a neighbour on the frontier and 
+// stopping at the first one (Beamer's direction-optimizing BFS). 
+class ParallelBreadthFirstSearch
+{
+    const WalkableBitset &grid;
+    int size;
+    vector<int32_t> distances;          // per cell, moves from the source or -1 
+    vector<int32_t> frontier;
+    vector<vector<int32_t> > next;      // per thread, cells reached in this level 
+    vector<size_t> offsets;             // per thread, where its cells go in the next frontier 
+    atomic<long long> next_chunk;
+    long long walkable, unvisited, reached;
+    int level, levels, bottom_up_levels;
+    bool bottom_up, done;
+
+    void expandBottomUp(int thread);
+    void expandTopDown(int thread);
+    void planLevel();
+    void work(int thread, ThreadBarrier &barrier);
+
+public:
+    // switch to bottom-up when the frontier has more than 1/ALPHA of the unvisited cells, 
+    // back to top-down when it shrinks below 1/BETA of all walkable cells 
+    static const int ALPHA = 14, BETA = 24;
+
+    ParallelBreadthFirstSearch(const WalkableBitset &grid);
+    int getBottomUpLevels() const;
+    const vector<int32_t>& getDistances() const;
+    int getLevels() const;
+    long long getReached() const;
+    void run(Position source, int threads=0);
+};
+
+// Path query daemon serving one board on a Unix domain socket. Requests and responses are 
+// fixed 16 byte headers in host byte order (the socket is local only); a response header 
+// is followed by length bytes of payload: the path as uint16 (row, col) pairs, the path as an 
+// encoded CompactPath (OP_ROUTE), or the stats text. Clients may pipeline requests and 
+// match responses by id. The requests read in one pass over the connections are searched as 
+// one batch by a team of worker threads. 
+class PathServer
+{
+public:
+    enum Op {OP_PATH = 1, OP_COST = 2, OP_STATS = 3, OP_SHUTDOWN = 4, OP_ROUTE = 5};
+    enum Status {STATUS_OK = 0, STATUS_NO_PATH = 1, STATUS_BAD_REQUEST = 2};
+    struct Request
+    {
+        uint32_t id;
+        uint8_t op, reserved[3];
+        uint16_t from_row, from_col, to_row, to_col;
+    };
+    struct Response
+    {
+        uint32_t id;
+        uint8_t status, reserved[3];
+        float cost;
+        uint32_t length;                // payload bytes after the header 
+    };
+    static const int MAX_BATCH = 1024;
+
+private:
+    struct Connection
+    {
+        int fd;
+        string in, out;                 // bytes not parsed yet, bytes not written yet 
+        bool closed;                    // peer is gone, dropped once out is written 
+    };
+    struct Job
+    {
+        int connection;
+        Request request;
+        string response;
+    };
+
+    const WalkableBitset &grid;
+    int listen_fd, thread_count;
+    string socket_path;
+    vector<Connection> connections;
+    vector<Job> batch;
+    atomic<int> next_job;
+    vector<AnytimeSearch<>*> searches;  // one per thread 
+    bool serving, team_done;
+    long long requests, batches, accepted, bad_requests;
+    atomic<long long> unreachable;      // counted by the workers as they answer 
+    size_t largest_batch;
+    chrono::steady_clock::time_point started;
+
+    void acceptConnections();
+    static string encode(const Request &request, uint8_t status, float cost, const string &payload);
+    void parseRequests(int connection);
+    void readIn(Connection &connection);
+    void searchBatch(int thread);
+    void work(int thread, ThreadBarrier &barrier);
+    void writeOut(Connection &connection);
+
+public:
+    PathServer(const WalkableBitset &grid, int threads=0);
+    ~PathServer();
+    string getStats() const;
+    bool listen(const string &socket_path);
+    void run();
+};
+
+// Load generator for PathServer: every client keeps up to pipeline requests in flight on its 
+// own connection and times each one from send to response. 
+class PathLoadGenerator
+{
+    string socket_path;
+    vector<Position> cells;             // endpoints are drawn from these 
+    vector<double> latencies_ms;
+    long long failed;
+    double seconds;
+
+    bool client(int index, int requests, int pipeline, uint8_t op, vector<double> &latencies, long long &failures);
+    static bool readFully(int fd, void *data, size_t length);
+    bool request(uint8_t op, string &payload, Position from=Position(0, 0), Position to=Position(0, 0), int *status=NULL);
+    static bool writeFully(int fd, const void *data, size_t length);
+
+public:
+    PathLoadGenerator(const string &socket_path, const vector<Position> &cells);
+    static int connectTo(const string &socket_path);
+    string fetchStats();
+    int query(Position from, Position to);
+    string report() const;
+    bool run(int clients, int requests, int pipeline, uint8_t op=PathServer::OP_PATH);
+    bool shutdownServer();
+};
+
+// Headless benchmark entry point, see the Benchmark section at the end of the file 
+int runBenchmark(int argc, char** argv);
+// Daemon entry points, see the Path server section at the end of the file 
+int runServer(int argc, char** argv);
+int runLoadGenerator(int argc, char** argv);
+
+
+// Main program logic -->
+int main(int argc, char** argv)
+{
+    // Headless mode: ./Main --bench <suite> [options]
+    if(argc > 1 && string(argv[1]) == "--bench")
+        return runBenchmark(argc, argv);
+    // Daemon mode: ./Main --serve <socket> [options], loaded by ./Main --load <socket> [options]
+    if(argc > 1 && string(argv[1]) == "--serve")
+        return runServer(argc, argv);
+    if(argc > 1 && string(argv[1]) == "--load")
+        return runLoadGenerator(argc, argv);
+
+    // Create a game object and initialize it: ./Main [--size <n>], 30x30 by default 
+    int size = 30;
+    if(argc > 2 && string(argv[1]) == "--size")
+        size = max(2, atoi(argv[2]));
+    Game game(size);
+
+    // Rendering Loop 
+    while(!game.shouldClose())
+    {
+        // clear the screen 
+        Terminal::clearScreen();
+
+        // Display game and menu
+        game.display();
+        
+        // Get input and execute them 
+        game.getInput();                // blocking call
+    }
+
+
+    // Clean and Exit the game 
+    game.clean();
+
+
+    return 0;
+}
+
+// Helper class/struct
+// Runs fn(lo, hi) over contiguous chunks of [begin, end), one chunk per hardware thread 
+template<typename Function>
+void parallelFor(long long begin, long long end, Function fn)
+{
+    long long count = end - begin;
+    if(count <= 0)
+        return;
+
+    long long thread_count = max(1u, thread::hardware_concurrency());
+    thread_count = min(thread_count, count);
+    if(thread_count == 1)
+    {
+        fn(begin, end);
+        return;
+    }
+
+    vector<thread> workers;
+    long long chunk = (count + thread_count - 1) / thread_count;
+    for(long long lo = begin; lo < end; lo += chunk)
+        workers.emplace_back(fn, lo, min(end, lo + chunk));
+    for(int i=0; i<workers.size(); i++)
+        workers[i].join();
+}
+
+
+// Game Method definations --> 
+Game::Game(int size, Board::Layout layout)
+{
+    this->size=size;
+    should_close = false;
+
+    diagonalMovesAllowed = true;
+    visualize = true;
+    board_version = 0;
+    search_control = NULL;
+    search_delay_us = 50000;
+    search_epsilon = 3.0f;
+    epsilon_step = 0.5f;
+    subgoal_graph = NULL;
+    junction_graph = NULL;
+    adaptive_search = NULL;
+    route_search = NULL;
+    route_count = 4;
+    route_penalty = 1.0f;
+    board_versions = NULL;
+    portfolio = NULL;
+    portfolio_ratio = 1.0f;
+    memory_budget = 256*1024;
+    memory_search_budget = SearchBudget(-1, 2000000);
+    terminal_rows = terminal_cols = 0;
+    for(int algorithm=DEPTH_FIRST_SEARCH; algorithm<=A_STAR_SEARCH; algorithm++)
+        portfolio_algorithms.push_back((SearchAlgorithm)algorithm);
+
+    // Create the board, one contiguous block in the chosen layout 
+    board = Board(size, layout);
+    tiles = TileSummary(size);
+    viewport = Viewport(size);
+
+    parallelFor(0, size, [&](long long lo, long long hi) {
+        for(int i=lo; i<hi; i++)
+            for(int j=0; j<size; j++)
+                board[i][j].setPosition(Position(i, j));
+    });
+
+
+    // Initialize the board 
+    start.setNodeHandle(board[size/5][size/5]);
+    end.setNodeHandle(board[size/3][size/2]);
+    curser.setNodeHandle(board[size/2][size/2]);
+
+
+    // set cost of start as zero
+    start.setGCost(0);    
+
+    board_versions = new VersionedBoard(*this);
+}
+Game::~Game()
+{
+    // the board and its published versions live as long as the Game, the rest is rebuilt on demand 
+    clean();
+    delete board_versions;
+    board.release();
+}
+vector<Position> Game::adaptiveSearch(Bounds *explored)
+{
+    TRACE_SCOPE("Game::adaptiveSearch");
+    if(adaptive_search == NULL)
+        adaptive_search = new AdaptiveAStar<>(WalkableBitset(snapshot()));
+    vector<Position> path = adaptive_search->findPath(start.getPosition(), end.getPosition());
+
+    // the learned h values come from anywhere on the board, so any removed wall may matter 
+    if(explored != NULL)
+    {
+        *explored = Bounds();
+        explored->include(Position(0, 0));
+        explored->include(Position(size-1, size-1));
+    }
+
+    result.addSearchCost(adaptive_search->getExpansions());
+    TRACE_COUNTER("learned h values", adaptive_search->getLearnedCount());
+    if(path.empty())
+    {
+        result.setFailure();
+        return path;
+    }
+    markPath(path);
+    result.setSuccess();
+    return path;
+}
+void Game::applyCurser()
+{
+    if(curserMode == CurserMode::INSERT_WALL)
+        insertWall(curser);
+    else if(curserMode == CurserMode::REMOVE_WALL)
+        removeWall(curser);
+}
+vector<Position> Game::anyAngleSearch(bool lazy, Bounds *explored)
+{
+    TRACE_SCOPE("Game::anyAngleSearch");
+    WalkableBitset grid(snapshot());
+    AnyAngleSearch search(grid);
+    vector<Position> waypoints = search.thetaStar(start.getPosition(), end.getPosition(), lazy);
+    if(explored != NULL)
+        *explored = search.getExploredBounds();
+
+    result.addSearchCost(search.getExpansions());
+    if(waypoints.empty())
+    {
+        result.setFailure();
+        return waypoints;
+    }
+    markWaypoints(waypoints);
+    result.setSuccess();
+    return waypoints;
+}
+template<class OpenList>
+void Game::aStarSearch()
+{
+    TRACE_SCOPE("Game::aStarSearch");
+    GameSearch<OpenList> search(*this, A_STAR_SEARCH);
+    search.step();
+    search.retrace();
+}
+const PathCache::Entry* Game::beginSolve(SearchAlgorithm algorithm)
+{
+    // same query on the same board: replay the stored path instead of searching 
+    PathQuery query(start.getPosition(), end.getPosition(), algorithm, diagonalMovesAllowed);
+    const PathCache::Entry *cached = path_cache.lookup(query, board_version);
+    result.reset();
+    result.setAlgorithm(getAlgorithmName(algorithm));
+    if(cached != NULL)
+    {
+        if(algorithm == THETA_STAR_SEARCH || algorithm == LAZY_THETA_STAR_SEARCH)
+            markWaypoints(cached->path.toVector());
+        else
+            markPath(cached->path.toVector());
+        result.setCached(!cached->path.empty());
+        return cached;
+    }
+
+    clearBuffer(BUFFER_ALL_BIT);
+    return NULL;
+}
+
+bool Game::breadthFirstSearch()
+{
+    TRACE_SCOPE("Game::breadthFirstSearch");
+    GameSearch<> search(*this, BREADTH_FIRST_SEARCH);
+    search.step();
+    search.retrace();
+    return search.getStatus() == GameSearch<>::FOUND;
+}
+void Game::changeCurserMode(CurserMode mode)
+{
+    curserMode = mode;
+    applyCurser();
+}
+void Game::clean() 
+{
+    // give the terminal back in the state we found it 
+    terminal.setRawMode(false);
+    delete subgoal_graph;
+    subgoal_graph = NULL;
+    delete junction_graph;
+    junction_graph = NULL;
+    delete adaptive_search;
+    adaptive_search = NULL;
+    delete route_search;
+    route_search = NULL;
+    delete portfolio;
+    portfolio = NULL;
+}
+void Game::clearBuffer(int buffer_clear_bit)
+{
+    TRACE_SCOPE("Game::clearBuffer");
+    // in storage order, whatever the layout 
+    for(Node *cell = board.begin(); cell != board.end(); cell++)
+    {
+        NodeHandle curr = *cell;
+        if(buffer_clear_bit & BUFFER_BIT_EXPLORED)
+            curr.markAsExplored(false);
+        if(buffer_clear_bit & BUFFER_BIT_VISITED)
+            curr.markAsVisited(false);
+        if(buffer_clear_bit & BUFFER_BIT_COST)
+            curr.setGCost(100000);
+        if(buffer_clear_bit & BUFFER_BIT_PARENT)
+            curr.setParent(NULL);
+    }
+    if(buffer_clear_bit & BUFFER_BIT_EXPLORED)
+        tiles.clear(TileSummary::EXPLORED);
+    if(buffer_clear_bit & BUFFER_BIT_VISITED)
+        tiles.clear(TileSummary::VISITED);
+    start.setGCost(0);
+}
+bool Game::depthFirstSearch()
+{
+    TRACE_SCOPE("Game::depthFirstSearch");
+    GameSearch<> search(*this, DEPTH_FIRST_SEARCH);
+    search.step();
+    search.retrace();
+    return search.getStatus() == GameSearch<>::FOUND;
+}
+template<class OpenList>
+bool Game::bestFirstSearch()
+{
+    TRACE_SCOPE("Game::bestFirstSearch");
+    GameSearch<OpenList> search(*this, BEST_FIRST_SEARCH);
+    search.step();
+    search.retrace();
+    return search.getStatus() == GameSearch<OpenList>::FOUND;
+}
+
+void Game::display()
+{
+    TRACE_SCOPE("Game::display");
+    // walls, start and end only 
+    cout<<renderFrame(false, false);
+}
+void Game::displayEditControls()
+{
+    cout<<">> Controls: "<<endl;
+    cout<<"1. Move controls:\t\tw - Up;\t\ts - Down;\ta - Left;\td - Right."<<endl;
+    cout<<"2. Change Curser Mode: \tx - Insert Wall;\tz - Remove Wall;\tc - Select Cell."<<endl;
+    cout<<"3. Replace Start and End: \tq - Put start node;\te - Put end node."<<endl;
+    cout<<endl;
+}
+void Game::displayEditUI()
+{
+    cout << ">> Legend:\t" << endl;
+    cout << ". : Empty Cell" << endl;
+    cout << "# : Wall" << endl;
+    cout << "@ : Explored Cell" << endl;
+    cout << "$ : Path to traverse" << endl;
+    cout << "S : Start Node" << endl;
+    cout << "E : End Node" << endl;
+    cout << "+ : Curser Position." << endl;
+    cout<<endl;
+}
+
+void Game::displayEditMode()
+{
+    // the view scrolls with the curser 
+    viewport.follow(curser.getPosition());
+    string frame = renderFrame(false, false, vector<Position>(), curser.getPosition());
+
+    // the curser mode goes where the frame's closing blank line was 
+    frame.erase(frame.size() - 1);
+    cout<<frame;
+    cout<<"Curser mode: "<<getCurserMode()<<endl;
+
+    cout<<endl;
+}
+void Game::displayGameState()
+{
+    cout<<renderFrame(true, false);
+}
+void Game::displayPath()
+{
+    cout<<renderFrame(false, true);
+}
+vector<Position> Game::endSolve(SearchAlgorithm algorithm, vector<Position> path, Bounds explored)
+{
+    // the Node based searches leave their path and explored cells on the board 
+    if(GameSearch<>::isSteppable(algorithm))
+    {
+        path = getPath();
+        explored = exploredBounds();
+    }
+    TRACE_COUNTER("expanded nodes", result.getSearchCost());
+    TRACE_COUNTER("path cells", path.size());
+
+    // a path cut short by the budget depends on timing, search again next time 
+    PathQuery query(start.getPosition(), end.getPosition(), algorithm, diagonalMovesAllowed);
+    if(!result.isCancelled() && !result.isBudgetExhausted())
+        path_cache.store(query, board_version, path, explored);
+    return path;
+}
+void Game::enterEditMode()
+{
+    gameMode = GameEnum::EDIT;
+    curserMode = CurserMode::SELECT;
+
+    // Edit loop 
+    while(gameMode == GameEnum::EDIT)
+    {
+        // Clear the screen first 
+        Terminal::clearScreen();
+
+        // dipslay board in edit mode 
+        cout<<"\t***Edit Mode***\t"<<endl;
+        displayEditMode();
+
+        // display edit instructions 
+        displayEditControls();
+        displayEditUI();
+        cout<<"Key to redraw: "<<latency.summary()<<endl;
+        // get input and execute edit command 
+        cout<<"Your Response: "<<flush;
+        latency.redrawn();
+
+        int key = terminal.readKey();
+        latency.keyPressed();
+
+        switch(key)
+        {
+            // Execute the responses 
+            case 'w':
+                moveUp();
+                break;
+            case 'a':
+                moveLeft();
+                break;
+            case 's':
+                moveDown();
+                break;
+            case 'd':
+                moveRight();
+                break;
+            case 'q':
+                putStart();
+                break;
+            case 'e':
+                putEnd();
+                break;
+            case 'x':
+                changeCurserMode(CurserMode::INSERT_WALL);
+                break;
+            case 'z':
+                changeCurserMode(CurserMode::REMOVE_WALL);
+                break;
+            case 'c':
+                changeCurserMode(CurserMode::SELECT);
+                break;
+            case '0':
+            case -1:
+                gameMode = GameEnum::PATH_FINDING;
+                break;
+        }
+
+
+    }
+
+}
+void Game::exitGame()
+{
+    should_close = true;
+}
+Bounds Game::exploredBounds() const
+{
+    TRACE_SCOPE("Game::exploredBounds");
+    Bounds bounds;
+    for(Node *cell = board.begin(); cell != board.end(); cell++)
+    {
+        NodeHandle curr = *cell;
+        if(curr.isExplored())
+            bounds.include(curr.getPosition());
+    }
+    return bounds;
+}
+void Game::findPath()
+{
+    while(gameMode == GameEnum::PATH_FINDING)
+    {
+        // clear screan 
+        Terminal::clearScreen();
+
+        // display the game
+        displayPath();
+        result.display();
+        path_cache.display();
+        if(portfolio != NULL)
+            cout<<portfolio->report()<<endl;
+        if(!route_report.empty())
+            cout<<route_report;
+        route_report.clear();
+
+        // clear the buffers
+        clearBuffer(BUFFER_ALL_BIT);
+        result.reset();
+
+        // display algorithms menu
+        cout<<"\t***Chose an Algorithm to Solve The Maze***\t"<<endl;
+        cout<<"1. Depth First Search"<<endl;
+        cout<<"2. Breadth First Search"<<endl;
+        cout<<"3. Best First Search algorithm"<<endl;
+        cout<<"4. Greedy Best First Search algorithm"<<endl;
+        cout<<"5. A Star algorithm"<<endl;
+        cout<<"6. Theta* (any angle)"<<endl;
+        cout<<"7. Lazy Theta* (any angle)"<<endl;
+        cout<<"8. Weighted A* (epsilon "<<search_epsilon<<")"<<endl;
+        cout<<"9. ARA* (anytime, epsilon "<<search_epsilon<<" down to 1)"<<endl;
+        cout<<"s. Subgoal graph (two-level, built once per board)"<<endl;
+        cout<<"j. Junction graph (corridors collapsed, built once per board)"<<endl;
+        cout<<"a. Adaptive A* (learns from earlier queries to the same goal)"<<endl;
+        cout<<"r. Race algorithms 1-5 (portfolio, cost within "<<portfolio_ratio<<"x of optimal)"<<endl;
+        cout<<"m. SMA* (memory bounded, "<<memory_budget/1024<<" KiB)"<<endl;
+        cout<<"k. "<<route_count<<" shortest loopless routes (Yen)"<<endl;
+        cout<<"v. "<<route_count<<" diverse routes (penalty "<<route_penalty<<" per reuse)"<<endl;
+        cout<<"0. Exit"<<endl;
+        cout<<"Enter your choice: ";
+
+
+        // get input and execute that algorithm 
+        int choice = terminal.readKey();
+
+        switch(choice)
+        {
+            case '1':
+            case '2':
+            case '3':
+            case '4':
+            case '5':
+            case '6':
+            case '7':
+            case '8':
+            case '9':
+                runSearch((SearchAlgorithm)(choice-'1'));
+                break;
+            case 's':
+                runSearch(SUBGOAL_GRAPH_SEARCH);
+                break;
+            case 'j':
+                runSearch(JUNCTION_GRAPH_SEARCH);
+                break;
+            case 'a':
+                runSearch(ADAPTIVE_A_STAR_SEARCH);
+                break;
+            case 'r':
+                runSearch(PORTFOLIO_SEARCH);
+                break;
+            case 'm':
+                runSearch(MEMORY_BOUNDED_SEARCH);
+                break;
+            case 'k':
+            case 'v':
+                findRoutes(choice == 'v');
+                break;
+            case '0':
+            case -1:
+                gameMode = GameEnum::MENU;
+                break;
+                
+        }
+
+        
+        
+    }
+
+}
+Position Game::findNearestWalkable(Position pos) const
+{
+    // scan square rings of growing radius around pos 
+    for(int radius=0; radius<size; radius++)
+    {
+        for(int r=pos.row-radius; r<=pos.row+radius; r++)
+        {
+            for(int c=pos.col-radius; c<=pos.col+radius; c++)
+            {
+                if(abs(r-pos.row) != radius && abs(c-pos.col) != radius)
+                    continue;
+                if(!wallAt(r, c))
+                    return Position(r, c);
+            }
+        }
+    }
+    return pos;
+}
+int Game::findRoutes(bool diverse)
+{
+    TRACE_SCOPE("Game::findRoutes");
+    // every route goes on the board; the path cost is the shortest one's 
+    if(route_search == NULL)
+        route_search = new AlternativeRoutes<>(WalkableBitset(snapshot()));
+    result.reset();
+    result.setAlgorithm(diverse ? "Diverse routes" : "K shortest routes");
+    clearBuffer(BUFFER_ALL_BIT);
+    const vector<AlternativeRoutes<>::Route> &routes = diverse
+        ? route_search->diverse(start.getPosition(), end.getPosition(), route_count, route_penalty)
+        : route_search->kShortest(start.getPosition(), end.getPosition(), route_count);
+    route_report = route_search->report() + "\n";
+
+    result.addSearchCost(route_search->getExpansions());
+    TRACE_COUNTER("routes", routes.size());
+    if(routes.empty())
+    {
+        result.setFailure();
+        return 0;
+    }
+    for(int r=0; r<routes.size(); r++)
+    {
+        const vector<Position> &path = routes[r].path;
+        for(int k=1; k+1<path.size(); k++)
+        {
+            markVisited(board[path[k].row][path[k].col]);
+            if(r == 0)
+                result.incPathCost();
+        }
+    }
+    result.setSuccess();
+    return routes.size();
+}
+void Game::generateBoard(MazeGenerator::GeneratorType type, uint64_t seed, float density)
+{
+    MazeGenerator generator(board, size, seed);
+    generator.generate(type, density);
+
+    // every cell may have changed 
+    board_version++;
+    path_cache.clear();
+    delete subgoal_graph;
+    subgoal_graph = NULL;
+    delete junction_graph;
+    junction_graph = NULL;
+    delete adaptive_search;
+    adaptive_search = NULL;
+    delete route_search;
+    route_search = NULL;
+
+    // Start and end have to land on open cells 
+    Position start_pos = findNearestWalkable(start.getPosition());
+    Position end_pos = findNearestWalkable(end.getPosition());
+    start = board[start_pos.row][start_pos.col];
+    end = board[end_pos.row][end_pos.col];
+    start.removeWall();
+    end.removeWall();
+    board_versions->reset(*this);
+    tiles.rebuild(board);
+
+    clearBuffer(BUFFER_ALL_BIT);
+}
+void Game::generateMaze()
+{
+    Terminal::clearScreen();
+    display();
+
+    cout<<"\t***Chose a Generator***\t"<<endl;
+    cout<<"1. Recursive Backtracker"<<endl;
+    cout<<"2. Randomized Prim"<<endl;
+    cout<<"3. Kruskal"<<endl;
+    cout<<"4. Cellular Automata Caves"<<endl;
+    cout<<"5. Rooms and Corridors"<<endl;
+    cout<<"6. Random Fill"<<endl;
+    cout<<"0. Back"<<endl;
+    cout<<"Enter your choice: ";
+
+    int choice = terminal.readKey();
+    cout<<endl;
+
+    if(choice < '1' || choice > '6')
+        return;
+    // the seed and density are read line by line 
+    terminal.setRawMode(false);
+    MazeGenerator::GeneratorType type = (MazeGenerator::GeneratorType)(choice-'1');
+
+    uint64_t seed = 0;
+    cout<<"Seed: ";
+    cin>>seed;
+
+    float density = 0.45f;
+    if(type == MazeGenerator::CELLULAR_AUTOMATA || type == MazeGenerator::RANDOM_FILL)
+    {
+        cout<<"Wall density (0-1): ";
+        cin>>density;
+    }
+    cin.ignore();
+
+    generateBoard(type, seed, density);
+}
+vector<Position> Game::anytimeSearch(bool repeat, Bounds *explored)
+{
+    TRACE_SCOPE("Game::anytimeSearch");
+    WalkableBitset grid(snapshot());
+    AnytimeSearch<> search(grid);
+    Position start_pos = start.getPosition(), end_pos = end.getPosition();
+    vector<Position> path = repeat ? search.araStar(start_pos, end_pos, search_epsilon, epsilon_step, search_budget)
+                                   : search.weightedAStar(start_pos, end_pos, search_epsilon, search_budget);
+    if(explored != NULL)
+        *explored = search.getExploredBounds();
+
+    result.addSearchCost(search.getExpansions());
+    if(!path.empty())
+    {
+        markPath(path);
+        result.setBound(search.getBound());
+        result.setFirstSolutionMs(search.getFirstSolutionMs());
+    }
+    if(search.isBudgetExhausted())
+        result.setBudgetExhausted(!path.empty());
+    else if(path.empty())
+        result.setFailure();
+    else
+        result.setSuccess();
+    return path;
+}
+float Game::getChessBoardDistance(const NodeHandle src, const NodeHandle dst) 
+{
+    Position distance = src.getPosition() - dst.getPosition();
+
+    int dx = abs(distance.row);
+    int dy = abs(distance.col);
+
+    return sqrt(2.0f)*min(dx, dy) + abs(dx-dy);
+}
+string Game::getAlgorithmName(SearchAlgorithm algorithm)
+{
+    switch(algorithm)
+    {
+        case DEPTH_FIRST_SEARCH: return "Depth First Search";
+        case BREADTH_FIRST_SEARCH: return "Breadth First Search";
+        case BEST_FIRST_SEARCH: return "Best First Search";
+        case GREEDY_BEST_FIRST_SEARCH: return "Greedy Best First Search";
+        case A_STAR_SEARCH: return "A star";
+        case THETA_STAR_SEARCH: return "Theta star";
+        case LAZY_THETA_STAR_SEARCH: return "Lazy Theta star";
+        case WEIGHTED_A_STAR_SEARCH: return "Weighted A star";
+        case ARA_STAR_SEARCH: return "ARA star";
+        case SUBGOAL_GRAPH_SEARCH: return "Subgoal graph";
+        case JUNCTION_GRAPH_SEARCH: return "Junction graph";
+        case PORTFOLIO_SEARCH: return "Portfolio";
+        case ADAPTIVE_A_STAR_SEARCH: return "Adaptive A star";
+        case MEMORY_BOUNDED_SEARCH: return "SMA star";
+    }
+    return "None";
+}
+PathCache& Game::getPathCache()
+{
+    return path_cache;
+}
+Result& Game::getResult()
+{
+    return result;
+}
+const TileSummary& Game::getTileSummary() const
+{
+    return tiles;
+}
+Viewport& Game::getViewport()
+{
+    return viewport;
+}
+TileSummary Game::recountTiles() const
+{
+    // straight from the board, to check the counts kept as cells are marked 
+    TileSummary recount(size);
+    recount.rebuild(board);
+    return recount;
+}
+int Game::getSize() const
+{
+    return size;
+}
+CompactPath Game::getCompactPath()
+{
+    TRACE_SCOPE("Game::getCompactPath");
+    // follow the parents from end back to start, without marking the board 
+    CompactPath path;
+    if(end != start && end.getParent() == NULL)
+        return path;
+
+    NodeHandle curr = end;
+    path.append(curr.getPosition());
+    while(curr != start && curr.getParent() != NULL)
+    {
+        curr = curr.getParent();
+        path.append(curr.getPosition());
+    }
+    path.reverse();
+    return path;
+}
+vector<Position> Game::getPath()
+{
+    return getCompactPath().toVector();
+}
+string Game::getCurserMode()
+{
+    if(curserMode == CurserMode::INSERT_WALL)
+        return "Insesrt Wall";
+    else if(curserMode == CurserMode::REMOVE_WALL)
+        return "Remove Wall";
+    else 
+        return "Select";
+}
+float Game::getEuclidianDistance(const NodeHandle src, const NodeHandle dst) 
+{
+    Position distance = src.getPosition() - dst.getPosition();
+    
+    int dx = abs(distance.row);
+    int dy = abs(distance.col);
+
+    return sqrt(dx*dx+dy*dy);
+}
+
+void Game::getInput()
+{
+    // display the main menu 
+    cout<<"1. Edit Board"<<endl;
+    cout<<"2. Find Path"<<endl;
+    cout<<"3. Generate Board"<<endl;
+    cout<<"0. Exit"<<endl;
+
+    // ask for choice 
+    cout<<"Enter your choice here: "<<flush;
+    int choice = terminal.readKey();
+
+    switch(choice)
+    {
+        case '1':
+            enterEditMode();
+            break;
+        case '2':
+            findPath();
+            break;
+        case '3':
+            generateMaze();
+            break;
+        case '0':
+        case -1:
+            exitGame();
+            break;
+    }
+
+}
+float Game::getManhattanDistance(const NodeHandle src, const NodeHandle dst) 
+{
+    Position distance = src.getPosition() - dst.getPosition();
+    return abs(distance.row) + abs(distance.col);
+}
+template<class OpenList>
+bool Game::greedyBestFirstSearch()
+{
+    TRACE_SCOPE("Game::greedyBestFirstSearch");
+    GameSearch<OpenList> search(*this, GREEDY_BEST_FIRST_SEARCH);
+    search.step();
+    search.retrace();
+    return search.getStatus() == GameSearch<OpenList>::FOUND;
+}
+void Game::insertWall(NodeHandle cell)
+{
+    // start and end can not become walls 
+    if(!cell.isWalkable() || cell == start || cell == end)
+        return;
+    cell.insertWall();
+    tiles.add(cell.getPosition(), TileSummary::WALL, 1);
+
+    board_version++;
+    path_cache.onWallInserted(cell.getPosition(), board_version);
+    if(subgoal_graph != NULL)
+        subgoal_graph->setWall(cell.getPosition(), true);
+    if(junction_graph != NULL)
+        junction_graph->setWall(cell.getPosition(), true);
+    if(adaptive_search != NULL)
+        adaptive_search->setWall(cell.getPosition(), true);
+    if(route_search != NULL)
+        route_search->setWall(cell.getPosition(), true);
+    board_versions->setWall(cell.getPosition(), true);
+}
+vector<NodeHandle> Game::getNeighbours(const NodeHandle &curr)
+{
+    TRACE_SAMPLE("Game::getNeighbours");
+    vector<NodeHandle> neighbourList;
+    int dx, dy;
+    for(int dx=-1; dx<=1; dx++)
+    {
+        for(int dy=-1; dy<=1; dy++)
+        {
+            if(dx == 0 && dy == 0)
+                continue;
+            
+            int x=curr.getPosition().row+dx;
+            int y=curr.getPosition().col+dy;
+            
+            if(isOutOfBounds(Position(x,y)))
+                continue;
+            
+            if(board[x][y].isWalkable())
+                neighbourList.push_back(board[x][y]);
+
+        }
+    }
+    return neighbourList;
+}
+
+bool Game::isOutOfBounds(Position curr) const
+{
+    if(curr.row < 0 || curr.col < 0 || curr.row >= size || curr.col >= size)
+        return true;
+    return false;
+}
+vector<Position> Game::junctionSearch(Bounds *explored)
+{
+    TRACE_SCOPE("Game::junctionSearch");
+    if(junction_graph == NULL)
+        junction_graph = new JunctionGraph<>(WalkableBitset(snapshot()));
+    vector<Position> path = junction_graph->findPath(start.getPosition(), end.getPosition());
+
+    // removing a wall can join a dead end to the rest of the graph anywhere on the board 
+    if(explored != NULL)
+    {
+        *explored = Bounds();
+        explored->include(Position(0, 0));
+        explored->include(Position(size-1, size-1));
+    }
+
+    result.addSearchCost(junction_graph->getExpansions());
+    if(path.empty())
+    {
+        result.setFailure();
+        return path;
+    }
+    markPath(path);
+    result.setSuccess();
+    return path;
+}
+void Game::markExplored(NodeHandle cell)
+{
+    // the tile counts follow the board's marks, so a cell is only counted once 
+    if(cell.isExplored())
+        return;
+    cell.markAsExplored();
+    tiles.add(cell.getPosition(), TileSummary::EXPLORED, 1);
+}
+void Game::markPath(const vector<Position> &path)
+{
+    // same marks GameSearch::retrace leaves on the cells between the endpoints 
+    for(int k=1; k+1<path.size(); k++)
+    {
+        NodeHandle cell = board[path[k].row][path[k].col];
+        markVisited(cell);
+        result.incPathCost();
+    }
+}
+void Game::markVisited(NodeHandle cell)
+{
+    if(cell.isVisited())
+        return;
+    cell.markAsVisited();
+    tiles.add(cell.getPosition(), TileSummary::VISITED, 1);
+}
+void Game::markWaypoints(const vector<Position> &waypoints)
+{
+    // mark the cells under each straight segment so displayPath can show them 
+    for(int k=0; k+1<waypoints.size(); k++)
+    {
+        Position a = waypoints[k], b = waypoints[k+1];
+        int steps = max(abs(b.row-a.row), abs(b.col-a.col));
+        for(int t=1; t<=steps; t++)
+        {
+            int r = a.row + (int)lround((double)(b.row-a.row)*t/steps);
+            int c = a.col + (int)lround((double)(b.col-a.col)*t/steps);
+            NodeHandle cell = board[r][c];
+            if(cell != start && cell != end)
+                markVisited(cell);
+            result.incPathCost();
+        }
+    }
+}
+vector<Position> Game::memoryBoundedSearch(Bounds *explored)
+{
+    TRACE_SCOPE("Game::memoryBoundedSearch");
+    // the arena lives for this query only, so the board pays nothing between queries 
+    MemoryBoundedSearch search(WalkableBitset(snapshot()), memory_budget);
+    vector<Position> path = search.findPath(start.getPosition(), end.getPosition(), memory_search_budget);
+
+    // which cells SMA* looked at is forgotten with the nodes, so any removed wall may matter 
+    if(explored != NULL)
+    {
+        *explored = Bounds();
+        explored->include(Position(0, 0));
+        explored->include(Position(size-1, size-1));
+    }
+
+    result.addSearchCost(search.getExpansions());
+    TRACE_COUNTER("SMA* peak bytes", search.getPeakBytes());
+    TRACE_COUNTER("SMA* regenerations", search.getRegenerations());
+    if(path.empty())
+    {
+        result.setFailure();
+        return path;
+    }
+    markPath(path);
+    result.setSuccess();
+    return path;
+}
+MultiAgentStats Game::planAgents(vector<Agent> &agents, int window)
+{
+    MultiAgentPlanner planner(*this, diagonalMovesAllowed, window);
+    return planner.plan(agents);
+}
+vector<Position> Game::portfolioSearch(Bounds *explored)
+{
+    TRACE_SCOPE("Game::portfolioSearch");
+    if(portfolio == NULL)
+        portfolio = new PortfolioSolver(*this, portfolio_algorithms);
+    vector<Position> path = portfolio->solve(portfolio_ratio, search_control);
+    if(explored != NULL)
+        *explored = portfolio->getExploredBounds();
+
+    int winner = portfolio->getWinner();
+    if(winner >= 0)
+    {
+        result.addSearchCost(portfolio->getRacers()[winner].expansions);
+        TRACE_COUNTER("portfolio winner", portfolio->getRacers()[winner].algorithm);
+    }
+    else if(search_control != NULL && search_control->isCancelled())
+    {
+        result.setCancelled();
+        return path;
+    }
+    if(path.empty())
+    {
+        result.setFailure();
+        return path;
+    }
+    markPath(path);
+    result.setSuccess();
+    return path;
+}
+void Game::moveUp()
+{
+    int x, y;
+    x = curser.getPosition().row-1;
+    y = curser.getPosition().col;
+
+    if(isOutOfBounds(Position(x,y)))
+        return;
+    
+    curser = board[x][y];
+    applyCurser();
+}
+void Game::moveDown()
+{
+    int x, y;
+    x = curser.getPosition().row+1;
+    y = curser.getPosition().col;
+
+    if(isOutOfBounds(Position(x,y)))
+        return;
+    curser = board[x][y];
+    applyCurser();
+}
+void Game::moveLeft()
+{
+    int x, y;
+    x = curser.getPosition().row;
+    y = curser.getPosition().col-1;
+
+    if(isOutOfBounds(Position(x,y)))
+        return;
+    curser = board[x][y];
+    applyCurser();
+}
+void Game::moveRight()
+{
+    int x, y;
+    x = curser.getPosition().row;
+    y = curser.getPosition().col+1;
+
+    if(isOutOfBounds(Position(x,y)))
+        return;
+    curser = board[x][y];
+    applyCurser();
+}
+void Game::putEnd()
+{
+    if(curser.isWalkable() && curser != start)
+        end = curser;
+}
+void Game::putStart()
+{
+    if(curser.isWalkable() && curser != end)
+        start = curser;
+}
+void Game::removeWall(NodeHandle cell)
+{
+    if(cell.isWalkable())
+        return;
+    cell.removeWall();
+    tiles.add(cell.getPosition(), TileSummary::WALL, -1);
+
+    board_version++;
+    path_cache.onWallRemoved(cell.getPosition(), board_version);
+    if(subgoal_graph != NULL)
+        subgoal_graph->setWall(cell.getPosition(), false);
+    if(junction_graph != NULL)
+        junction_graph->setWall(cell.getPosition(), false);
+    if(adaptive_search != NULL)
+        adaptive_search->setWall(cell.getPosition(), false);
+    if(route_search != NULL)
+        route_search->setWall(cell.getPosition(), false);
+    board_versions->setWall(cell.getPosition(), false);
+}
+string Game::renderFrame(bool show_explored, bool show_visited, const vector<Position> &frontier, Position curser_pos)
+{
+    TRACE_SCOPE("Game::renderFrame");
+    // the same board displayGameState/displayPath print, built as one string so a 
+    // search thread can hand it to the UI thread. Only the viewport's cells are read, 
+    // so a frame costs as much as the terminal shows, whatever the board size 
+    int rows = terminal_rows, cols = terminal_cols;
+    if(rows <= 0 || cols <= 0)
+        Terminal::getSize(rows, cols);
+    viewport.fit(rows, cols);
+    int top = viewport.getTop(), left = viewport.getLeft();
+    rows = viewport.getRows();
+    cols = viewport.getCols();
+
+    vector<char> cells((size_t)rows*cols);
+    Position start_pos = start.getPosition(), end_pos = end.getPosition();
+    for(int i=0; i<rows; i++)
+    {
+        for(int j=0; j<cols; j++)
+        {
+            NodeHandle curr = board[top+i][left+j];
+            char symbol = curr.isWalkable() ? SYMBOL_EMPTY : SYMBOL_WALL;
+            if(show_explored && curr.isExplored())
+                symbol = SYMBOL_EXPLORED;
+            if(show_visited && curr.isVisited())
+                symbol = SYMBOL_VISITED;
+            cells[(size_t)i*cols + j] = symbol;
+        }
+    }
+    if(viewport.contains(start_pos))
+        cells[(size_t)(start_pos.row-top)*cols + start_pos.col-left] = SYMBOL_START;
+    if(viewport.contains(end_pos))
+        cells[(size_t)(end_pos.row-top)*cols + end_pos.col-left] = SYMBOL_END;
+
+    // cells waiting to be expanded, drawn over the finished board 
+    for(int k=0; k<frontier.size(); k++)
+    {
+        Position pos = frontier[k];
+        if(viewport.contains(pos) && !(pos == start_pos) && !(pos == end_pos))
+            cells[(size_t)(pos.row-top)*cols + pos.col-left] = SYMBOL_FRONTIER;
+    }
+    if(viewport.contains(curser_pos))
+        cells[(size_t)(curser_pos.row-top)*cols + curser_pos.col-left] = SYMBOL_CURSER;
+
+    vector<string> minimap = renderMinimap(show_explored, show_visited);
+    string frame = "\t***Game Board***\t\n";
+    frame.reserve(frame.size() + (size_t)rows*(2*cols+1) + (minimap.empty() ? 0 : minimap.size()*(minimap[0].size()+2)) + 128);
+    for(int i=0; i<rows; i++)
+    {
+        for(int j=0; j<cols; j++)
+        {
+            frame += cells[(size_t)i*cols + j];
+            frame += ' ';
+        }
+        if(i < minimap.size())
+        {
+            frame += "  ";
+            frame += minimap[i];
+        }
+        frame += '\n';
+    }
+    if(!viewport.isWhole())
+    {
+        ostringstream caption;
+        caption<<"Rows "<<top<<"-"<<top+rows-1<<", columns "<<left<<"-"<<left+cols-1<<" of "<<size<<"x"<<size
+               <<"; the minimap shows the whole board, highlighted where the view is"<<endl;
+        frame += caption.str();
+    }
+    frame += '\n';
+    return frame;
+}
+vector<string> Game::renderMinimap(bool show_explored, bool show_visited) const
+{
+    // one character per block of tiles, from the tile counts alone: the path, then explored 
+    // cells, then walls when they cover half the block. The blocks under the viewport are 
+    // drawn in reverse video 
+    int blocks = viewport.getBlocks();
+    int tiles_per_row = tiles.getTilesPerRow();
+    int view_bottom = viewport.getTop() + viewport.getRows(), view_right = viewport.getLeft() + viewport.getCols();
+    Position start_pos = start.getPosition(), end_pos = end.getPosition();
+    vector<string> lines(blocks);
+    for(int i=0; i<blocks; i++)
+    {
+        int tile_top = i*tiles_per_row/blocks, tile_bottom = (i+1)*tiles_per_row/blocks;
+        int cell_top = tile_top*TileSummary::TILE, cell_bottom = min(size, tile_bottom*TileSummary::TILE);
+        bool view_rows = cell_top < view_bottom && viewport.getTop() < cell_bottom;
+        bool highlighted = false;
+        for(int j=0; j<blocks; j++)
+        {
+            int tile_left = j*tiles_per_row/blocks, tile_right = (j+1)*tiles_per_row/blocks;
+            int cell_left = tile_left*TileSummary::TILE, cell_right = min(size, tile_right*TileSummary::TILE);
+            TileSummary::Counts counts = tiles.sum(tile_top, tile_left, tile_bottom, tile_right);
+
+            char symbol = 2*counts.marks[TileSummary::WALL] >= counts.cells ? SYMBOL_WALL : SYMBOL_EMPTY;
+            if(show_explored && counts.marks[TileSummary::EXPLORED] > 0)
+                symbol = SYMBOL_EXPLORED;
+            if(show_visited && counts.marks[TileSummary::VISITED] > 0)
+                symbol = SYMBOL_VISITED;
+            if(start_pos.row >= cell_top && start_pos.row < cell_bottom && start_pos.col >= cell_left && start_pos.col < cell_right)
+                symbol = SYMBOL_START;
+            if(end_pos.row >= cell_top && end_pos.row < cell_bottom && end_pos.col >= cell_left && end_pos.col < cell_right)
+                symbol = SYMBOL_END;
+
+            bool in_view = view_rows && cell_left < view_right && viewport.getLeft() < cell_right;
+            if(in_view != highlighted)
+                lines[i] += in_view ? "\033[7m" : "\033[0m";
+            highlighted = in_view;
+            lines[i] += symbol;
+            lines[i] += ' ';
+        }
+        if(highlighted)
+            lines[i] += "\033[0m";
+    }
+    return lines;
+}
+void Game::setAnytimeOptions(float epsilon, float epsilon_step, SearchBudget budget)
+{
+    search_epsilon = max(1.0f, epsilon);
+    this->epsilon_step = epsilon_step;
+    search_budget = budget;
+    // stored weighted paths were found with the old options 
+    path_cache.clear();
+}
+void Game::setEndpoints(Position start_pos, Position end_pos)
+{
+    removeWall(board[start_pos.row][start_pos.col]);
+    removeWall(board[end_pos.row][end_pos.col]);
+    start = board[start_pos.row][start_pos.col];
+    end = board[end_pos.row][end_pos.col];
+    clearBuffer(BUFFER_ALL_BIT);
+}
+void Game::setMemoryBudget(size_t bytes, SearchBudget budget)
+{
+    memory_budget = bytes;
+    memory_search_budget = budget;
+    // a path that did not fit may fit now, and the other way round 
+    path_cache.clear();
+}
+void Game::setPortfolioOptions(const vector<SearchAlgorithm> &algorithms, float max_cost_ratio)
+{
+    portfolio_algorithms.clear();
+    for(int k=0; k<algorithms.size(); k++)
+        if(GameSearch<>::isSteppable(algorithms[k]))
+            portfolio_algorithms.push_back(algorithms[k]);
+    portfolio_ratio = max(1.0f, max_cost_ratio);
+    delete portfolio;
+    portfolio = NULL;
+    // stored portfolio paths met the old ratio 
+    path_cache.clear();
+}
+void Game::setRouteOptions(int count, float penalty)
+{
+    route_count = max(1, count);
+    route_penalty = max(0.0f, penalty);
+}
+void Game::setTerminalSize(int rows, int cols)
+{
+    // frames are laid out for this size instead of the terminal's, 0 to ask it again 
+    terminal_rows = rows;
+    terminal_cols = cols;
+}
+void Game::setWall(Position pos, bool wall)
+{
+    if(isOutOfBounds(pos))
+        return;
+    if(wall)
+        insertWall(board[pos.row][pos.col]);
+    else
+        removeWall(board[pos.row][pos.col]);
+}
+void Game::setVisualize(bool visualize)
+{
+    this->visualize = visualize;
+}
+BoardSnapshot Game::snapshot() const
+{
+    return board_versions->snapshot();
+}
+vector<Position> Game::solve(SearchAlgorithm algorithm)
+{
+    TRACE_SCOPE("Game::solve");
+    const PathCache::Entry *cached = beginSolve(algorithm);
+    if(cached != NULL)
+        return cached->path.toVector();
+
+    vector<Position> path;
+    Bounds explored;
+    switch(algorithm)
+    {
+        case DEPTH_FIRST_SEARCH:
+            depthFirstSearch();
+            break;
+        case BREADTH_FIRST_SEARCH:
+            breadthFirstSearch();
+            break;
+        case BEST_FIRST_SEARCH:
+            bestFirstSearch();
+            break;
+        case GREEDY_BEST_FIRST_SEARCH:
+            greedyBestFirstSearch();
+            break;
+        case A_STAR_SEARCH:
+            aStarSearch();
+            break;
+        case THETA_STAR_SEARCH:
+        case LAZY_THETA_STAR_SEARCH:
+            path = anyAngleSearch(algorithm == LAZY_THETA_STAR_SEARCH, &explored);
+            break;
+        case WEIGHTED_A_STAR_SEARCH:
+        case ARA_STAR_SEARCH:
+            path = anytimeSearch(algorithm == ARA_STAR_SEARCH, &explored);
+            break;
+        case SUBGOAL_GRAPH_SEARCH:
+            path = subgoalSearch(&explored);
+            break;
+        case JUNCTION_GRAPH_SEARCH:
+            path = junctionSearch(&explored);
+            break;
+        case PORTFOLIO_SEARCH:
+            path = portfolioSearch(&explored);
+            break;
+        case ADAPTIVE_A_STAR_SEARCH:
+            path = adaptiveSearch(&explored);
+            break;
+        case MEMORY_BOUNDED_SEARCH:
+            path = memoryBoundedSearch(&explored);
+            break;
+    }
+    return endSolve(algorithm, path, explored);
+}
+vector<Position> Game::subgoalSearch(Bounds *explored)
+{
+    TRACE_SCOPE("Game::subgoalSearch");
+    if(subgoal_graph == NULL)
+        subgoal_graph = new SubgoalGraph<>(WalkableBitset(snapshot()));
+    vector<Position> path = subgoal_graph->findPath(start.getPosition(), end.getPosition());
+
+    // the graph spans the whole board, so any removed wall may matter 
+    if(explored != NULL)
+    {
+        *explored = Bounds();
+        explored->include(Position(0, 0));
+        explored->include(Position(size-1, size-1));
+    }
+
+    result.addSearchCost(subgoal_graph->getExpansions());
+    if(path.empty())
+    {
+        result.setFailure();
+        return path;
+    }
+    markPath(path);
+    result.setSuccess();
+    return path;
+}
+void Game::runSearch(SearchAlgorithm algorithm)
+{
+    if(GameSearch<>::isSteppable(algorithm))
+    {
+        stepSearch(algorithm);
+        return;
+    }
+
+    SearchControl control(search_delay_us);
+    search_control = &control;
+    thread worker([this, algorithm, &control]() {
+        solve(algorithm);
+        control.finish();
+    });
+
+    // event loop: wake on a key press or on a new frame, never block the search 
+    string frame = "Finding a path ... \n";
+    uint64_t frame_id = 0;
+    bool redraw = true;
+    while(!control.isFinished())
+    {
+        int fd = control.getNotifyFd();
+        int ready = terminal.waitForInput(fd, 100);
+        if(ready & Terminal::FD_READY)
+            control.drainNotifications();
+
+        if(ready & Terminal::KEY_READY)
+        {
+            int key = terminal.readKey(0);
+            latency.keyPressed();
+            switch(key)
+            {
+                case 'c':
+                case '0':
+                case -1:
+                    control.cancel();
+                    break;
+                case 'p':
+                    control.togglePause();
+                    break;
+                case '+':
+                    control.setDelay(control.getDelay()/2);
+                    break;
+                case '-':
+                    control.setDelay(max(1000, min(1000000, control.getDelay()*2)));
+                    break;
+            }
+            redraw = true;
+        }
+
+        if(control.takeFrame(frame, frame_id))
+            redraw = true;
+        if(!redraw)
+            continue;
+
+        // one write per frame 
+        ostringstream screen;
+        screen<<frame;
+        screen<<(control.isPaused() ? "[Paused]" : "[Running]")<<" delay "<<control.getDelay()/1000.0<<" ms"
+              <<"   p - Pause/Resume;  + - Faster;  - - Slower;  c - Cancel"<<endl;
+        screen<<"Key to redraw: "<<latency.summary()<<endl;
+        Terminal::clearScreen();
+        cout<<screen.str()<<flush;
+        latency.redrawn();
+        redraw = false;
+    }
+
+    worker.join();
+    search_control = NULL;
+    search_delay_us = control.getDelay();
+}
+void Game::stepSearch(SearchAlgorithm algorithm)
+{
+    // the UI pulls frames: the search only runs between them, one expansion per delay, 
+    // batched so at most one frame is drawn every FRAME_US; the path found is then retraced 
+    // the same way, RETRACE_SLOWDOWN delays per cell 
+    const int FRAME_US = 16000;
+    const int RETRACE_SLOWDOWN = 6;
+    if(beginSolve(algorithm) != NULL)
+        return;
+
+    GameSearch<> search(*this, algorithm);
+    int delay_us = search_delay_us;
+    bool paused = false;
+    while(true)
+    {
+        bool retracing = search.getStatus() == GameSearch<>::FOUND;
+        int cell_us = retracing ? RETRACE_SLOWDOWN*delay_us : delay_us;
+        if(!paused)
+        {
+            if(retracing)
+            {
+                if(!search.retrace(max(1, FRAME_US / max(1, cell_us))))
+                    break;
+            }
+            else
+                search.step(max(1, FRAME_US / max(1, cell_us)));
+        }
+        if(search.getStatus() == GameSearch<>::NOT_FOUND)
+            break;
+
+        viewport.follow(search.getCurrent().getPosition());
+        ostringstream screen;
+        if(retracing)
+        {
+            screen<<"Retracing the path ... \n"<<renderFrame(false, true);
+            screen<<(paused ? "[Paused]" : "[Running]")<<" delay "<<delay_us/1000.0<<" ms, "<<search.getExpansions()<<" expanded"
+                  <<"   p - Pause/Resume;  + - Faster;  - - Slower;  c - Skip"<<endl;
+        }
+        else
+        {
+            vector<Position> frontier;
+            search.forEachFrontier([&](NodeHandle node) { frontier.push_back(node.getPosition()); });
+            screen<<"Finding a path ... \n"<<renderFrame(true, false, frontier);
+            screen<<(paused ? "[Paused]" : "[Running]")<<" delay "<<delay_us/1000.0<<" ms, "<<search.getExpansions()<<" expanded, "
+                  <<frontier.size()<<" in the frontier   p - Pause/Resume;  + - Faster;  - - Slower;  c - Cancel"<<endl;
+        }
+        screen<<"Key to redraw: "<<latency.summary()<<endl;
+        Terminal::clearScreen();
+        cout<<screen.str()<<flush;
+        latency.redrawn();
+
+        if(!(terminal.waitForInput(-1, max(cell_us, FRAME_US)/1000) & Terminal::KEY_READY))
+            continue;
+        int key = terminal.readKey(0);
+        latency.keyPressed();
+        if(key == 'c' || key == '0' || key == -1)
+        {
+            // a cancel during the retrace only skips the animation, the path stays found 
+            if(search.getStatus() == GameSearch<>::FOUND)
+                search.retrace();
+            else
+                result.setCancelled();
+            break;
+        }
+        if(key == 'p')
+            paused = !paused;
+        else if(key == '+')
+            delay_us = max(1, delay_us/2);
+        else if(key == '-')
+            delay_us = max(1000, min(1000000, delay_us*2));
+    }
+    search_delay_us = delay_us;
+    endSolve(algorithm, vector<Position>(), Bounds());
+}
+bool Game::shouldClose()
+{
+    return should_close;
+}
+
+void Game::updateNeighbourCost(NodeHandle curr)
+{
+    TRACE_SAMPLE("Game::updateNeighbourCost");
+    vector<NodeHandle> neighbours = getNeighbours(curr);
+    for(int i=0; i<neighbours.size(); i++)
+    {
+        
+        if(!neighbours[i].isWalkable())
+            continue;
+        
+        float new_neighbour_cost = curr.getGCost() + getChessBoardDistance(curr, neighbours[i]);
+        if(new_neighbour_cost < neighbours[i].getGCost())
+        {
+            neighbours[i].setGCost(new_neighbour_cost);
+            neighbours[i].setHCost(getChessBoardDistance(curr, neighbours[i]));
+            neighbours[i].setParent(curr);
+        }
+    }
+}
+bool Game::wallAt(int row, int col) const
+{
+    if(isOutOfBounds(Position(row, col)))
+        return true;
+    return !board[row][col].isWalkable();
+}
+
+
+
+// GameSearch Method definations --> 
+template<class OpenList>
+GameSearch<OpenList>::GameSearch(Game &game, SearchAlgorithm algorithm) : game(game)
+{
+    this->algorithm = algorithm;
+    status = RUNNING;
+    expansions = 0;
+    retraced = 0;
+
+    // the start goes in the way each search always queued it 
+    NodeHandle start = game.start;
+    if(algorithm == BREADTH_FIRST_SEARCH)
+    {
+        fifo.push_back(start);
+        open.insert(start);
+        game.markExplored(start);
+    }
+    else if(algorithm == BEST_FIRST_SEARCH)
+    {
+        open_list.push(start, start.getGCost());
+        open.insert(start);
+        game.markExplored(start);
+    }
+    else if(algorithm == GREEDY_BEST_FIRST_SEARCH)
+    {
+        greedy_list.push(start, start.getHCost(game.end));
+        open.insert(start);
+    }
+    else if(algorithm == A_STAR_SEARCH)
+        open_list.push(start, start.getFCost(game.end), start.getHCost(game.end));
+}
+template<class OpenList>
+bool GameSearch<OpenList>::expandAStar()
+{
+    while(!open_list.empty())
+    {
+        NodeHandle curr = open_list.pop();
+
+        // a cheaper copy of this node was pushed later and already expanded 
+        if(curr.isExplored())
+            continue;
+        game.markExplored(curr);
+        game.result.incSearchCost();
+        expansions++;
+        current = curr;
+        if(curr == game.end)
+            return finish(true);
+
+        vector<NodeHandle> neighbourList = game.getNeighbours(curr);
+        for(int i=0; i<neighbourList.size(); i++)
+        {
+            NodeHandle &neighbour = neighbourList[i];
+            if(!neighbour.isWalkable() || neighbour.isExplored())
+                continue;
+
+            float new_cost_to_neighbour = curr.getGCost() + Game::getChessBoardDistance(curr, neighbour);
+            if(new_cost_to_neighbour < neighbour.getGCost())
+            {
+                neighbour.setGCost(new_cost_to_neighbour);
+                neighbour.setParent(curr);
+                // the open list keeps the key it was given, so push again instead of decrease-key 
+                open_list.push(neighbour, neighbour.getFCost(game.end), neighbour.getHCost(game.end));
+            }
+        }
+        return true;
+    }
+    return finish(false);
+}
+template<class OpenList>
+bool GameSearch<OpenList>::expandBreadthFirst()
+{
+    if(fifo.empty())
+        return finish(false);
+
+    NodeHandle curr = fifo.front();
+    game.result.incSearchCost();
+    expansions++;
+    current = curr;
+    if(curr == game.end)
+        return finish(true);
+
+    game.updateNeighbourCost(curr);
+    vector<NodeHandle> neighbours = game.getNeighbours(curr);
+    TRACE_SAMPLE("Game open set and queue");
+    for(int i=0; i<neighbours.size(); i++)
+    {
+        if(!neighbours[i].isWalkable() || open.find(neighbours[i]) != open.end() || neighbours[i].isExplored())
+            continue;
+        fifo.push_back(neighbours[i]);
+        open.insert(neighbours[i]);
+    }
+
+    fifo.pop_front();
+    open.erase(curr);
+    game.markExplored(curr);
+    return true;
+}
+template<class OpenList>
+bool GameSearch<OpenList>::expandDepthFirst()
+{
+    // the start first, then the next untried neighbour of the deepest branch, 
+    // giving up on a branch once all its neighbours were tried 
+    NodeHandle next = game.start;
+    bool found = expansions == 0;
+    while(!found && !branches.empty())
+    {
+        Branch &branch = branches.back();
+        while(!found && branch.next < branch.neighbours.size())
+        {
+            next = branch.neighbours[branch.next++];
+            found = next.isWalkable() && !next.isExplored();
+        }
+        if(!found)
+            branches.pop_back();
+    }
+    if(!found)
+        return finish(false);
+
+    game.markExplored(next);
+    game.result.incSearchCost();
+    expansions++;
+    current = next;
+    if(next == game.end)
+        return finish(true);
+
+    game.updateNeighbourCost(next);
+    Branch branch;
+    branch.node = next;
+    branch.neighbours = game.getNeighbours(next);
+    branch.next = 0;
+    branches.push_back(branch);
+    return true;
+}
+template<class OpenList>
+template<class List>
+bool GameSearch<OpenList>::expandOrdered(List &list, bool greedy)
+{
+    // best-first orders by the cost so far, greedy by the estimate left 
+    if(list.empty())
+        return finish(false);
+
+    NodeHandle curr = list.pop();
+    open.erase(curr);
+    game.markExplored(curr);
+    game.result.incSearchCost();
+    expansions++;
+    current = curr;
+    if(curr == game.end)
+        return finish(true);
+
+    game.updateNeighbourCost(curr);
+    vector<NodeHandle> neighbours = game.getNeighbours(curr);
+    TRACE_SAMPLE("Game open set and queue");
+    for(int i=0; i<neighbours.size(); i++)
+    {
+        if(!neighbours[i].isWalkable() || open.find(neighbours[i]) != open.end() || neighbours[i].isExplored())
+            continue;
+        list.push(neighbours[i], greedy ? neighbours[i].getHCost(game.end) : neighbours[i].getGCost());
+        open.insert(neighbours[i]);
+    }
+    return true;
+}
+template<class OpenList>
+bool GameSearch<OpenList>::finish(bool found)
+{
+    // only the parents are followed here, the cells are marked by retrace() 
+    status = found ? FOUND : NOT_FOUND;
+    if(found)
+    {
+        if(game.end.getParent() != NULL)
+            for(NodeHandle curr = game.end.getParent(); curr.getParent() != NULL && curr != game.start; curr = curr.getParent())
+                path.push_back(curr);
+        game.result.setSuccess();
+    }
+    else
+        game.result.setFailure();
+    return false;
+}
+template<class OpenList>
+template<typename Function>
+void GameSearch<OpenList>::forEachFrontier(Function fn) const
+{
+    // cells queued and not expanded yet; for depth-first, the untried neighbours along the 
+    // current branch. A* may visit a cell once per copy it has in the open list. 
+    if(algorithm == DEPTH_FIRST_SEARCH)
+    {
+        for(size_t b=0; b<branches.size(); b++)
+            for(size_t k=branches[b].next; k<branches[b].neighbours.size(); k++)
+            {
+                NodeHandle node = branches[b].neighbours[k];
+                if(node.isWalkable() && !node.isExplored())
+                    fn(node);
+            }
+    }
+    else if(algorithm == BREADTH_FIRST_SEARCH)
+        for_each(fifo.begin(), fifo.end(), fn);
+    else if(algorithm == A_STAR_SEARCH)
+        open_list.forEach([&](NodeHandle node) {
+            if(!node.isExplored())
+                fn(node);
+        });
+    else
+        for_each(open.begin(), open.end(), fn);
+}
+template<class OpenList>
+NodeHandle GameSearch<OpenList>::getCurrent() const
+{
+    return current;
+}
+template<class OpenList>
+long long GameSearch<OpenList>::getExpansions() const
+{
+    return expansions;
+}
+template<class OpenList>
+size_t GameSearch<OpenList>::getFrontierSize() const
+{
+    size_t count = 0;
+    forEachFrontier([&](NodeHandle) { count++; });
+    return count;
+}
+template<class OpenList>
+typename GameSearch<OpenList>::Status GameSearch<OpenList>::getStatus() const
+{
+    return status;
+}
+template<class OpenList>
+bool GameSearch<OpenList>::isSteppable(SearchAlgorithm algorithm)
+{
+    return algorithm == DEPTH_FIRST_SEARCH || algorithm == BREADTH_FIRST_SEARCH || algorithm == BEST_FIRST_SEARCH
+        || algorithm == GREEDY_BEST_FIRST_SEARCH || algorithm == A_STAR_SEARCH;
+}
+template<class OpenList>
+bool GameSearch<OpenList>::retrace(long long max_cells)
+{
+    // marks up to max_cells more cells of the path found, from the goal back; false once 
+    // the whole path is marked (or nothing was found) 
+    for(; max_cells > 0 && retraced < path.size(); max_cells--)
+    {
+        current = path[retraced++];
+        game.markVisited(current);
+        game.result.incPathCost();
+    }
+    return retraced < path.size();
+}
+template<class OpenList>
+typename GameSearch<OpenList>::Status GameSearch<OpenList>::step(long long max_expansions)
+{
+    for(long long k=0; k<max_expansions && status == RUNNING; k++)
+    {
+        if(algorithm == DEPTH_FIRST_SEARCH)
+            expandDepthFirst();
+        else if(algorithm == BREADTH_FIRST_SEARCH)
+            expandBreadthFirst();
+        else if(algorithm == A_STAR_SEARCH)
+            expandAStar();
+        else if(algorithm == GREEDY_BEST_FIRST_SEARCH)
+            expandOrdered(greedy_list, true);
+        else
+            expandOrdered(open_list, false);
+    }
+    return status;
+}
+
+
+// PortfolioSolver Method definations --> 
+PortfolioSolver::PortfolioSolver(Game &game, const vector<SearchAlgorithm> &algorithms) : game(game)
+{
+    winner = -1;
+    max_cost_ratio = 1.0f;
+    cancel_losers = true;
+    races = 0;
+    for(int k=0; k<algorithms.size(); k++)
+    {
+        Racer racer;
+        racer.algorithm = algorithms[k];
+        racer.context = new Game(game.size, game.board.getLayout());
+        racer.context->setVisualize(false);
+        racer.context->getPathCache().setBudget(0);
+        racer.synced_version = UINT64_MAX;
+        racer.ms = 0;
+        racer.expansions = 0;
+        racer.cost = INFINITY;
+        racer.finished = racer.found = false;
+        racer.wins = racer.leads = 0;
+        racer.won_ms = racer.lead_ms = 0;
+        racers.push_back(racer);
+    }
+}
+PortfolioSolver::~PortfolioSolver()
+{
+    for(int k=0; k<racers.size(); k++)
+    {
+        racers[k].context->clean();
+        delete racers[k].context;
+    }
+}
+Bounds PortfolioSolver::getExploredBounds() const
+{
+    // the cancelled racers' cells are not part of the answer 
+    int index = winner.load();
+    return index >= 0 ? racers[index].context->exploredBounds() : Bounds();
+}
+float PortfolioSolver::getCostRatio(SearchAlgorithm algorithm)
+{
+    if(algorithm == A_STAR_SEARCH || algorithm == BEST_FIRST_SEARCH)
+        return 1.0f;
+    if(algorithm == BREADTH_FIRST_SEARCH)
+        return sqrtf(2.0f);
+    return INFINITY;
+}
+const vector<PortfolioSolver::Racer>& PortfolioSolver::getRacers() const
+{
+    return racers;
+}
+int PortfolioSolver::getWinner() const
+{
+    return winner.load();
+}
+bool PortfolioSolver::qualifies(const Racer &racer) const
+{
+    // a finished search without a path proved there is none, whatever its ratio 
+    return racer.finished && (!racer.found || getCostRatio(racer.algorithm) <= max_cost_ratio);
+}
+void PortfolioSolver::race(int index, chrono::steady_clock::time_point begin, const SearchControl *control)
+{
+    TRACE_SCOPE("PortfolioSolver::race");
+    Racer &racer = racers[index];
+    GameSearch<> search(*racer.context, racer.algorithm);
+    while(search.step(STEP) == GameSearch<>::RUNNING)
+        if((cancel_losers && winner.load() >= 0) || (control != NULL && control->isCancelled()))
+            break;
+
+    racer.ms = chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count();
+    racer.expansions = search.getExpansions();
+    racer.finished = search.getStatus() != GameSearch<>::RUNNING;
+    racer.found = search.getStatus() == GameSearch<>::FOUND;
+    racer.cost = racer.found ? racer.context->getCompactPath().getLength() : INFINITY;
+    int none = -1;
+    if(qualifies(racer))
+        winner.compare_exchange_strong(none, index);
+}
+string PortfolioSolver::report() const
+{
+    // the last race: who won, and how far the others had got 
+    ostringstream out;
+    int index = winner.load();
+    out<<"Portfolio (ratio "<<max_cost_ratio<<"): ";
+    if(index < 0)
+        out<<"no winner";
+    else
+        out<<Game::getAlgorithmName(racers[index].algorithm)<<" won in "<<racers[index].ms<<" ms";
+    for(int k=0; k<racers.size(); k++)
+    {
+        if(k == index)
+            continue;
+        const Racer &racer = racers[k];
+        out<<"; "<<Game::getAlgorithmName(racer.algorithm);
+        if(!racer.finished)
+            out<<" cancelled after "<<racer.expansions<<" expansions";
+        else if(racer.found)
+            out<<" "<<racer.ms<<" ms, cost "<<racer.cost<<(qualifies(racer) ? "" : " (ratio not met)");
+        else
+            out<<" "<<racer.ms<<" ms, no path";
+    }
+    return out.str();
+}
+void PortfolioSolver::setCancelLosers(bool cancel_losers)
+{
+    this->cancel_losers = cancel_losers;
+}
+vector<Position> PortfolioSolver::solve(float max_cost_ratio, const SearchControl *control)
+{
+    TRACE_SCOPE("PortfolioSolver::solve");
+    this->max_cost_ratio = max_cost_ratio;
+    winner = -1;
+    for(int k=0; k<racers.size(); k++)
+        sync(racers[k]);
+
+    chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+    vector<thread> threads;
+    for(int k=0; k<racers.size(); k++)
+        threads.push_back(thread(&PortfolioSolver::race, this, k, begin, control));
+    for(int k=0; k<threads.size(); k++)
+        threads[k].join();
+
+    int index = winner.load();
+    if(index < 0)
+        return vector<Position>();
+
+    // the lead is only known when a qualifying runner-up was allowed to finish 
+    races++;
+    Racer &won = racers[index];
+    won.wins++;
+    won.won_ms += won.ms;
+    double runner_up = INFINITY;
+    for(int k=0; k<racers.size(); k++)
+        if(k != index && qualifies(racers[k]))
+            runner_up = min(runner_up, racers[k].ms);
+    if(runner_up < INFINITY)
+    {
+        won.leads++;
+        won.lead_ms += runner_up - won.ms;
+    }
+    return won.context->getPath();
+}
+string PortfolioSolver::summary() const
+{
+    // wins over every race so far, the input for picking a default per map 
+    ostringstream out;
+    out<<races<<" races";
+    for(int k=0; k<racers.size(); k++)
+    {
+        const Racer &racer = racers[k];
+        out<<", "<<Game::getAlgorithmName(racer.algorithm)<<" "<<racer.wins<<" wins";
+        if(racer.wins > 0)
+            out<<" (mean "<<racer.won_ms/racer.wins<<" ms";
+        if(racer.leads > 0)
+            out<<", lead "<<racer.lead_ms/racer.leads<<" ms";
+        if(racer.wins > 0)
+            out<<")";
+    }
+    return out.str();
+}
+void PortfolioSolver::sync(Racer &racer)
+{
+    // walls only when the board changed since the last race, endpoints and buffers every time 
+    Game &context = *racer.context;
+    context.diagonalMovesAllowed = game.diagonalMovesAllowed;
+    context.setEndpoints(game.start.getPosition(), game.end.getPosition());
+    if(racer.synced_version != game.board_version)
+    {
+        for(int r=0; r<game.size; r++)
+            for(int c=0; c<game.size; c++)
+                context.setWall(Position(r, c), game.wallAt(r, c));
+        racer.synced_version = game.board_version;
+    }
+    context.result.reset();
+}
+
+
+// Board Method definations --> 
+Board::Board()
+{
+    cells = NULL;
+    size = tiles_per_row = 0;
+    layout = ROW_MAJOR;
+}
+Board::Board(int size, Layout layout)
+{
+    this->size = size;
+    this->layout = layout;
+    tiles_per_row = layout == TILED ? (size + 7) / 8 : layout == MORTON ? (size + 63) / 64 : 0;
+    cells = new Node[getCellCount()];
+}
+Node* Board::begin() const
+{
+    // the block in storage order, padding included 
+    return cells;
+}
+Node* Board::end() const
+{
+    return cells + getCellCount();
+}
+size_t Board::getCellCount() const
+{
+    if(layout == TILED)
+        return (size_t)tiles_per_row*tiles_per_row*64;
+    if(layout == MORTON)
+        return (size_t)tiles_per_row*tiles_per_row*4096;
+    return (size_t)size*size;
+}
+Board::Layout Board::getLayout() const
+{
+    return layout;
+}
+string Board::getName(Layout layout)
+{
+    switch(layout)
+    {
+        case ROW_MAJOR: return "Row-major";
+        case TILED: return "8x8 tiles";
+        case MORTON: return "Morton in 64x64 tiles";
+    }
+    return "Unknown";
+}
+inline size_t Board::index(int row, int col) const
+{
+    // tiles are row-major; inside a tile, rows of 8 or the bits of row and col interleaved 
+    switch(layout)
+    {
+        case TILED:
+            return (((size_t)(row >> 3)*tiles_per_row + (col >> 3)) << 6) | ((row & 7) << 3) | (col & 7);
+        case MORTON:
+            return (((size_t)(row >> 6)*tiles_per_row + (col >> 6)) << 12) | (spread(row & 63) << 1) | spread(col & 63);
+        default:
+            return (size_t)row*size + col;
+    }
+}
+inline Board::Row Board::operator [] (int row) const
+{
+    return Row(*this, row);
+}
+void Board::release()
+{
+    // Boards are handles that share the block, so only its owner lets it go 
+    delete[] cells;
+    cells = NULL;
+}
+inline size_t Board::spread(size_t bits)
+{
+    // puts a zero bit between each of the low 8 bits 
+    bits = (bits | (bits << 4)) & 0x0F0F;
+    bits = (bits | (bits << 2)) & 0x3333;
+    return (bits | (bits << 1)) & 0x5555;
+}
+inline Board::Row::Row(const Board &board, int row) : board(board)
+{
+    this->row = row;
+}
+inline Node& Board::Row::operator [] (int col) const
+{
+    return board.cells[board.index(row, col)];
+}
+
+
+// Node Method definations --> 
+Node::Node()
+{
+    is_walkable = true;
+    visited=false;
+    explored = false;
+    parent = NULL;
+    gCost = 100000;
+    hCost = 100000;
+}
+bool Node::isWalkable() const
+{
+    return is_walkable;
+}
+void Node::setPosition(Position pos)
+{
+    this->pos=pos;
+}
+
+
+
+// NodeHandle Method definations --> 
+NodeHandle::NodeHandle(Node *ptr)
+{
+    node = ptr;
+}
+NodeHandle::NodeHandle(Node &node)
+{
+    this->node = &node;
+}
+float NodeHandle::getGCost() const
+{
+    return node->gCost;
+}
+float NodeHandle::getHCost(const NodeHandle &goal) const
+{
+    return Game::getChessBoardDistance(*this, goal);
+}
+float NodeHandle::getFCost(const NodeHandle &goal) const
+{
+    return getGCost()+getHCost(goal);
+}
+
+Node* NodeHandle::getParent()
+{
+    return node->parent;
+}
+Position NodeHandle::getPosition() const
+{
+    return node->pos;
+}
+void NodeHandle::insertWall()
+{
+    node->is_walkable = false;
+}
+bool NodeHandle::isExplored()
+{
+    return node->explored;
+}
+bool NodeHandle::isVisited() const
+{
+    return node->visited;
+}
+bool NodeHandle::isWalkable() const
+{
+    return node->is_walkable;
+}
+void NodeHandle::markAsExplored(bool val)
+{
+    node->explored = val;
+}
+void NodeHandle::markAsVisited(bool val)
+{
+    node->visited = val;
+}
+void NodeHandle::operator=(Node* node_ptr)
+{
+    node=node_ptr;
+}
+void NodeHandle::operator=(Node &other)
+{
+    node=&other;
+}
+bool NodeHandle::operator==(const NodeHandle &second) const
+{
+    if(node == second.node)
+        return true;
+    return false;
+}
+bool NodeHandle::operator!=(const NodeHandle &second) const
+{
+    if(node != second.node)
+        return true;
+    return false;
+}
+bool NodeHandle::operator<(const NodeHandle &second) const
+{
+    if(getPosition().row < second.getPosition().row)
+        return true;
+    return false;
+}
+bool NodeHandle::pointsTo(const Node &node) const
+{
+    if(this->node == &node)
+        return true;
+    return false;
+}
+void NodeHandle::removeWall()
+{
+    node->is_walkable = true;
+}
+void NodeHandle::setGCost(float cost)
+{
+    node->gCost=cost;
+}
+void NodeHandle::setHCost(float cost)
+{
+    node->hCost = cost;
+}
+void NodeHandle::setNodeHandle(Node &node)
+{
+    this->node = &node;
+}
+void NodeHandle::setParent(NodeHandle new_parent)
+{
+    node->parent =  new_parent.node;
+}
+void NodeHandle::setPosition(Position pos)
+{
+    node->setPosition(pos);
+}
+void NodeHandle::toggle()
+{
+    node->is_walkable = !node->is_walkable;
+}
+
+// Position Method definations -->
+Position::Position(int r, int c)
+{
+    this->row=r;
+    this->col=c;
+}
+bool Position::operator == (const Position &pos)
+{
+    if(row == pos.row && col == pos.col)
+        return true;
+    return false;
+}
+Position Position::operator - (const Position &second_pos) const
+{
+    Position distance;
+    distance.row = second_pos.row-row;
+    distance.col = second_pos.col-col;
+    return distance;
+}
+
+std::ostream& operator<<(std::ostream& os, const Position& pos)
+{
+    os << "(" << pos.row << ", " << pos.col << ")";
+    return os;
+}
+
+Result::Result()
+{
+    reset();
+}
+void Result::reset()
+{
+    algorithm = "None";
+    search_cost = path_cost = 0;
+    status = "None";
+    bound = 0;
+    first_solution_ms = -1;
+    budget_exhausted = false;
+}
+int Result::getPathCost() const
+{
+    return path_cost;
+}
+int Result::getSearchCost() const
+{
+    return search_cost;
+}
+void Result::incSearchCost()
+{
+    search_cost++;
+}
+void Result::addSearchCost(long long count)
+{
+    search_cost += count;
+}
+void Result::incPathCost()
+{
+    path_cost++;
+}
+void Result::display()
+{
+    cout<<"\t===Result==="<<endl;
+    cout<<"Algorithm: "<<algorithm<<endl;
+    cout<<"Status: "<<status<<endl;
+    cout<<"Search nodes = "<<search_cost<<endl;
+    cout<<"Path nodes = "<<path_cost<<endl;
+    if(bound > 0)
+        cout<<"Suboptimality bound = "<<bound<<endl;
+    if(first_solution_ms >= 0)
+        cout<<"First solution after = "<<first_solution_ms<<" ms"<<endl;
+}
+bool Result::isBudgetExhausted() const
+{
+    return budget_exhausted;
+}
+void Result::setFirstSolutionMs(double ms)
+{
+    first_solution_ms = ms;
+}
+void Result::setSuccess()
+{
+    search_cost--;
+    path_cost++;
+    status = "Path Found Successfully";
+}
+void Result::setCached(bool found)
+{
+    if(found)
+        path_cost++;
+    status = found ? "Path Found (cached)" : "Path Not Found! (cached)";
+}
+bool Result::isCancelled() const
+{
+    return status == "Search Cancelled";
+}
+void Result::setCancelled()
+{
+    status = "Search Cancelled";
+}
+void Result::setBound(float bound)
+{
+    this->bound = bound;
+}
+void Result::setBudgetExhausted(bool found)
+{
+    budget_exhausted = true;
+    status = found ? "Budget Exhausted, Best Path So Far" : "Budget Exhausted, No Path Yet";
+}
+void Result::setFailure()
+{
+    status = "Path Not Found!";
+}
+void Result::setAlgorithm(string algo)
+{
+    algorithm = algo;
+}
+
+// Random Method definations -->
+Random::Random(uint64_t seed)
+{
+    state = seed;
+}
+uint64_t Random::next()
+{
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+uint32_t Random::nextInt(uint32_t bound)
+{
+    // multiply-shift range reduction, no modulo in the hot loop 
+    return (uint32_t)(((next() >> 32) * (uint64_t)bound) >> 32);
+}
+float Random::nextFloat()
+{
+    return (next() >> 40) * (1.0f / 16777216.0f);
+}
+uint64_t Random::mix(uint64_t seed, uint64_t stream)
+{
+    // independent stream per row/sector so parallel output does not depend on the thread count 
+    Random random(seed ^ (stream * 0xD1B54A32D192ED03ULL));
+    return random.next();
+}
+
+// MazeGenerator Method definations -->
+MazeGenerator::MazeGenerator(Board board, int size, uint64_t seed)
+{
+    this->board = board;
+    this->size = size;
+    this->seed = seed;
+}
+void MazeGenerator::carveCell(uint32_t cell)
+{
+    int r = cell / mazeCols(), c = cell % mazeCols();
+    board[2*r+1][2*c+1].is_walkable = true;
+}
+void MazeGenerator::carvePassage(uint32_t from, uint32_t to)
+{
+    int cols = mazeCols();
+    int r1 = from / cols, c1 = from % cols;
+    int r2 = to / cols, c2 = to % cols;
+    board[2*r2+1][2*c2+1].is_walkable = true;
+    board[r1+r2+1][c1+c2+1].is_walkable = true;
+}
+void MazeGenerator::carveRect(int row, int col, int height, int width)
+{
+    for(int i=max(0, row); i<min(size, row+height); i++)
+        for(int j=max(0, col); j<min(size, col+width); j++)
+            board[i][j].is_walkable = true;
+}
+void MazeGenerator::cellularAutomata(float density, int iterations)
+{
+    // double buffered byte grids, 1 = wall 
+    vector<uint8_t> curr((size_t)size*size), next((size_t)size*size);
+    parallelFor(0, size, [&](long long lo, long long hi) {
+        for(int i=lo; i<hi; i++)
+        {
+            Random random(Random::mix(seed, i));
+            for(int j=0; j<size; j++)
+            {
+                bool border = (i == 0 || j == 0 || i == size-1 || j == size-1);
+                curr[(size_t)i*size+j] = border || random.nextFloat() < density;
+            }
+        }
+    });
+
+    // a cell becomes a wall when 5 or more of its 3x3 block are walls (outside counts as wall) 
+    for(int it=0; it<iterations; it++)
+    {
+        parallelFor(0, size, [&](long long lo, long long hi) {
+            for(int i=lo; i<hi; i++)
+            {
+                for(int j=0; j<size; j++)
+                {
+                    int walls = 0;
+                    for(int di=-1; di<=1; di++)
+                    {
+                        int r = i+di;
+                        if(r < 0 || r >= size)
+                        {
+                            walls += 3;
+                            continue;
+                        }
+                        const uint8_t *row = &curr[(size_t)r*size];
+                        for(int dj=-1; dj<=1; dj++)
+                        {
+                            int c = j+dj;
+                            walls += (c < 0 || c >= size) ? 1 : row[c];
+                        }
+                    }
+                    next[(size_t)i*size+j] = walls >= 5;
+                }
+            }
+        });
+        curr.swap(next);
+    }
+
+    parallelFor(0, size, [&](long long lo, long long hi) {
+        for(int i=lo; i<hi; i++)
+            for(int j=0; j<size; j++)
+                board[i][j].is_walkable = !curr[(size_t)i*size+j];
+    });
+}
+void MazeGenerator::fill(bool walkable)
+{
+    parallelFor(0, size, [&](long long lo, long long hi) {
+        for(int i=lo; i<hi; i++)
+            for(int j=0; j<size; j++)
+                board[i][j].is_walkable = walkable;
+    });
+}
+void MazeGenerator::generate(GeneratorType type, float density)
+{
+    switch(type)
+    {
+        case RECURSIVE_BACKTRACKER:
+            recursiveBacktracker();
+            break;
+        case PRIM:
+            randomizedPrim();
+            break;
+        case KRUSKAL:
+            kruskal();
+            break;
+        case CELLULAR_AUTOMATA:
+            cellularAutomata(density);
+            break;
+        case ROOMS_AND_CORRIDORS:
+            roomsAndCorridors();
+            break;
+        case RANDOM_FILL:
+            randomFill(density);
+            break;
+    }
+}
+string MazeGenerator::getName(GeneratorType type)
+{
+    switch(type)
+    {
+        case RECURSIVE_BACKTRACKER: return "Recursive Backtracker";
+        case PRIM: return "Randomized Prim";
+        case KRUSKAL: return "Kruskal";
+        case CELLULAR_AUTOMATA: return "Cellular Automata";
+        case ROOMS_AND_CORRIDORS: return "Rooms and Corridors";
+        case RANDOM_FILL: return "Random Fill";
+    }
+    return "None";
+}
+void MazeGenerator::kruskal()
+{
+    int rows = mazeRows(), cols = mazeCols();
+    if(rows <= 0 || cols <= 0)
+        return;
+    fill(false);
+
+    // every maze cell is open, walls between cells are the edges 
+    parallelFor(0, rows, [&](long long lo, long long hi) {
+        for(int r=lo; r<hi; r++)
+            for(int c=0; c<cols; c++)
+                board[2*r+1][2*c+1].is_walkable = true;
+    });
+
+    // edge = cell*2 + direction (0 right, 1 down); each row writes its own slice 
+    size_t edge_count = (size_t)rows*(cols-1) + (size_t)(rows-1)*cols;
+    vector<uint32_t> edges(edge_count);
+    parallelFor(0, rows, [&](long long lo, long long hi) {
+        for(int r=lo; r<hi; r++)
+        {
+            size_t k = (size_t)r*(cols-1) + (size_t)r*cols;
+            for(int c=0; c<cols; c++)
+            {
+                uint32_t cell = r*cols+c;
+                if(c+1 < cols)
+                    edges[k++] = cell*2;
+                if(r+1 < rows)
+                    edges[k++] = cell*2+1;
+            }
+        }
+    });
+
+    Random random(seed);
+    for(size_t i=edge_count; i>1; i--)
+        swap(edges[i-1], edges[random.nextInt(i)]);
+
+    // union-find with path halving and union by size 
+    vector<uint32_t> parent((size_t)rows*cols), set_size((size_t)rows*cols, 1);
+    for(size_t i=0; i<parent.size(); i++)
+        parent[i] = i;
+    auto findRoot = [&parent](uint32_t x) {
+        while(parent[x] != x)
+        {
+            parent[x] = parent[parent[x]];
+            x = parent[x];
+        }
+        return x;
+    };
+
+    for(size_t i=0; i<edge_count; i++)
+    {
+        uint32_t a = edges[i] >> 1;
+        uint32_t b = (edges[i] & 1) ? a+cols : a+1;
+        uint32_t root_a = findRoot(a), root_b = findRoot(b);
+        if(root_a == root_b)
+            continue;
+        if(set_size[root_a] < set_size[root_b])
+            swap(root_a, root_b);
+        parent[root_b] = root_a;
+        set_size[root_a] += set_size[root_b];
+        carvePassage(a, b);
+    }
+}
+int MazeGenerator::mazeCols() const
+{
+    return (size-1)/2;
+}
+int MazeGenerator::mazeRows() const
+{
+    return (size-1)/2;
+}
+void MazeGenerator::randomFill(float density)
+{
+    parallelFor(0, size, [&](long long lo, long long hi) {
+        for(int i=lo; i<hi; i++)
+        {
+            Random random(Random::mix(seed, i));
+            for(int j=0; j<size; j++)
+                board[i][j].is_walkable = random.nextFloat() >= density;
+        }
+    });
+}
+void MazeGenerator::randomizedPrim()
+{
+    int rows = mazeRows(), cols = mazeCols();
+    if(rows <= 0 || cols <= 0)
+        return;
+    fill(false);
+
+    enum {OUT, FRONTIER, IN};
+    vector<uint8_t> state((size_t)rows*cols, OUT);
+    vector<uint32_t> frontier;
+    Random random(seed);
+
+    auto addCell = [&](uint32_t cell) {
+        state[cell] = IN;
+        carveCell(cell);
+        int r = cell / cols, c = cell % cols;
+        uint32_t neighbours[4] = {cell-cols, cell+cols, cell-1, cell+1};
+        bool valid[4] = {r > 0, r+1 < rows, c > 0, c+1 < cols};
+        for(int k=0; k<4; k++)
+        {
+            if(valid[k] && state[neighbours[k]] == OUT)
+            {
+                state[neighbours[k]] = FRONTIER;
+                frontier.push_back(neighbours[k]);
+            }
+        }
+    };
+
+    addCell(random.nextInt(rows*cols));
+    while(!frontier.empty())
+    {
+        // take a random frontier cell (swap-remove) 
+        uint32_t index = random.nextInt(frontier.size());
+        uint32_t cell = frontier[index];
+        frontier[index] = frontier.back();
+        frontier.pop_back();
+
+        // connect it to a random neighbour already in the maze 
+        int r = cell / cols, c = cell % cols;
+        uint32_t options[4];
+        int count = 0;
+        if(r > 0 && state[cell-cols] == IN) options[count++] = cell-cols;
+        if(r+1 < rows && state[cell+cols] == IN) options[count++] = cell+cols;
+        if(c > 0 && state[cell-1] == IN) options[count++] = cell-1;
+        if(c+1 < cols && state[cell+1] == IN) options[count++] = cell+1;
+
+        carvePassage(options[random.nextInt(count)], cell);
+        addCell(cell);
+    }
+}
+void MazeGenerator::recursiveBacktracker()
+{
+    int rows = mazeRows(), cols = mazeCols();
+    if(rows <= 0 || cols <= 0)
+        return;
+    fill(false);
+
+    // explicit stack instead of recursion, large boards would overflow the call stack 
+    vector<uint8_t> visited((size_t)rows*cols, 0);
+    vector<uint32_t> stack;
+    Random random(seed);
+
+    uint32_t first = random.nextInt(rows*cols);
+    visited[first] = 1;
+    carveCell(first);
+    stack.push_back(first);
+
+    while(!stack.empty())
+    {
+        uint32_t cell = stack.back();
+        int r = cell / cols, c = cell % cols;
+
+        uint32_t options[4];
+        int count = 0;
+        if(r > 0 && !visited[cell-cols]) options[count++] = cell-cols;
+        if(r+1 < rows && !visited[cell+cols]) options[count++] = cell+cols;
+        if(c > 0 && !visited[cell-1]) options[count++] = cell-1;
+        if(c+1 < cols && !visited[cell+1]) options[count++] = cell+1;
+
+        if(count == 0)
+        {
+            stack.pop_back();
+            continue;
+        }
+
+        uint32_t next = options[random.nextInt(count)];
+        visited[next] = 1;
+        carvePassage(cell, next);
+        stack.push_back(next);
+    }
+}
+void MazeGenerator::roomsAndCorridors()
+{
+    const int SECTOR = 12;
+    fill(false);
+
+    // one room per sector; rooms only touch their own sector so sector rows run in parallel 
+    int sectors = max(1, (size-2) / SECTOR);
+    int sector_size = max(3, (size-2) / sectors);
+    vector<Position> centers((size_t)sectors*sectors);
+
+    parallelFor(0, sectors, [&](long long lo, long long hi) {
+        for(int si=lo; si<hi; si++)
+        {
+            for(int sj=0; sj<sectors; sj++)
+            {
+                Random random(Random::mix(seed, (uint64_t)si*sectors+sj));
+                int max_dim = max(1, sector_size-2);
+                int height = max(1, max_dim/2) + random.nextInt(max_dim - max(1, max_dim/2) + 1);
+                int width = max(1, max_dim/2) + random.nextInt(max_dim - max(1, max_dim/2) + 1);
+                int row = 1 + si*sector_size + 1 + random.nextInt(sector_size-1-height > 0 ? sector_size-1-height : 1);
+                int col = 1 + sj*sector_size + 1 + random.nextInt(sector_size-1-width > 0 ? sector_size-1-width : 1);
+                height = min(height, size-1-row);
+                width = min(width, size-1-col);
+                carveRect(row, col, height, width);
+                centers[(size_t)si*sectors+sj] = Position(row + max(0, height-1)/2, col + max(0, width-1)/2);
+            }
+        }
+    });
+
+    // L shaped corridor: horizontal at a's row, then vertical at b's column 
+    auto connect = [this](Position a, Position b) {
+        carveRect(a.row, min(a.col, b.col), 1, abs(a.col-b.col)+1);
+        carveRect(min(a.row, b.row), b.col, abs(a.row-b.row)+1, 1);
+    };
+
+    // rooms in a sector row are all linked, stays inside the row band 
+    parallelFor(0, sectors, [&](long long lo, long long hi) {
+        for(int si=lo; si<hi; si++)
+            for(int sj=0; sj+1<sectors; sj++)
+                connect(centers[(size_t)si*sectors+sj], centers[(size_t)si*sectors+sj+1]);
+    });
+
+    // link consecutive sector rows: one guaranteed link plus a few random loops 
+    for(int si=0; si+1<sectors; si++)
+    {
+        Random random(Random::mix(seed ^ 0x5EC7, si));
+        int forced = random.nextInt(sectors);
+        for(int sj=0; sj<sectors; sj++)
+            if(sj == forced || random.nextFloat() < 0.25f)
+                connect(centers[(size_t)si*sectors+sj], centers[(size_t)(si+1)*sectors+sj]);
+    }
+}
+
+
+// SpaceTimeTable Method definations -->
+const uint64_t SpaceTimeTable::EMPTY;
+
+SpaceTimeTable::SpaceTimeTable(int capacity_bits)
+{
+    keys.assign((size_t)1 << capacity_bits, EMPTY);
+    values.assign(keys.size(), -1);
+    mask = keys.size()-1;
+    shift = 64 - capacity_bits;
+}
+void SpaceTimeTable::clear()
+{
+    for(size_t i=0; i<used.size(); i++)
+        keys[used[i]] = EMPTY;
+    used.clear();
+}
+size_t SpaceTimeTable::findSlot(uint64_t key) const
+{
+    // fibonacci hashing and linear probing 
+    size_t slot = (key * 0x9E3779B97F4A7C15ULL) >> shift;
+    while(keys[slot] != EMPTY && keys[slot] != key)
+        slot = (slot+1) & mask;
+    return slot;
+}
+int SpaceTimeTable::get(uint32_t cell, uint32_t time) const
+{
+    size_t slot = findSlot(((uint64_t)time << 32) | cell);
+    return keys[slot] == EMPTY ? -1 : values[slot];
+}
+void SpaceTimeTable::grow()
+{
+    vector<uint64_t> old_keys;
+    vector<int> old_values;
+    old_keys.swap(keys);
+    old_values.swap(values);
+
+    keys.assign(old_keys.size()*2, EMPTY);
+    values.assign(keys.size(), -1);
+    mask = keys.size()-1;
+    shift--;
+    used.clear();
+
+    for(size_t i=0; i<old_keys.size(); i++)
+    {
+        if(old_keys[i] == EMPTY)
+            continue;
+        size_t slot = findSlot(old_keys[i]);
+        keys[slot] = old_keys[i];
+        values[slot] = old_values[i];
+        used.push_back(slot);
+    }
+}
+void SpaceTimeTable::put(uint32_t cell, uint32_t time, int value)
+{
+    // keep the load factor under one half 
+    if(2*(used.size()+1) > keys.size())
+        grow();
+
+    uint64_t key = ((uint64_t)time << 32) | cell;
+    size_t slot = findSlot(key);
+    if(keys[slot] == EMPTY)
+    {
+        keys[slot] = key;
+        used.push_back(slot);
+    }
+    values[slot] = value;
+}
+size_t SpaceTimeTable::size() const
+{
+    return used.size();
+}
+
+// Agent Method definations -->
+Agent::Agent(Position start, Position goal)
+{
+    this->start = start;
+    this->goal = goal;
+}
+
+// MultiAgentStats Method definations -->
+MultiAgentStats::MultiAgentStats()
+{
+    agents = reached = makespan = 0;
+    sum_of_costs = reservation_blocks = conflicts_avoided = residual_conflicts = 0;
+    plan_ms = 0;
+}
+double MultiAgentStats::agentsPerSecond() const
+{
+    return plan_ms > 0 ? agents * 1000.0 / plan_ms : 0;
+}
+void MultiAgentStats::display() const
+{
+    cout<<"\t===Multi Agent Result==="<<endl;
+    cout<<"Agents at goal = "<<reached<<" / "<<agents<<endl;
+    cout<<"Makespan = "<<makespan<<", Sum of costs = "<<sum_of_costs<<endl;
+    cout<<"Planning time = "<<plan_ms<<" ms ("<<agentsPerSecond()<<" agents/s)"<<endl;
+    cout<<"Conflicts avoided = "<<conflicts_avoided<<", Reservation blocks = "<<reservation_blocks<<endl;
+    cout<<"Residual conflicts = "<<residual_conflicts<<endl;
+}
+
+// MultiAgentPlanner Method definations -->
+const uint32_t MultiAgentPlanner::UNREACHABLE;
+
+MultiAgentPlanner::MultiAgentPlanner(const Game &game, bool diagonal, int window) : game(game)
+{
+    this->size = game.getSize();
+    this->diagonal = diagonal;
+    this->window = max(2, window);
+    reservation_blocks = 0;
+}
+long long MultiAgentPlanner::countConflicts(const vector<vector<uint32_t> > &paths) const
+{
+    // vertex conflicts (same cell, same step) and swap conflicts (two agents trading cells) 
+    SpaceTimeTable occupancy(12);
+    size_t horizon = 0;
+    for(int a=0; a<paths.size(); a++)
+        horizon = max(horizon, paths[a].size());
+
+    long long conflicts = 0;
+    for(size_t t=0; t<horizon; t++)
+    {
+        occupancy.clear();
+        for(int a=0; a<paths.size(); a++)
+        {
+            uint32_t cell = paths[a][min(t, paths[a].size()-1)];
+            if(occupancy.get(cell, 0) >= 0)
+                conflicts++;
+            else
+                occupancy.put(cell, 0, a);
+        }
+        if(t == 0)
+            continue;
+        for(int a=0; a<paths.size(); a++)
+        {
+            uint32_t from = paths[a][min(t-1, paths[a].size()-1)];
+            uint32_t to = paths[a][min(t, paths[a].size()-1)];
+            if(from == to)
+                continue;
+            int other = occupancy.get(from, 0);
+            if(other > a && paths[other][min(t-1, paths[other].size()-1)] == to)
+                conflicts++;
+        }
+    }
+    return conflicts;
+}
+const vector<uint32_t>& MultiAgentPlanner::distancesTo(uint32_t goal)
+{
+    // true distance ignoring other agents (reverse resumable search done eagerly as one BFS) 
+    unordered_map<uint32_t, vector<uint32_t> >::iterator it = distance_maps.find(goal);
+    if(it != distance_maps.end())
+        return it->second;
+
+    vector<uint32_t> &distance = distance_maps[goal];
+    distance.assign((size_t)size*size, UNREACHABLE);
+    vector<uint32_t> que;
+    que.push_back(goal);
+    distance[goal] = 0;
+
+    uint32_t next[9];
+    for(size_t head=0; head<que.size(); head++)
+    {
+        uint32_t cell = que[head];
+        int count = successors(cell, next);
+        for(int k=0; k<count; k++)
+        {
+            if(distance[next[k]] != UNREACHABLE)
+                continue;
+            distance[next[k]] = distance[cell]+1;
+            que.push_back(next[k]);
+        }
+    }
+    return distance;
+}
+MultiAgentStats MultiAgentPlanner::plan(vector<Agent> &agents, int max_time)
+{
+    auto begin = chrono::steady_clock::now();
+    MultiAgentStats stats;
+    stats.agents = agents.size();
+    reservation_blocks = 0;
+    if(max_time < 0)
+        max_time = 8*size;
+
+    int n = agents.size();
+    vector<uint32_t> position(n), goal(n);
+    vector<vector<uint32_t> > paths(n), independent(n);
+    for(int a=0; a<n; a++)
+    {
+        position[a] = (uint32_t)agents[a].start.row*size + agents[a].start.col;
+        goal[a] = (uint32_t)agents[a].goal.row*size + agents[a].goal.col;
+        paths[a].push_back(position[a]);
+    }
+
+    vector<vector<uint32_t> > windows(n);
+    int t = 0;
+    for(int round=0; t < max_time; round++)
+    {
+        bool all_at_goal = true;
+        for(int a=0; a<n && all_at_goal; a++)
+            all_at_goal = position[a] == goal[a];
+        if(all_at_goal)
+            break;
+
+        // every agent owns its current cell now and for the next step, 
+        // so a stuck agent can always wait without colliding 
+        reservations.clear();
+        for(int a=0; a<n; a++)
+        {
+            reservations.put(position[a], t, a);
+            reservations.put(position[a], t+1, a);
+        }
+
+        // rotate priorities between rounds so nobody is always planned last 
+        bool failed = false;
+        for(int k=0; k<n; k++)
+        {
+            int a = (k + round) % n;
+            if(!planWindow(a, position[a], goal[a], t, windows[a]))
+            {
+                windows[a].assign(window+1, position[a]);
+                failed = true;
+                continue;
+            }
+            for(int step=1; step<=window; step++)
+                reservations.put(windows[a][step], t+step, a);
+        }
+
+        // only the first step is conflict free for everybody when some agent failed 
+        int steps = failed ? 1 : window/2;
+        for(int a=0; a<n; a++)
+        {
+            paths[a].insert(paths[a].end(), windows[a].begin()+1, windows[a].begin()+1+steps);
+            position[a] = windows[a][steps];
+        }
+        t += steps;
+    }
+
+    // cost of an agent is the step at which it reached its goal for the last time 
+    for(int a=0; a<n; a++)
+    {
+        int arrival = paths[a].size()-1;
+        while(arrival > 0 && paths[a][arrival-1] == goal[a])
+            arrival--;
+        if(paths[a].back() == goal[a])
+        {
+            stats.reached++;
+            paths[a].resize(arrival+1);
+        }
+        stats.sum_of_costs += arrival;
+        stats.makespan = max(stats.makespan, arrival);
+
+        agents[a].path.clear();
+        for(int k=0; k<paths[a].size(); k++)
+            agents[a].path.push_back(Position(paths[a][k] / size, paths[a][k] % size));
+    }
+    stats.plan_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count();
+    stats.reservation_blocks = reservation_blocks;
+    stats.residual_conflicts = countConflicts(paths);
+
+    // what planning every agent on its own would have cost in conflicts 
+    for(int a=0; a<n; a++)
+    {
+        const vector<uint32_t> &distance = distancesTo(goal[a]);
+        uint32_t cell = (uint32_t)agents[a].start.row*size + agents[a].start.col, next[9];
+        independent[a].push_back(cell);
+        while(distance[cell] != 0 && distance[cell] != UNREACHABLE)
+        {
+            int count = successors(cell, next);
+            for(int k=0; k<count; k++)
+                if(distance[next[k]] < distance[cell])
+                {
+                    cell = next[k];
+                    break;
+                }
+            independent[a].push_back(cell);
+        }
+    }
+    stats.conflicts_avoided = countConflicts(independent);
+    return stats;
+}
+bool MultiAgentPlanner::planWindow(int agent, uint32_t from, uint32_t goal, int t0, vector<uint32_t> &window_path)
+{
+    struct SearchNode
+    {
+        uint32_t cell;
+        int time, g, parent;
+    };
+    const vector<uint32_t> &distance = distancesTo(goal);
+    auto heuristic = [&](uint32_t cell) {
+        return distance[cell] == UNREACHABLE ? 4*size : (int)distance[cell];
+    };
+
+    vector<SearchNode> nodes;
+    // (f, -g, node index): ties go to the deeper node 
+    priority_queue<pair<pair<int, int>, int>, vector<pair<pair<int, int>, int> >, greater<pair<pair<int, int>, int> > > openList;
+    closed.clear();
+
+    nodes.push_back({from, 0, 0, -1});
+    closed.put(from, 0, 0);
+    openList.push(make_pair(make_pair(heuristic(from), 0), 0));
+
+    uint32_t next[9];
+    while(!openList.empty())
+    {
+        int index = openList.top().second;
+        openList.pop();
+        SearchNode curr = nodes[index];
+        if(closed.get(curr.cell, curr.time) != index)
+            continue;       // a cheaper copy of this state was pushed later 
+
+        // the window is complete, the remaining cost is covered by the true distance heuristic 
+        if(curr.time == window)
+        {
+            window_path.assign(window+1, from);
+            for(int k=index; k>=0; k=nodes[k].parent)
+                window_path[nodes[k].time] = nodes[k].cell;
+            return true;
+        }
+
+        int count = successors(curr.cell, next);
+        next[count++] = curr.cell;      // waiting is a move too 
+        for(int k=0; k<count; k++)
+        {
+            uint32_t cell = next[k];
+            int time = t0 + curr.time + 1;
+
+            int owner = reservations.get(cell, time);
+            bool vertex_conflict = owner >= 0 && owner != agent;
+            int swapper = cell != curr.cell ? reservations.get(cell, time-1) : -1;
+            bool swap_conflict = swapper >= 0 && swapper != agent && reservations.get(curr.cell, time) == swapper;
+            if(vertex_conflict || swap_conflict)
+            {
+                reservation_blocks++;
+                continue;
+            }
+
+            // resting on the goal is free 
+            int g = curr.g + ((cell == goal && curr.cell == goal) ? 0 : 1);
+            int seen = closed.get(cell, curr.time+1);
+            if(seen >= 0 && nodes[seen].g <= g)
+                continue;
+
+            nodes.push_back({cell, curr.time+1, g, index});
+            closed.put(cell, curr.time+1, nodes.size()-1);
+            openList.push(make_pair(make_pair(g + heuristic(cell), -g), (int)nodes.size()-1));
+        }
+    }
+    return false;
+}
+int MultiAgentPlanner::successors(uint32_t cell, uint32_t out[9]) const
+{
+    int row = cell / size, col = cell % size;
+    int count = 0;
+    for(int dx=-1; dx<=1; dx++)
+    {
+        for(int dy=-1; dy<=1; dy++)
+        {
+            if((dx == 0 && dy == 0) || (!diagonal && dx != 0 && dy != 0))
+                continue;
+            if(!game.wallAt(row+dx, col+dy))
+                out[count++] = (uint32_t)(row+dx)*size + col+dy;
+        }
+    }
+    return count;
+}
+
+
+// WalkableBitset Method definations -->
+WalkableBitset::WalkableBitset(const Game &game)
+{
+    size = game.getSize();
+    words_per_row = (size + 63) / 64;
+    bits.assign((size_t)size*words_per_row, 0);
+
+    parallelFor(0, size, [&](long long lo, long long hi) {
+        for(int i=lo; i<hi; i++)
+        {
+            uint64_t *row = &bits[(size_t)i*words_per_row];
+            for(int j=0; j<size; j++)
+                if(!game.wallAt(i, j))
+                    row[j >> 6] |= 1ULL << (j & 63);
+        }
+    });
+}
+WalkableBitset::WalkableBitset(int size, bool walkable)
+{
+    this->size = size;
+    words_per_row = (size + 63) / 64;
+    bits.assign((size_t)size*words_per_row, 0);
+    if(!walkable)
+        return;
+
+    // every word full, less the padding past the last column 
+    uint64_t last_mask = size % 64 == 0 ? ~0ULL : (1ULL << (size % 64)) - 1;
+    for(int i=0; i<size; i++)
+    {
+        uint64_t *row = &bits[(size_t)i*words_per_row];
+        fill(row, row + words_per_row, ~0ULL);
+        row[words_per_row - 1] = last_mask;
+    }
+}
+WalkableBitset::WalkableBitset(const BoardSnapshot &snapshot)
+{
+    // a tile row is one word of a bitset row, padding included 
+    size = snapshot.getSize();
+    words_per_row = (size + 63) / 64;
+    bits.assign((size_t)size*words_per_row, 0);
+    if(snapshot.version == NULL)
+        return;
+
+    const BoardSnapshot::Version &version = *snapshot.version;
+    for(int i=0; i<size; i++)
+        for(int w=0; w<words_per_row; w++)
+            bits[(size_t)i*words_per_row + w] = version.getTile(i, w*BoardSnapshot::TILE).rows[i % BoardSnapshot::TILE];
+}
+long long WalkableBitset::countWalkable() const
+{
+    long long count = 0;
+    for(size_t k=0; k<bits.size(); k++)
+        count += __builtin_popcountll(bits[k]);
+    return count;
+}
+template<typename Function>
+void WalkableBitset::forEachNeighbour(int cell, Function fn) const
+{
+    // fn(next, step cost) for each walkable neighbour, in the row-major order of neighbourMask 
+    int row = cell/size, col = cell%size;
+    for(unsigned mask = neighbourMask(row, col); mask != 0; mask &= mask - 1)
+    {
+        int k = __builtin_ctz(mask), window = k + (k >= 4);
+        int dr = window/3 - 1, dc = window%3 - 1;
+        fn(cell + dr*size + dc, (dr != 0 && dc != 0) ? sqrtf(2.0f) : 1.0f);
+    }
+}
+int WalkableBitset::getSize() const
+{
+    return size;
+}
+bool WalkableBitset::isSpanWalkable(int row, int col_lo, int col_hi) const
+{
+    // tests up to 64 cells per word 
+    if(row < 0 || row >= size || col_lo < 0 || col_hi >= size)
+        return false;
+
+    const uint64_t *words = &bits[(size_t)row*words_per_row];
+    int w_lo = col_lo >> 6, w_hi = col_hi >> 6;
+    uint64_t lo_mask = ~0ULL << (col_lo & 63);
+    uint64_t hi_mask = ~0ULL >> (63 - (col_hi & 63));
+
+    if(w_lo == w_hi)
+        return (words[w_lo] & (lo_mask & hi_mask)) == (lo_mask & hi_mask);
+    if((words[w_lo] & lo_mask) != lo_mask || (words[w_hi] & hi_mask) != hi_mask)
+        return false;
+    for(int w=w_lo+1; w<w_hi; w++)
+        if(words[w] != ~0ULL)
+            return false;
+    return true;
+}
+uint64_t WalkableBitset::checksum() const
+{
+    // FNV-1a over the words, tells a saved index which board it was built for 
+    uint64_t hash = 1469598103934665603ULL ^ (uint64_t)size;
+    for(size_t k=0; k<bits.size(); k++)
+    {
+        hash ^= bits[k];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+bool WalkableBitset::isWalkable(int row, int col) const
+{
+    if(row < 0 || col < 0 || row >= size || col >= size)
+        return false;
+    return (bits[(size_t)row*words_per_row + (col >> 6)] >> (col & 63)) & 1;
+}
+unsigned WalkableBitset::neighbourMask(int row, int col) const
+{
+    // three bits per row of the 3x3 window, one shift when they share a word 
+    unsigned mask = 0;
+    for(int dr=-1; dr<=1; dr++)
+    {
+        int r = row + dr, lo = col - 1;
+        if(r < 0 || r >= size)
+            continue;
+        const uint64_t *words = &bits[(size_t)r*words_per_row];
+        unsigned three;
+        if(lo >= 0 && lo + 2 < size && (lo & 63) <= 61)
+            three = (words[lo >> 6] >> (lo & 63)) & 7;
+        else
+            three = isWalkable(r, lo) | isWalkable(r, col) << 1 | isWalkable(r, col + 1) << 2;
+        mask |= three << (3*(dr + 1));
+    }
+    // drop the centre: bits 0-3 stay, 5-8 move down to 4-7 
+    return (mask & 15) | ((mask >> 1) & 0xF0);
+}
+float WalkableBitset::octile(int a, int b) const
+{
+    int dr = abs(a/size - b/size), dc = abs(a%size - b%size);
+    return sqrtf(2.0f)*min(dr, dc) + abs(dr-dc);
+}
+void WalkableBitset::setWalkable(int row, int col, bool walkable)
+{
+    uint64_t &word = bits[(size_t)row*words_per_row + (col >> 6)];
+    if(walkable)
+        word |= 1ULL << (col & 63);
+    else
+        word &= ~(1ULL << (col & 63));
+}
+float WalkableBitset::stepCost(int a, int b) const
+{
+    return (a/size != b/size && a%size != b%size) ? sqrtf(2.0f) : 1.0f;
+}
+bool WalkableBitset::lineOfSight(Position a, Position b) const
+{
+    // The segment joins cell centres. In doubled coordinates centres are odd and cell 
+    // borders even, so everything stays exact. Every row the segment crosses covers a 
+    // contiguous span of columns, which is tested a word at a time. Only cells whose 
+    // interior is crossed count, so like getNeighbours the segment may slip diagonally 
+    // between two walls that touch at a corner. 
+    if(a.row > b.row)
+        swap(a, b);
+
+    long long y0 = 2*a.row+1, x0 = 2*a.col+1;
+    long long dy = 2*(b.row-a.row), dx = 2*(b.col-a.col);
+    if(dy == 0)
+        return isSpanWalkable(a.row, min(a.col, b.col), max(a.col, b.col));
+
+    auto floorDiv = [](long long num, long long den) {
+        long long q = num / den;
+        return (num % den != 0 && num < 0) ? q-1 : q;
+    };
+
+    for(int row=a.row; row<=b.row; row++)
+    {
+        long long y_lo = max(2LL*row, y0), y_hi = min(2LL*row+2, y0+dy);
+
+        // x = x0 + (y-y0)*dx/dy, kept as a fraction over dy 
+        long long num_lo = x0*dy + (y_lo-y0)*dx;
+        long long num_hi = x0*dy + (y_hi-y0)*dx;
+        if(num_lo > num_hi)
+            swap(num_lo, num_hi);
+
+        // columns whose open interval (2c, 2c+2) meets (x_lo, x_hi) 
+        long long col_lo = floorDiv(num_lo, 2*dy);
+        long long col_hi = num_lo == num_hi ? col_lo : -floorDiv(-num_hi, 2*dy) - 1;
+
+        col_lo = max(col_lo, (long long)min(a.col, b.col));
+        col_hi = min(col_hi, (long long)max(a.col, b.col));
+        if(!isSpanWalkable(row, col_lo, col_hi))
+            return false;
+    }
+    return true;
+}
+
+// BoardSnapshot Method definations --> 
+BoardSnapshot::BoardSnapshot()
+{
+}
+BoardSnapshot::BoardSnapshot(shared_ptr<const Version> version) : version(version)
+{
+}
+int BoardSnapshot::getSize() const
+{
+    return version == NULL ? 0 : version->size;
+}
+uint64_t BoardSnapshot::getVersion() const
+{
+    return version == NULL ? 0 : version->number;
+}
+bool BoardSnapshot::isWalkable(int row, int col) const
+{
+    if(version == NULL || row < 0 || col < 0 || row >= version->size || col >= version->size)
+        return false;
+    return (version->getTile(row, col).rows[row % TILE] >> (col % TILE)) & 1;
+}
+const BoardSnapshot::Tile& BoardSnapshot::Version::getTile(int row, int col) const
+{
+    return *(*tile_rows[row / TILE])[col / TILE];
+}
+
+
+// VersionedBoard Method definations --> 
+VersionedBoard::VersionedBoard(const Game &game)
+{
+    tiles_copied = pointers_copied = edits = 0;
+    reset(game);
+}
+void VersionedBoard::apply(const vector<pair<Position, bool> > &walls)
+{
+    // a batch of edits becomes one version; each tile it touches is copied once, and so is 
+    // each row of tile pointers holding one; every other row is shared with the old version 
+    lock_guard<mutex> guard(writer);
+    shared_ptr<const BoardSnapshot::Version> old = atomic_load(&current);
+    unordered_map<int, shared_ptr<BoardSnapshot::Tile> > copies;
+    for(int k=0; k<walls.size(); k++)
+    {
+        Position pos = walls[k].first;
+        if(pos.row < 0 || pos.col < 0 || pos.row >= old->size || pos.col >= old->size)
+            continue;
+        int t = (pos.row / BoardSnapshot::TILE)*old->tiles_per_row + pos.col / BoardSnapshot::TILE;
+        uint64_t bit = 1ULL << (pos.col % BoardSnapshot::TILE);
+        uint64_t row = copies.count(t) ? copies[t]->rows[pos.row % BoardSnapshot::TILE] : old->getTile(pos.row, pos.col).rows[pos.row % BoardSnapshot::TILE];
+        if(((row & bit) == 0) == walls[k].second)
+            continue;
+
+        if(!copies.count(t))
+        {
+            copies[t] = make_shared<BoardSnapshot::Tile>(old->getTile(pos.row, pos.col));
+            tiles_copied++;
+        }
+        copies[t]->rows[pos.row % BoardSnapshot::TILE] ^= bit;
+        edits++;
+    }
+    if(copies.empty())
+        return;
+
+    shared_ptr<BoardSnapshot::Version> next = make_shared<BoardSnapshot::Version>(*old);
+    next->number = old->number + 1;
+    pointers_copied += next->tile_rows.size();
+    unordered_map<int, shared_ptr<BoardSnapshot::TileRow> > rows;
+    for(auto it = copies.begin(); it != copies.end(); ++it)
+    {
+        int r = it->first / old->tiles_per_row;
+        if(!rows.count(r))
+        {
+            rows[r] = make_shared<BoardSnapshot::TileRow>(*old->tile_rows[r]);
+            next->tile_rows[r] = rows[r];
+            pointers_copied += rows[r]->size();
+        }
+        (*rows[r])[it->first % old->tiles_per_row] = it->second;
+    }
+    publish(next);
+}
+long long VersionedBoard::getEdits() const
+{
+    return edits;
+}
+long long VersionedBoard::getPointersCopied() const
+{
+    return pointers_copied;
+}
+long long VersionedBoard::getTilesCopied() const
+{
+    return tiles_copied;
+}
+uint64_t VersionedBoard::getVersion() const
+{
+    return snapshot().getVersion();
+}
+void VersionedBoard::publish(shared_ptr<const BoardSnapshot::Version> next)
+{
+    // the old version lives on until its last snapshot is dropped 
+    atomic_store(&current, next);
+}
+void VersionedBoard::reset(const Game &game)
+{
+    // every tile new, for edits that touch the whole board 
+    lock_guard<mutex> guard(writer);
+    shared_ptr<const BoardSnapshot::Version> old = atomic_load(&current);
+    shared_ptr<BoardSnapshot::Version> next = make_shared<BoardSnapshot::Version>();
+    next->number = old == NULL ? 0 : old->number + 1;
+    next->size = game.getSize();
+    next->tiles_per_row = (next->size + BoardSnapshot::TILE - 1) / BoardSnapshot::TILE;
+    for(int r=0; r<next->tiles_per_row; r++)
+    {
+        shared_ptr<BoardSnapshot::TileRow> tile_row = make_shared<BoardSnapshot::TileRow>();
+        for(int c=0; c<next->tiles_per_row; c++)
+        {
+            shared_ptr<BoardSnapshot::Tile> tile = make_shared<BoardSnapshot::Tile>();
+            int row0 = r*BoardSnapshot::TILE, col0 = c*BoardSnapshot::TILE;
+            for(int i=0; i<BoardSnapshot::TILE; i++)
+            {
+                tile->rows[i] = 0;
+                for(int j=0; j<BoardSnapshot::TILE && row0+i < next->size && col0+j < next->size; j++)
+                    if(!game.wallAt(row0+i, col0+j))
+                        tile->rows[i] |= 1ULL << j;
+            }
+            tile_row->push_back(tile);
+        }
+        next->tile_rows.push_back(tile_row);
+    }
+    publish(next);
+}
+void VersionedBoard::setWall(Position pos, bool wall)
+{
+    apply(vector<pair<Position, bool> >(1, make_pair(pos, wall)));
+}
+BoardSnapshot VersionedBoard::snapshot() const
+{
+    return BoardSnapshot(atomic_load(&current));
+}
+
+
+// AnyAngleSearch Method definations -->
+AnyAngleSearch::AnyAngleSearch(const WalkableBitset &grid) : grid(grid)
+{
+    size = grid.getSize();
+    expansions = los_checks = 0;
+}
+float AnyAngleSearch::distance(int a, int b, int size)
+{
+    int dr = a/size - b/size, dc = a%size - b%size;
+    return sqrtf((float)(dr*dr + dc*dc));
+}
+Bounds AnyAngleSearch::getExploredBounds() const
+{
+    return explored;
+}
+long long AnyAngleSearch::getExpansions() const
+{
+    return expansions;
+}
+long long AnyAngleSearch::getLineOfSightChecks() const
+{
+    return los_checks;
+}
+bool AnyAngleSearch::lineOfSight(int a, int b)
+{
+    los_checks++;
+    return grid.lineOfSight(Position(a/size, a%size), Position(b/size, b%size));
+}
+float AnyAngleSearch::pathLength(const vector<Position> &path)
+{
+    float length = 0;
+    for(int k=0; k+1<path.size(); k++)
+    {
+        int dr = path[k+1].row-path[k].row, dc = path[k+1].col-path[k].col;
+        length += sqrtf((float)(dr*dr + dc*dc));
+    }
+    return length;
+}
+vector<Position> AnyAngleSearch::smoothPath(const vector<Position> &path)
+{
+    // string pulling: keep the anchor while the next point is still visible from it 
+    vector<Position> waypoints;
+    if(path.empty())
+        return waypoints;
+
+    waypoints.push_back(path[0]);
+    Position anchor = path[0];
+    for(int k=2; k<path.size(); k++)
+    {
+        los_checks++;
+        if(!grid.lineOfSight(anchor, path[k]))
+        {
+            anchor = path[k-1];
+            waypoints.push_back(anchor);
+        }
+    }
+    if(path.size() > 1)
+        waypoints.push_back(path.back());
+    return waypoints;
+}
+vector<Position> AnyAngleSearch::thetaStar(Position start, Position goal, bool lazy)
+{
+    expansions = los_checks = 0;
+    explored = Bounds();
+    vector<Position> waypoints;
+    if(!grid.isWalkable(start.row, start.col) || !grid.isWalkable(goal.row, goal.col))
+        return waypoints;
+
+    size_t cells = (size_t)size*size;
+    vector<float> g(cells, INFINITY);
+    vector<int> parent(cells, -1);
+    vector<uint8_t> closed(cells, 0);
+    priority_queue<pair<float, int>, vector<pair<float, int> >, greater<pair<float, int> > > openList;
+
+    int source = start.row*size + start.col, target = goal.row*size + goal.col;
+    g[source] = 0;
+    parent[source] = source;
+    openList.push(make_pair(distance(source, target, size), source));
+
+    while(!openList.empty())
+    {
+        int curr = openList.top().second;
+        openList.pop();
+        if(closed[curr])
+            continue;
+
+        // Lazy Theta*: the parent was assumed visible, verify it only now 
+        if(lazy && parent[curr] != curr && !lineOfSight(parent[curr], curr))
+        {
+            g[curr] = INFINITY;
+            grid.forEachNeighbour(curr, [&](int next, float) {
+                float cost = g[next] + distance(next, curr, size);
+                if(closed[next] && cost < g[curr])
+                {
+                    g[curr] = cost;
+                    parent[curr] = next;
+                }
+            });
+        }
+
+        closed[curr] = 1;
+        expansions++;
+        explored.include(Position(curr/size, curr%size));
+        if(curr == target)
+            break;
+
+        grid.forEachNeighbour(curr, [&](int next, float) {
+            if(closed[next])
+                return;
+
+            // path 2 through the parent of curr when it sees next, path 1 through curr otherwise 
+            int from = parent[curr];
+            if(!lazy && !lineOfSight(from, next))
+                from = curr;
+            float cost = g[from] + distance(from, next, size);
+            if(cost < g[next])
+            {
+                g[next] = cost;
+                parent[next] = from;
+                openList.push(make_pair(cost + distance(next, target, size), next));
+            }
+        });
+    }
+
+    if(!closed[target])
+        return waypoints;
+    for(int cell=target; ; cell=parent[cell])
+    {
+        waypoints.push_back(Position(cell/size, cell%size));
+        if(cell == source)
+            break;
+    }
+    reverse(waypoints.begin(), waypoints.end());
+    return waypoints;
+}
+vector<Position> AnyAngleSearch::turningPoints(const vector<Position> &path)
+{
+    // drop the cells in the middle of straight runs 
+    vector<Position> points;
+    for(int k=0; k<path.size(); k++)
+    {
+        if(k > 0 && k+1 < path.size())
+        {
+            int dr1 = path[k].row-path[k-1].row, dc1 = path[k].col-path[k-1].col;
+            int dr2 = path[k+1].row-path[k].row, dc2 = path[k+1].col-path[k].col;
+            if(dr1 == dr2 && dc1 == dc2)
+                continue;
+        }
+        points.push_back(path[k]);
+    }
+    return points;
+}
+
+
+// SearchBudget Method definations --> 
+SearchBudget::SearchBudget(long long max_expansions, long long max_micros)
+{
+    this->max_expansions = max_expansions;
+    this->max_micros = max_micros;
+}
+
+
+// NeighbourKernel Method definations --> 
+// neighbour k of the 3x3 window, centre skipped 
+static const int KERNEL_DROW[8] = {-1, -1, -1, 0, 0, 1, 1, 1};
+static const int KERNEL_DCOL[8] = {-1, 0, 1, -1, 1, -1, 0, 1};
+#ifdef MAZE_X86
+__attribute__((target("avx2")))
+unsigned NeighbourKernel::avx2(const float *g, int curr, int size, unsigned walkable, int target, float epsilon, Batch &batch)
+{
+    int row = curr / size, col = curr % size;
+    __m256i drow = _mm256_setr_epi32(-1, -1, -1, 0, 0, 1, 1, 1);
+    __m256i dcol = _mm256_setr_epi32(-1, 0, 1, -1, 1, -1, 0, 1);
+    __m256i rows = _mm256_add_epi32(_mm256_set1_epi32(row), drow);
+    __m256i cols = _mm256_add_epi32(_mm256_set1_epi32(col), dcol);
+    __m256i cells = _mm256_add_epi32(_mm256_mullo_epi32(rows, _mm256_set1_epi32(size)), cols);
+
+    // lanes of walls stay at +inf and are never read, out of bounds cells included 
+    __m256i lane_bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    __m256i lanes = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(walkable), lane_bits), lane_bits);
+    __m256 old_g = _mm256_mask_i32gather_ps(_mm256_set1_ps(INFINITY), g, cells, _mm256_castsi256_ps(lanes), 4);
+
+    float s2 = sqrtf(2.0f);
+    __m256 steps = _mm256_setr_ps(s2, 1.0f, s2, 1.0f, 1.0f, s2, 1.0f, s2);
+    __m256 costs = _mm256_add_ps(_mm256_set1_ps(g[curr]), steps);
+    __m256 better = _mm256_and_ps(_mm256_cmp_ps(costs, old_g, _CMP_LT_OQ), _mm256_castsi256_ps(lanes));
+
+    // octile distance to the target: sqrt(2)*min + (max - min) 
+    __m256i dr = _mm256_abs_epi32(_mm256_sub_epi32(rows, _mm256_set1_epi32(target / size)));
+    __m256i dc = _mm256_abs_epi32(_mm256_sub_epi32(cols, _mm256_set1_epi32(target % size)));
+    __m256i lo = _mm256_min_epi32(dr, dc), hi = _mm256_max_epi32(dr, dc);
+    __m256 h = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(s2), _mm256_cvtepi32_ps(lo)), _mm256_cvtepi32_ps(_mm256_sub_epi32(hi, lo)));
+    __m256 keys = _mm256_add_ps(costs, _mm256_mul_ps(_mm256_set1_ps(epsilon), h));
+
+    _mm256_storeu_si256((__m256i*)batch.cells, cells);
+    _mm256_storeu_ps(batch.costs, costs);
+    _mm256_storeu_ps(batch.keys, keys);
+    return _mm256_movemask_ps(better);
+}
+#else
+unsigned NeighbourKernel::avx2(const float *g, int curr, int size, unsigned walkable, int target, float epsilon, Batch &batch)
+{
+    return scalar(g, curr, size, walkable, target, epsilon, batch);
+}
+#endif
+NeighbourKernel::Kind NeighbourKernel::best()
+{
+    static const Kind kind = isSupported(AVX2) ? AVX2 : isSupported(SSE2) ? SSE2 : SCALAR;
+    return kind;
+}
+NeighbourKernel::Function NeighbourKernel::get(Kind kind)
+{
+    if(kind == AVX2)
+        return avx2;
+    if(kind == SSE2)
+        return sse2;
+    return scalar;
+}
+string NeighbourKernel::getName(Kind kind)
+{
+    switch(kind)
+    {
+        case SCALAR: return "scalar";
+        case SSE2: return "SSE2";
+        case AVX2: return "AVX2";
+    }
+    return "None";
+}
+bool NeighbourKernel::isSupported(Kind kind)
+{
+#ifdef MAZE_X86
+    if(kind == AVX2)
+        return __builtin_cpu_supports("avx2");
+    if(kind == SSE2)
+        return __builtin_cpu_supports("sse2");
+#endif
+    return kind == SCALAR;
+}
+unsigned NeighbourKernel::scalar(const float *g, int curr, int size, unsigned walkable, int target, float epsilon, Batch &batch)
+{
+    int row = curr / size, col = curr % size;
+    unsigned improved = 0;
+    for(int k=0; k<8; k++)
+    {
+        if(!(walkable >> k & 1))
+            continue;
+        int r = row + KERNEL_DROW[k], c = col + KERNEL_DCOL[k];
+        int next = r*size + c;
+        float cost = g[curr] + ((KERNEL_DROW[k] != 0 && KERNEL_DCOL[k] != 0) ? sqrtf(2.0f) : 1.0f);
+        if(cost >= g[next])
+            continue;
+        int dr = abs(r - target/size), dc = abs(c - target%size);
+        batch.cells[k] = next;
+        batch.costs[k] = cost;
+        batch.keys[k] = cost + epsilon*(sqrtf(2.0f)*min(dr, dc) + abs(dr-dc));
+        improved |= 1u << k;
+    }
+    return improved;
+}
+#ifdef MAZE_X86
+__attribute__((target("sse2")))
+unsigned NeighbourKernel::sse2(const float *g, int curr, int size, unsigned walkable, int target, float epsilon, Batch &batch)
+{
+    // two halves of 4 lanes; SSE2 has no gather, no 32 bit multiply and no integer min/max/abs 
+    int row = curr / size, col = curr % size;
+    float s2 = sqrtf(2.0f);
+    unsigned improved = 0;
+    for(int half=0; half<2; half++)
+    {
+        int k0 = 4*half;
+        int cells[4];
+        float old_g[4];
+        for(int k=0; k<4; k++)
+        {
+            cells[k] = curr + KERNEL_DROW[k0+k]*size + KERNEL_DCOL[k0+k];
+            old_g[k] = (walkable >> (k0+k) & 1) ? g[cells[k]] : INFINITY;
+        }
+        __m128 steps = half == 0 ? _mm_setr_ps(s2, 1.0f, s2, 1.0f) : _mm_setr_ps(1.0f, s2, 1.0f, s2);
+        __m128 costs = _mm_add_ps(_mm_set1_ps(g[curr]), steps);
+        unsigned better = _mm_movemask_ps(_mm_cmplt_ps(costs, _mm_loadu_ps(old_g))) & (walkable >> k0) & 15;
+
+        __m128i rows = _mm_add_epi32(_mm_set1_epi32(row - target/size), _mm_loadu_si128((const __m128i*)(KERNEL_DROW + k0)));
+        __m128i cols = _mm_add_epi32(_mm_set1_epi32(col - target%size), _mm_loadu_si128((const __m128i*)(KERNEL_DCOL + k0)));
+        __m128i sign = _mm_srai_epi32(rows, 31);
+        __m128i dr = _mm_sub_epi32(_mm_xor_si128(rows, sign), sign);
+        sign = _mm_srai_epi32(cols, 31);
+        __m128i dc = _mm_sub_epi32(_mm_xor_si128(cols, sign), sign);
+        __m128i dr_smaller = _mm_cmplt_epi32(dr, dc);
+        __m128i lo = _mm_or_si128(_mm_and_si128(dr_smaller, dr), _mm_andnot_si128(dr_smaller, dc));
+        __m128i diff = _mm_sub_epi32(dr, dc);
+        sign = _mm_srai_epi32(diff, 31);
+        diff = _mm_sub_epi32(_mm_xor_si128(diff, sign), sign);
+        __m128 h = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(s2), _mm_cvtepi32_ps(lo)), _mm_cvtepi32_ps(diff));
+        __m128 keys = _mm_add_ps(costs, _mm_mul_ps(_mm_set1_ps(epsilon), h));
+
+        _mm_storeu_si128((__m128i*)(batch.cells + k0), _mm_loadu_si128((const __m128i*)cells));
+        _mm_storeu_ps(batch.costs + k0, costs);
+        _mm_storeu_ps(batch.keys + k0, keys);
+        improved |= better << k0;
+    }
+    return improved;
+}
+#else
+unsigned NeighbourKernel::sse2(const float *g, int curr, int size, unsigned walkable, int target, float epsilon, Batch &batch)
+{
+    return scalar(g, curr, size, walkable, target, epsilon, batch);
+}
+#endif
+
+// AnytimeSearch Method definations --> 
+template<class OpenList>
+AnytimeSearch<OpenList>::AnytimeSearch(const WalkableBitset &grid) : grid(grid)
+{
+    size = grid.getSize();
+    expansions = 0;
+    iterations = 0;
+    bound = path_cost = INFINITY;
+    first_solution_ms = -1;
+    exhausted = false;
+    expand_neighbours = NeighbourKernel::get(NeighbourKernel::best());
+}
+template<class OpenList>
+vector<Position> AnytimeSearch<OpenList>::araStar(Position start, Position goal, float initial_epsilon, float epsilon_step, SearchBudget budget)
+{
+    search(start, goal, initial_epsilon, epsilon_step, budget);
+    return route.toVector();
+}
+template<class OpenList>
+const CompactPath& AnytimeSearch<OpenList>::araStarRoute(Position start, Position goal, float initial_epsilon, float epsilon_step, SearchBudget budget)
+{
+    search(start, goal, initial_epsilon, epsilon_step, budget);
+    return route;
+}
+template<class OpenList>
+float AnytimeSearch<OpenList>::getBound() const
+{
+    return bound;
+}
+template<class OpenList>
+long long AnytimeSearch<OpenList>::getExpansions() const
+{
+    return expansions;
+}
+template<class OpenList>
+Bounds AnytimeSearch<OpenList>::getExploredBounds() const
+{
+    return explored;
+}
+template<class OpenList>
+double AnytimeSearch<OpenList>::getFirstSolutionMs() const
+{
+    return first_solution_ms;
+}
+template<class OpenList>
+int AnytimeSearch<OpenList>::getIterations() const
+{
+    return iterations;
+}
+template<class OpenList>
+float AnytimeSearch<OpenList>::getPathCost() const
+{
+    return path_cost;
+}
+template<class OpenList>
+bool AnytimeSearch<OpenList>::improvePath(int target, float epsilon, OpenList &openList, const SearchBudget &budget, chrono::steady_clock::time_point begin)
+{
+    // returns false when the budget ran out before the iteration finished 
+    while(!openList.empty())
+    {
+        int curr = openList.pop();
+        // older copies of a cell that was improved and expanded already 
+        if(!in_open[curr])
+            continue;
+
+        // done once the goal is at least as cheap as the best key in OPEN 
+        if(g[target] <= g[curr] + epsilon*grid.octile(curr, target))
+        {
+            openList.push(curr, g[curr] + epsilon*grid.octile(curr, target));
+            return true;
+        }
+
+        if(budget.max_expansions >= 0 && expansions >= budget.max_expansions)
+        {
+            openList.push(curr, g[curr] + epsilon*grid.octile(curr, target));
+            return false;
+        }
+        // reading the clock on every expansion costs more than the expansion 
+        if(budget.max_micros >= 0 && (expansions & 63) == 0 &&
+           chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - begin).count() >= budget.max_micros)
+        {
+            openList.push(curr, g[curr] + epsilon*grid.octile(curr, target));
+            return false;
+        }
+
+        in_open[curr] = 0;
+        closed_in[curr] = iterations;
+        expansions++;
+        explored.include(Position(curr/size, curr%size));
+
+        // costs and keys of all 8 neighbours at once, then only the improved ones are pushed 
+        NeighbourKernel::Batch batch;
+        unsigned improved = expand_neighbours(&g[0], curr, size, grid.neighbourMask(curr/size, curr%size), target, epsilon, batch);
+        for(; improved != 0; improved &= improved - 1)
+        {
+            int k = __builtin_ctz(improved), next = batch.cells[k];
+            g[next] = batch.costs[k];
+            parent[next] = curr;
+            // expanded in this iteration already: keep it for the next, lower weight 
+            if(closed_in[next] == iterations)
+            {
+                if(!in_incons[next])
+                {
+                    in_incons[next] = 1;
+                    incons.push_back(next);
+                }
+            }
+            else
+            {
+                in_open[next] = 1;
+                openList.push(next, batch.keys[k]);
+            }
+        }
+    }
+    return true;
+}
+template<class OpenList>
+bool AnytimeSearch<OpenList>::isBudgetExhausted() const
+{
+    return exhausted;
+}
+template<class OpenList>
+float AnytimeSearch<OpenList>::lowerBound(int target, OpenList &openList, vector<int> &frontier)
+{
+    // empties OPEN and INCONS into frontier and returns min(g+h) over them, 0 if both were empty 
+    frontier.clear();
+    while(!openList.empty())
+    {
+        int cell = openList.pop();
+        if(!in_open[cell])
+            continue;
+        in_open[cell] = 0;
+        frontier.push_back(cell);
+    }
+    for(int k=0; k<incons.size(); k++)
+    {
+        in_incons[incons[k]] = 0;
+        frontier.push_back(incons[k]);
+    }
+    incons.clear();
+
+    float lower = INFINITY;
+    for(int k=0; k<frontier.size(); k++)
+        lower = min(lower, g[frontier[k]] + grid.octile(frontier[k], target));
+    return frontier.empty() ? 0 : lower;
+}
+template<class OpenList>
+void AnytimeSearch<OpenList>::setKernel(NeighbourKernel::Kind kind)
+{
+    expand_neighbours = NeighbourKernel::get(NeighbourKernel::isSupported(kind) ? kind : NeighbourKernel::SCALAR);
+}
+template<class OpenList>
+void AnytimeSearch<OpenList>::search(Position start, Position goal, float initial_epsilon, float epsilon_step, SearchBudget budget)
+{
+    chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+    expansions = 0;
+    iterations = 0;
+    bound = path_cost = INFINITY;
+    first_solution_ms = -1;
+    exhausted = false;
+    explored = Bounds();
+    route.clear();
+    if(!grid.isWalkable(start.row, start.col) || !grid.isWalkable(goal.row, goal.col))
+        return;
+
+    size_t cells = (size_t)size*size;
+    g.assign(cells, INFINITY);
+    parent.assign(cells, -1);
+    closed_in.assign(cells, 0);
+    in_open.assign(cells, 0);
+    in_incons.assign(cells, 0);
+    incons.clear();
+
+    int source = start.row*size + start.col, target = goal.row*size + goal.col;
+    float epsilon = max(1.0f, initial_epsilon);
+    OpenList openList;
+    g[source] = 0;
+    parent[source] = source;
+    in_open[source] = 1;
+    openList.push(source, epsilon*grid.octile(source, target));
+
+    vector<int> frontier;
+    while(true)
+    {
+        iterations++;
+        bool complete = improvePath(target, epsilon, openList, budget, begin);
+
+        // the parent chain of the goal is a valid path even when the iteration was cut short 
+        if(g[target] < INFINITY)
+        {
+            if(first_solution_ms < 0)
+                first_solution_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count();
+            route.clear();
+            for(int cell=target; ; cell=parent[cell])
+            {
+                route.append(Position(cell/size, cell%size));
+                if(cell == source)
+                    break;
+            }
+            route.reverse();
+            path_cost = 0;
+            int prev = source;
+            for(CompactPath::Iterator it=route.begin(); it!=route.end(); ++it)
+            {
+                int cell = (*it).row*size + (*it).col;
+                path_cost += grid.octile(prev, cell);
+                prev = cell;
+            }
+        }
+
+        // g(goal) / min(g+h) over OPEN and INCONS bounds the suboptimality at any moment, 
+        // a completed iteration also guarantees epsilon 
+        float lower = lowerBound(target, openList, frontier);
+        bound = (lower > 0) ? g[target]/lower : (g[target] < INFINITY ? 1.0f : INFINITY);
+        if(complete)
+            bound = min(bound, epsilon);
+        bound = max(bound, 1.0f);
+
+        exhausted = !complete;
+        if(!complete || epsilon_step <= 0 || epsilon <= 1.0f || bound <= 1.0f)
+            break;
+
+        // lower the weight and continue from OPEN and INCONS with fresh keys 
+        epsilon = max(1.0f, epsilon - epsilon_step);
+        for(int k=0; k<frontier.size(); k++)
+        {
+            int cell = frontier[k];
+            in_open[cell] = 1;
+            openList.push(cell, g[cell] + epsilon*grid.octile(cell, target));
+        }
+    }
+}
+template<class OpenList>
+vector<Position> AnytimeSearch<OpenList>::weightedAStar(Position start, Position goal, float epsilon, SearchBudget budget)
+{
+    // one ARA* iteration, without the improvement steps 
+    return araStar(start, goal, epsilon, 0, budget);
+}
+template<class OpenList>
+const CompactPath& AnytimeSearch<OpenList>::weightedAStarRoute(Position start, Position goal, float epsilon, SearchBudget budget)
+{
+    return araStarRoute(start, goal, epsilon, 0, budget);
+}
+
+
+// SubgoalGraph Method definations --> 
+template<class OpenList>
+SubgoalGraph<OpenList>::SubgoalGraph(const WalkableBitset &grid, bool two_level, const string &index_file) : grid(grid)
+{
+    size = grid.getSize();
+    this->two_level = two_level;
+    two_level_valid = false;
+    expansions = 0;
+    path_cost = INFINITY;
+    current_stamp = 0;
+
+    // reuse the index saved for this board, otherwise build it and save it for next time 
+    if(!index_file.empty() && load(index_file))
+        return;
+    build();
+    if(!index_file.empty())
+        save(index_file);
+}
+template<class OpenList>
+void SubgoalGraph<OpenList>::addSubgoal(int cell)
+{
+    subgoal_at[cell] = cells.size();
+    cells.push_back(cell);
+    scans.push_back(vector<int>());
+    found_by.push_back(vector<int>());
+}
+template<class OpenList>
+void SubgoalGraph<OpenList>::build()
+{
+    subgoal_at.assign((size_t)size*size, -1);
+    cells.clear();
+    scans.clear();
+    found_by.clear();
+    for(int r=0; r<size; r++)
+        for(int c=0; c<size; c++)
+            if(isSubgoalCell(r, c))
+                addSubgoal(r*size + c);
+    for(int id=0; id<cells.size(); id++)
+        rescan(id);
+
+    two_level_valid = false;
+    if(two_level)
+        buildTwoLevel();
+}
+template<class OpenList>
+void SubgoalGraph<OpenList>::buildTwoLevel()
+{
+    // Contract subgoals one by one into the local level. A subgoal can go if every pair of 
+    // its neighbours either has another path that is no longer (witness) or is h-reachable 
+    // through it, in which case a shortcut edge replaces it. Witness paths may only pass 
+    // global subgoals, so a query needs no local subgoal besides those next to start and 
+    // goal. Subgoals with many neighbours stay global, their witness searches cost more 
+    // than they save. 
+    const float EPS = 1e-3f;
+    const int MAX_DEGREE = 12;
+    int count = cells.size();
+    local.assign(count, 0);
+    shortcuts.assign(count, vector<Edge>());
+    two_level_valid = true;
+
+    vector<pair<int, float> > around;
+    vector<pair<pair<int, int>, float> > needed;
+    vector<float> witness;
+    for(int s=0; s<count; s++)
+    {
+        if(cells[s] < 0)
+            continue;
+
+        // neighbours, cheapest edge to each 
+        around.clear();
+        forEachEdge(s, [&](int to, float cost, int) {
+            for(int k=0; k<around.size(); k++)
+            {
+                if(around[k].first == to)
+                {
+                    around[k].second = min(around[k].second, cost);
+                    return;
+                }
+            }
+            around.push_back(make_pair(to, cost));
+        });
+
+        bool removable = around.size() <= MAX_DEGREE;
+        needed.clear();
+        for(int i=0; i<around.size() && removable; i++)
+        {
+            float farthest = 0;
+            for(int j=i+1; j<around.size(); j++)
+                farthest = max(farthest, around[j].second);
+            witnessSearch(around[i].first, s, around[i].second + farthest + EPS);
+            witness.clear();
+            for(int j=i+1; j<around.size(); j++)
+                witness.push_back(distanceOf(around[j].first));
+
+            for(int j=i+1; j<around.size() && removable; j++)
+            {
+                int u = around[i].first, v = around[j].first;
+                float through = around[i].second + around[j].second;
+                if(witness[j-i-1] <= through + EPS)
+                    continue;
+                if(through <= grid.octile(cells[u], cells[v]) + EPS)
+                    needed.push_back(make_pair(make_pair(u, v), through));
+                else
+                    removable = false;
+            }
+        }
+        if(!removable)
+            continue;
+
+        local[s] = 1;
+        for(int k=0; k<needed.size(); k++)
+        {
+            int u = needed[k].first.first, v = needed[k].first.second;
+            Edge forward = {v, needed[k].second, s}, backward = {u, needed[k].second, s};
+            shortcuts[u].push_back(forward);
+            shortcuts[v].push_back(backward);
+        }
+    }
+}
+template<class OpenList>
+float SubgoalGraph<OpenList>::distanceOf(int node) const
+{
+    return stamp[node] == current_stamp ? dist[node] : INFINITY;
+}
+template<class OpenList>
+vector<Position> SubgoalGraph<OpenList>::findPath(Position start, Position goal)
+{
+    expansions = 0;
+    path_cost = INFINITY;
+    vector<Position> path;
+    if(!grid.isWalkable(start.row, start.col) || !grid.isWalkable(goal.row, goal.col))
+        return path;
+    if(two_level && !two_level_valid)
+        buildTwoLevel();
+
+    int source = start.row*size + start.col, target = goal.row*size + goal.col;
+    if(source == target)
+    {
+        path_cost = 0;
+        path.push_back(start);
+        return path;
+    }
+
+    // link start and goal to the subgoals they reach, from both ends of each path shape 
+    vector<int> from_start, to_goal;
+    bool direct, direct_back;
+    scan(source, DIAGONAL_FIRST | STRAIGHT_FIRST, target, from_start, direct);
+    scan(target, DIAGONAL_FIRST | STRAIGHT_FIRST, source, to_goal, direct_back);
+    if(subgoal_at[source] >= 0)
+        from_start.push_back(subgoal_at[source]);
+    if(subgoal_at[target] >= 0)
+        to_goal.push_back(subgoal_at[target]);
+
+    int count = cells.size(), S = count, G = count+1;
+    int st = nextStamp(count+2);
+    for(int k=0; k<to_goal.size(); k++)
+        linked[to_goal[k]] = st;
+
+    // two-level query: the global subgoals plus the local ones next to start and goal 
+    for(int k=0; k<from_start.size(); k++)
+        region[from_start[k]] = st;
+    for(int k=0; k<to_goal.size(); k++)
+        region[to_goal[k]] = st;
+
+    auto cellOf = [&](int node) { return node == S ? source : (node == G ? target : cells[node]); };
+    OpenList openList;
+    auto relax = [&](int from, int to, float cost, int via) {
+        if(to < count && two_level_valid && local[to] && region[to] != st)
+            return;
+        float d = dist[from] + cost;
+        if(d >= distanceOf(to))
+            return;
+        setDistance(to, d);
+        parent[to] = from;
+        parent_via[to] = via;
+        openList.push(to, d + grid.octile(cellOf(to), target));
+    };
+
+    setDistance(S, 0);
+    parent[S] = -1;
+    openList.push(S, grid.octile(source, target));
+    while(!openList.empty())
+    {
+        int v = openList.pop();
+        if(closed[v] == st)
+            continue;
+        closed[v] = st;
+        expansions++;
+        if(v == G)
+            break;
+
+        if(v == S)
+        {
+            for(int k=0; k<from_start.size(); k++)
+                relax(S, from_start[k], grid.octile(source, cells[from_start[k]]), -1);
+            if(direct || direct_back)
+                relax(S, G, grid.octile(source, target), -1);
+            continue;
+        }
+        forEachEdge(v, [&](int to, float cost, int via) {
+            relax(v, to, cost, via);
+        });
+        if(linked[v] == st)
+            relax(v, G, grid.octile(cells[v], target), -1);
+    }
+    if(closed[G] != st)
+        return path;
+
+    // unwind the subgoals, then refine each edge back to cells 
+    path_cost = dist[G];
+    vector<int> hops;
+    for(int v=G; v!=-1; v=parent[v])
+        hops.push_back(v);
+    reverse(hops.begin(), hops.end());
+    path.push_back(start);
+    for(int k=0; k+1<hops.size(); k++)
+        refine(cellOf(hops[k]), cellOf(hops[k+1]), parent_via[hops[k+1]], path);
+    return path;
+}
+template<class OpenList>
+template<class Visit>
+void SubgoalGraph<OpenList>::forEachEdge(int id, Visit visit) const
+{
+    for(int k=0; k<scans[id].size(); k++)
+        visit(scans[id][k], grid.octile(cells[id], cells[scans[id][k]]), -1);
+    for(int k=0; k<found_by[id].size(); k++)
+        visit(found_by[id][k], grid.octile(cells[id], cells[found_by[id][k]]), -1);
+    if(two_level_valid)
+        for(int k=0; k<shortcuts[id].size(); k++)
+            visit(shortcuts[id][k].to, shortcuts[id][k].cost, shortcuts[id][k].via);
+}
+template<class OpenList>
+long long SubgoalGraph<OpenList>::getEdgeCount() const
+{
+    long long edges = 0;
+    for(int id=0; id<cells.size(); id++)
+        edges += scans[id].size() + (two_level_valid ? shortcuts[id].size() : 0);
+    return edges;
+}
+template<class OpenList>
+long long SubgoalGraph<OpenList>::getExpansions() const
+{
+    return expansions;
+}
+template<class OpenList>
+int SubgoalGraph<OpenList>::getGlobalCount()
+{
+    if(two_level && !two_level_valid)
+        buildTwoLevel();
+    int globals = 0;
+    for(int id=0; id<cells.size(); id++)
+        if(cells[id] >= 0 && !(two_level_valid && local[id]))
+            globals++;
+    return globals;
+}
+template<class OpenList>
+float SubgoalGraph<OpenList>::getPathCost() const
+{
+    return path_cost;
+}
+template<class OpenList>
+int SubgoalGraph<OpenList>::getSubgoalCount() const
+{
+    int count = 0;
+    for(int id=0; id<cells.size(); id++)
+        if(cells[id] >= 0)
+            count++;
+    return count;
+}
+template<class OpenList>
+bool SubgoalGraph<OpenList>::isSubgoalCell(int row, int col) const
+{
+    // a wall beside the cell that ends a run of walls (cutting the corner is allowed) 
+    static const int sides[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+    if(!grid.isWalkable(row, col))
+        return false;
+    for(int k=0; k<4; k++)
+    {
+        int wr = row+sides[k][0], wc = col+sides[k][1];
+        if(wr < 0 || wc < 0 || wr >= size || wc >= size || grid.isWalkable(wr, wc))
+            continue;
+        int pr = sides[k][1], pc = sides[k][0];
+        if(grid.isWalkable(wr+pr, wc+pc) || grid.isWalkable(wr-pr, wc-pc))
+            return true;
+    }
+    return false;
+}
+template<class OpenList>
+bool SubgoalGraph<OpenList>::load(const string &file)
+{
+    // layout: magic, size, board checksum, subgoal cells, scans, two-level flags and shortcuts 
+    ifstream in(file.c_str(), ios::binary);
+    if(!in)
+        return false;
+    auto get = [&](void *data, size_t bytes) { in.read((char*)data, bytes); return (bool)in; };
+
+    char magic[8];
+    int32_t saved_size, count;
+    uint64_t checksum;
+    if(!get(magic, 8) || memcmp(magic, "SUBGOAL1", 8) != 0 || !get(&saved_size, 4) || !get(&checksum, 8) || !get(&count, 4))
+        return false;
+    if(saved_size != size || checksum != grid.checksum() || count < 0 || count > (int64_t)size*size)
+        return false;
+
+    vector<int32_t> saved_cells(count);
+    vector<vector<int> > saved_scans(count);
+    if(count > 0 && !get(&saved_cells[0], 4*(size_t)count))
+        return false;
+    for(int id=0; id<count; id++)
+    {
+        int32_t degree;
+        if(!get(&degree, 4) || degree < 0 || degree > count)
+            return false;
+        vector<int32_t> list(degree);
+        if(degree > 0 && !get(&list[0], 4*(size_t)degree))
+            return false;
+        saved_scans[id].assign(list.begin(), list.end());
+    }
+
+    uint8_t has_two_level;
+    vector<uint8_t> saved_local;
+    vector<vector<Edge> > saved_shortcuts;
+    if(!get(&has_two_level, 1))
+        return false;
+    if(has_two_level)
+    {
+        saved_local.resize(count);
+        saved_shortcuts.resize(count);
+        if(count > 0 && !get(&saved_local[0], count))
+            return false;
+        for(int id=0; id<count; id++)
+        {
+            int32_t degree;
+            if(!get(&degree, 4) || degree < 0)
+                return false;
+            saved_shortcuts[id].resize(degree);
+            for(int k=0; k<degree; k++)
+            {
+                int32_t to, via;
+                float cost;
+                if(!get(&to, 4) || !get(&cost, 4) || !get(&via, 4))
+                    return false;
+                Edge edge = {to, cost, via};
+                saved_shortcuts[id][k] = edge;
+            }
+        }
+    }
+
+    subgoal_at.assign((size_t)size*size, -1);
+    cells.assign(saved_cells.begin(), saved_cells.end());
+    for(int id=0; id<count; id++)
+        subgoal_at[cells[id]] = id;
+    scans.swap(saved_scans);
+    found_by.assign(count, vector<int>());
+    for(int id=0; id<count; id++)
+        for(int k=0; k<scans[id].size(); k++)
+            found_by[scans[id][k]].push_back(id);
+    local.swap(saved_local);
+    shortcuts.swap(saved_shortcuts);
+    two_level_valid = has_two_level;
+    return true;
+}
+template<class OpenList>
+int SubgoalGraph<OpenList>::nextStamp(int nodes)
+{
+    if(stamp.size() < nodes)
+    {
+        dist.resize(nodes);
+        parent.resize(nodes);
+        parent_via.resize(nodes);
+        stamp.resize(nodes, 0);
+        closed.resize(nodes, 0);
+        region.resize(nodes, 0);
+        linked.resize(nodes, 0);
+    }
+    return ++current_stamp;
+}
+template<class OpenList>
+void SubgoalGraph<OpenList>::refine(int a, int b, int via, vector<Position> &path) const
+{
+    // a shortcut stands for the two edges through the subgoal it replaced 
+    if(via >= 0)
+    {
+        refine(a, cells[via], viaOf(subgoal_at[a], via), path);
+        refine(cells[via], b, viaOf(via, subgoal_at[b]), path);
+        return;
+    }
+
+    // a direct edge is diagonal then straight, or straight then diagonal (whichever is free) 
+    int r = a/size, c = a%size, dr = b/size - r, dc = b%size - c;
+    int sr = (dr > 0) - (dr < 0), sc = (dc > 0) - (dc < 0);
+    int diagonal = min(abs(dr), abs(dc)), steps = max(abs(dr), abs(dc));
+    int tr = abs(dr) > abs(dc) ? sr : 0, tc = abs(dr) > abs(dc) ? 0 : sc;
+    auto step = [&](int k, bool diagonal_first) {
+        int straight = steps - diagonal;
+        int d = diagonal_first ? min(k, diagonal) : max(0, k - straight);
+        int t = k - d;
+        return Position(r + d*sr + t*tr, c + d*sc + t*tc);
+    };
+    bool diagonal_first = true;
+    for(int k=1; k<=steps && diagonal_first; k++)
+    {
+        Position p = step(k, true);
+        diagonal_first = grid.isWalkable(p.row, p.col);
+    }
+    for(int k=1; k<=steps; k++)
+        path.push_back(step(k, diagonal_first));
+}
+template<class OpenList>
+void SubgoalGraph<OpenList>::removeSubgoal(int id)
+{
+    auto erase = [](vector<int> &list, int value) {
+        vector<int>::iterator it = find(list.begin(), list.end(), value);
+        if(it != list.end())
+        {
+            *it = list.back();
+            list.pop_back();
+        }
+    };
+    for(int k=0; k<scans[id].size(); k++)
+        erase(found_by[scans[id][k]], id);
+    for(int k=0; k<found_by[id].size(); k++)
+        erase(scans[found_by[id][k]], id);
+    scans[id].clear();
+    found_by[id].clear();
+    subgoal_at[cells[id]] = -1;
+    cells[id] = -1;
+}
+template<class OpenList>
+void SubgoalGraph<OpenList>::rescan(int id)
+{
+    for(int k=0; k<scans[id].size(); k++)
+    {
+        vector<int> &list = found_by[scans[id][k]];
+        vector<int>::iterator it = find(list.begin(), list.end(), id);
+        if(it != list.end())
+        {
+            *it = list.back();
+            list.pop_back();
+        }
+    }
+    scans[id].clear();
+    if(cells[id] < 0)
+        return;
+
+    bool reached;
+    scan(cells[id], DIAGONAL_FIRST, -1, scans[id], reached);
+    for(int k=0; k<scans[id].size(); k++)
+        found_by[scans[id][k]].push_back(id);
+}
+template<class OpenList>
+bool SubgoalGraph<OpenList>::save(const string &file)
+{
+    if(two_level && !two_level_valid)
+        buildTwoLevel();
+
+    // drop the ids edits have freed 
+    vector<int> remap(cells.size(), -1);
+    int32_t count = 0;
+    for(int id=0; id<cells.size(); id++)
+        if(cells[id] >= 0)
+            remap[id] = count++;
+
+    ofstream out(file.c_str(), ios::binary);
+    if(!out)
+        return false;
+    auto put = [&](const void *data, size_t bytes) { out.write((const char*)data, bytes); };
+
+    int32_t saved_size = size;
+    uint64_t checksum = grid.checksum();
+    put("SUBGOAL1", 8);
+    put(&saved_size, 4);
+    put(&checksum, 8);
+    put(&count, 4);
+    for(int id=0; id<cells.size(); id++)
+    {
+        int32_t cell = cells[id];
+        if(cell >= 0)
+            put(&cell, 4);
+    }
+    for(int id=0; id<cells.size(); id++)
+    {
+        if(cells[id] < 0)
+            continue;
+        int32_t degree = scans[id].size();
+        put(&degree, 4);
+        for(int k=0; k<degree; k++)
+        {
+            int32_t to = remap[scans[id][k]];
+            put(&to, 4);
+        }
+    }
+
+    uint8_t has_two_level = two_level_valid;
+    put(&has_two_level, 1);
+    if(has_two_level)
+    {
+        for(int id=0; id<cells.size(); id++)
+            if(cells[id] >= 0)
+                put(&local[id], 1);
+        for(int id=0; id<cells.size(); id++)
+        {
+            if(cells[id] < 0)
+                continue;
+            int32_t degree = shortcuts[id].size();
+            put(&degree, 4);
+            for(int k=0; k<degree; k++)
+            {
+                int32_t to = remap[shortcuts[id][k].to], via = remap[shortcuts[id][k].via];
+                put(&to, 4);
+                put(&shortcuts[id][k].cost, 4);
+                put(&via, 4);
+            }
+        }
+    }
+    return (bool)out;
+}
+template<class OpenList>
+void SubgoalGraph<OpenList>::scan(int cell, int orders, int target, vector<int> &found, bool &reached, bool direct_only) const
+{
+    // collects the first subgoal met along each octile path shape; reached is set when 
+    // target lies on one of them 
+    reached = false;
+    int r0 = cell/size, c0 = cell%size;
+    auto walk = [&](int r, int c, int dr, int dc, int limit) {
+        // returns the step the ray stopped at 
+        int steps = 1;
+        for(; steps<=limit && grid.isWalkable(r, c); r+=dr, c+=dc, steps++)
+        {
+            int next = r*size + c;
+            if(next == target)
+            {
+                reached = true;
+                break;
+            }
+            if(subgoal_at[next] >= 0)
+            {
+                found.push_back(subgoal_at[next]);
+                break;
+            }
+        }
+        return steps;
+    };
+
+    // straight and diagonal rays 
+    for(int dr=-1; dr<=1; dr++)
+        for(int dc=-1; dc<=1; dc++)
+            if(dr != 0 || dc != 0)
+                walk(r0+dr, c0+dc, dr, dc, INT_MAX);
+
+    // two legs: the diagonal and one of its straight components, in the requested orders 
+    for(int order=DIAGONAL_FIRST; order<=STRAIGHT_FIRST; order<<=1)
+    {
+        if(!(orders & order))
+            continue;
+        for(int dr=-1; dr<=1; dr+=2)
+        {
+            for(int dc=-1; dc<=1; dc+=2)
+            {
+                for(int leg=0; leg<2; leg++)
+                {
+                    int sr = (leg == 0) ? dr : 0, sc = (leg == 0) ? 0 : dc;
+                    int fr = (order == DIAGONAL_FIRST) ? dr : sr, fc = (order == DIAGONAL_FIRST) ? dc : sc;
+                    int tr = (order == DIAGONAL_FIRST) ? sr : dr, tc = (order == DIAGONAL_FIRST) ? sc : dc;
+                    // Each second leg stops short of where the previous one stopped: past a 
+                    // subgoal u there, the same cells are reached from u at no extra cost, 
+                    // past a wall they are walls too. Without direct_only every path is found. 
+                    int limit = INT_MAX;
+                    for(int r=r0+fr, c=c0+fc; grid.isWalkable(r, c) && limit > 0; r+=fr, c+=fc)
+                    {
+                        if(r*size + c == target || subgoal_at[r*size + c] >= 0)
+                            break;
+                        int stopped = walk(r+tr, c+tc, tr, tc, limit);
+                        if(direct_only)
+                            limit = stopped - 1;
+                    }
+                }
+            }
+        }
+    }
+}
+template<class OpenList>
+void SubgoalGraph<OpenList>::setDistance(int node, float distance)
+{
+    dist[node] = distance;
+    stamp[node] = current_stamp;
+}
+template<class OpenList>
+void SubgoalGraph<OpenList>::setWall(Position pos, bool wall)
+{
+    // Local repair: only the cells next to pos can change status, and only the subgoals 
+    // whose scans pass one of those cells (found by scanning back from them, before and 
+    // after the edit) need new edges. The two-level layer is rebuilt on the next query. 
+    if(pos.row < 0 || pos.col < 0 || pos.row >= size || pos.col >= size || grid.isWalkable(pos.row, pos.col) != wall)
+        return;
+
+    vector<int> affected;
+    auto collect = [&]() {
+        bool reached;
+        for(int r=max(0, pos.row-1); r<=min(size-1, pos.row+1); r++)
+        {
+            for(int c=max(0, pos.col-1); c<=min(size-1, pos.col+1); c++)
+            {
+                scan(r*size + c, STRAIGHT_FIRST, -1, affected, reached, false);
+                if(subgoal_at[r*size + c] >= 0)
+                    affected.push_back(subgoal_at[r*size + c]);
+            }
+        }
+    };
+
+    collect();
+    grid.setWalkable(pos.row, pos.col, !wall);
+    for(int r=max(0, pos.row-1); r<=min(size-1, pos.row+1); r++)
+    {
+        for(int c=max(0, pos.col-1); c<=min(size-1, pos.col+1); c++)
+        {
+            bool subgoal = isSubgoalCell(r, c);
+            if(subgoal && subgoal_at[r*size + c] < 0)
+                addSubgoal(r*size + c);
+            else if(!subgoal && subgoal_at[r*size + c] >= 0)
+                removeSubgoal(subgoal_at[r*size + c]);
+        }
+    }
+    collect();
+
+    sort(affected.begin(), affected.end());
+    affected.erase(unique(affected.begin(), affected.end()), affected.end());
+    for(int k=0; k<affected.size(); k++)
+        rescan(affected[k]);
+    two_level_valid = false;
+}
+template<class OpenList>
+int SubgoalGraph<OpenList>::viaOf(int a, int b) const
+{
+    // -1 for a direct edge, otherwise the subgoal of the shortcut 
+    if(find(scans[a].begin(), scans[a].end(), b) != scans[a].end() ||
+       find(found_by[a].begin(), found_by[a].end(), b) != found_by[a].end())
+        return -1;
+    for(int k=0; k<shortcuts[a].size(); k++)
+        if(shortcuts[a][k].to == b)
+            return shortcuts[a][k].via;
+    return -1;
+}
+template<class OpenList>
+void SubgoalGraph<OpenList>::witnessSearch(int from, int skip, float limit)
+{
+    // Dijkstra from `from` through global subgoals other than skip (local ones can only end 
+    // a path), up to limit and a few hundred nodes; anything not reached has no witness 
+    int st = nextStamp(cells.size());
+    OpenList openList;
+    setDistance(from, 0);
+    openList.push(from, 0);
+    int settled = 0;
+    while(!openList.empty() && settled < 256)
+    {
+        int v = openList.pop();
+        if(closed[v] == st)
+            continue;
+        closed[v] = st;
+        if(dist[v] > limit)
+            break;
+        settled++;
+        if(v != from && local[v])
+            continue;
+        forEachEdge(v, [&](int to, float cost, int) {
+            if(to == skip || dist[v] + cost >= distanceOf(to))
+                return;
+            setDistance(to, dist[v] + cost);
+            openList.push(to, dist[to]);
+        });
+    }
+}
+
+
+// CompressedPathDatabase Method definations --> 
+const int CompressedPathDatabase::MOVES[8][2] = {{-1, 0}, {-1, 1}, {0, 1}, {1, 1}, {1, 0}, {1, -1}, {0, -1}, {-1, -1}};
+
+CompressedPathDatabase::CompressedPathDatabase(const WalkableBitset &grid, const string &file) : grid(grid)
+{
+    size = grid.getSize();
+    offsets = NULL;
+    runs = NULL;
+    mapping = NULL;
+    mapping_bytes = 0;
+
+    // Hilbert order on the enclosing power of two square, squeezed to ranks 0..cells-1, 
+    // so that nearby targets (which mostly share a first move) are next to each other 
+    int side = 1;
+    while(side < size)
+        side <<= 1;
+    vector<pair<uint64_t, uint32_t> > order;
+    order.reserve((size_t)size*size);
+    for(int r=0; r<size; r++)
+    {
+        for(int c=0; c<size; c++)
+        {
+            uint64_t d = 0;
+            for(int x=c, y=r, s=side/2; s>0; s/=2)
+            {
+                int rx = (x & s) > 0, ry = (y & s) > 0;
+                d += (uint64_t)s*s*((3*rx) ^ ry);
+                if(ry == 0)
+                {
+                    if(rx == 1)
+                    {
+                        x = side-1-x;
+                        y = side-1-y;
+                    }
+                    swap(x, y);
+                }
+            }
+            order.push_back(make_pair(d, (uint32_t)(r*size + c)));
+        }
+    }
+    sort(order.begin(), order.end());
+    rank.resize(order.size());
+    for(size_t k=0; k<order.size(); k++)
+        rank[order[k].second] = k;
+
+    if(!file.empty() && load(file))
+        return;
+    build();
+    if(!file.empty())
+        save(file);
+}
+CompressedPathDatabase::~CompressedPathDatabase()
+{
+    release();
+}
+void CompressedPathDatabase::build()
+{
+    size_t cells = (size_t)size*size;
+    vector<int> by_rank(cells);
+    for(size_t cell=0; cell<cells; cell++)
+        by_rank[rank[cell]] = cell;
+
+    // one Dijkstra per source; workers pull the next source so uneven ones balance out 
+    vector<vector<uint32_t> > per_source(cells);
+    atomic<long long> next_source(0);
+    long long workers = max(1u, thread::hardware_concurrency());
+    parallelFor(0, workers, [&](long long, long long) {
+        vector<float> dist(cells);
+        vector<uint8_t> first(cells), done(cells);
+        BinaryHeapOpenList<int> openList;
+        for(long long source; (source = next_source++) < (long long)cells; )
+        {
+            if(!grid.isWalkable(source/size, source%size))
+                continue;
+            fill(dist.begin(), dist.end(), INFINITY);
+            fill(first.begin(), first.end(), (uint8_t)NO_PATH);
+            fill(done.begin(), done.end(), 0);
+            dist[source] = 0;
+            openList.push(source, 0);
+            while(!openList.empty())
+            {
+                int v = openList.pop();
+                if(done[v])
+                    continue;
+                done[v] = 1;
+                for(int m=0; m<8; m++)
+                {
+                    int r = v/size + MOVES[m][0], c = v%size + MOVES[m][1];
+                    if(!grid.isWalkable(r, c))
+                        continue;
+                    int next = r*size + c;
+                    float d = dist[v] + ((MOVES[m][0] != 0 && MOVES[m][1] != 0) ? sqrtf(2.0f) : 1.0f);
+                    if(d >= dist[next])
+                        continue;
+                    dist[next] = d;
+                    first[next] = (v == source) ? m : first[v];
+                    openList.push(next, d);
+                }
+            }
+
+            // walls and the source itself never get asked, they extend the current run 
+            vector<uint32_t> &list = per_source[source];
+            int current = -1;
+            for(size_t k=0; k<cells; k++)
+            {
+                int target = by_rank[k];
+                if(target == source || !grid.isWalkable(target/size, target%size) || first[target] == current)
+                    continue;
+                current = first[target];
+                list.push_back(((uint32_t)(list.empty() ? 0 : k) << 4) | current);
+            }
+        }
+    });
+
+    release();
+    owned_offsets.assign(cells+1, 0);
+    for(size_t cell=0; cell<cells; cell++)
+        owned_offsets[cell+1] = owned_offsets[cell] + per_source[cell].size();
+    owned_runs.reserve(owned_offsets[cells]);
+    for(size_t cell=0; cell<cells; cell++)
+        owned_runs.insert(owned_runs.end(), per_source[cell].begin(), per_source[cell].end());
+    offsets = &owned_offsets[0];
+    runs = owned_runs.empty() ? NULL : &owned_runs[0];
+}
+int CompressedPathDatabase::firstMove(Position from, Position to) const
+{
+    // index into MOVES, -1 when there is no path (or nothing to do) 
+    if(!grid.isWalkable(from.row, from.col) || !grid.isWalkable(to.row, to.col) || (from.row == to.row && from.col == to.col))
+        return -1;
+    int source = from.row*size + from.col, target = to.row*size + to.col;
+    const uint32_t *lo = runs + offsets[source], *hi = runs + offsets[source+1];
+    if(lo == hi)
+        return -1;
+
+    // last run that starts at or before the target 
+    const uint32_t *run = upper_bound(lo, hi, (rank[target] << 4) | (uint32_t)ANY_MOVE) - 1;
+    int move = *run & 15;
+    return move == NO_PATH ? -1 : move;
+}
+size_t CompressedPathDatabase::getBytes() const
+{
+    return sizeof(uint64_t)*((size_t)size*size + 1) + sizeof(uint32_t)*getRunCount();
+}
+long long CompressedPathDatabase::getRunCount() const
+{
+    return offsets[(size_t)size*size];
+}
+bool CompressedPathDatabase::isMapped() const
+{
+    return mapping != NULL;
+}
+bool CompressedPathDatabase::load(const string &file)
+{
+    // layout: magic, size, board checksum, run count, offsets, runs; mapped read only 
+    int fd = open(file.c_str(), O_RDONLY);
+    if(fd < 0)
+        return false;
+    struct stat info;
+    if(fstat(fd, &info) != 0 || info.st_size < 32)
+    {
+        close(fd);
+        return false;
+    }
+    void *data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(data == MAP_FAILED)
+        return false;
+
+    const char *bytes = (const char*)data;
+    int32_t saved_size;
+    uint64_t checksum, run_count;
+    memcpy(&saved_size, bytes+8, 4);
+    memcpy(&checksum, bytes+16, 8);
+    memcpy(&run_count, bytes+24, 8);
+    size_t cells = (size_t)size*size;
+    size_t expected = 32 + sizeof(uint64_t)*(cells+1) + sizeof(uint32_t)*run_count;
+    const uint64_t *mapped_offsets = (const uint64_t*)(bytes+32);
+    if(memcmp(bytes, "CPDB0001", 8) != 0 || saved_size != size || checksum != grid.checksum() ||
+       (size_t)info.st_size != expected || mapped_offsets[cells] != run_count)
+    {
+        munmap(data, info.st_size);
+        return false;
+    }
+
+    release();
+    mapping = data;
+    mapping_bytes = info.st_size;
+    offsets = mapped_offsets;
+    runs = (const uint32_t*)(bytes + 32 + sizeof(uint64_t)*(cells+1));
+    return true;
+}
+vector<Position> CompressedPathDatabase::path(Position from, Position to) const
+{
+    // follow first moves, every step is on a shortest path to the target 
+    vector<Position> cells;
+    if(!grid.isWalkable(from.row, from.col) || !grid.isWalkable(to.row, to.col))
+        return cells;
+    cells.push_back(from);
+    while(cells.size() <= (size_t)size*size && !(from.row == to.row && from.col == to.col))
+    {
+        int move = firstMove(from, to);
+        if(move < 0)
+            return vector<Position>();
+        from = Position(from.row + MOVES[move][0], from.col + MOVES[move][1]);
+        cells.push_back(from);
+    }
+    return cells;
+}
+void CompressedPathDatabase::release()
+{
+    if(mapping != NULL)
+        munmap(mapping, mapping_bytes);
+    mapping = NULL;
+    mapping_bytes = 0;
+    owned_offsets.clear();
+    owned_runs.clear();
+    offsets = NULL;
+    runs = NULL;
+}
+bool CompressedPathDatabase::save(const string &file) const
+{
+    ofstream out(file.c_str(), ios::binary);
+    if(!out)
+        return false;
+    size_t cells = (size_t)size*size;
+    int32_t saved_size = size, padding = 0;
+    uint64_t checksum = grid.checksum(), run_count = getRunCount();
+    out.write("CPDB0001", 8);
+    out.write((const char*)&saved_size, 4);
+    out.write((const char*)&padding, 4);
+    out.write((const char*)&checksum, 8);
+    out.write((const char*)&run_count, 8);
+    out.write((const char*)offsets, sizeof(uint64_t)*(cells+1));
+    if(run_count > 0)
+        out.write((const char*)runs, sizeof(uint32_t)*run_count);
+    return (bool)out;
+}
+
+
+// MultiTargetSearch Method definations --> 
+MultiTargetSearch::MultiTargetSearch(const WalkableBitset &grid) : grid(grid)
+{
+    size = grid.getSize();
+    bucket_size = size;
+    buckets_per_row = 1;
+    expansions = heuristic_probes = 0;
+    found = -1;
+    path_cost = INFINITY;
+    current_stamp = 0;
+}
+vector<float> MultiTargetSearch::distances(Position start, const vector<Position> &targets)
+{
+    // one Dijkstra that only stops once every target is settled (or nothing is left) 
+    expansions = heuristic_probes = 0;
+    found = -1;
+    path_cost = INFINITY;
+    vector<float> result(targets.size(), INFINITY);
+    if(!grid.isWalkable(start.row, start.col))
+        return result;
+
+    uint32_t st = nextStamp();
+    setTargets(targets, st);
+    int remaining = 0;
+    for(int k=0; k<targets.size(); k++)
+        if(target_at[targets[k].row*size + targets[k].col] == k && grid.isWalkable(targets[k].row, targets[k].col))
+            remaining++;
+
+    int source = start.row*size + start.col;
+    BinaryHeapOpenList<int> openList;
+    g[source] = 0;
+    seen[source] = st;
+    openList.push(source, 0);
+    while(!openList.empty() && remaining > 0)
+    {
+        int cell = openList.pop();
+        if(closed[cell] == st)
+            continue;
+        closed[cell] = st;
+        expansions++;
+        if(target_stamp[cell] == st)
+            remaining--;
+
+        grid.forEachNeighbour(cell, [&](int next, float step) {
+            float cost = g[cell] + step;
+            if(closed[next] == st || (seen[next] == st && cost >= g[next]))
+                return;
+            g[next] = cost;
+            seen[next] = st;
+            openList.push(next, cost);
+        });
+    }
+
+    for(int k=0; k<targets.size(); k++)
+    {
+        int cell = targets[k].row*size + targets[k].col;
+        if(grid.isWalkable(targets[k].row, targets[k].col) && closed[cell] == st)
+            result[k] = g[cell];
+    }
+    return result;
+}
+long long MultiTargetSearch::getExpansions() const
+{
+    return expansions;
+}
+int MultiTargetSearch::getFoundTarget() const
+{
+    return found;
+}
+long long MultiTargetSearch::getHeuristicProbes() const
+{
+    return heuristic_probes;
+}
+float MultiTargetSearch::getPathCost() const
+{
+    return path_cost;
+}
+vector<Position> MultiTargetSearch::nearest(Position start, const vector<Position> &targets, Mode mode)
+{
+    expansions = heuristic_probes = 0;
+    found = -1;
+    path_cost = INFINITY;
+    vector<Position> path;
+    if(!grid.isWalkable(start.row, start.col) || targets.empty())
+        return path;
+
+    uint32_t st = nextStamp();
+    setTargets(targets, st);
+
+    // the closest target is a consistent heuristic, each cell asks for it once 
+    auto heuristic = [&](int cell) {
+        if(mode != A_STAR && mode != A_STAR_LINEAR)
+            return 0.0f;
+        if(h_stamp[cell] != st)
+        {
+            h[cell] = mode == A_STAR ? nearestTargetDistance(cell) : nearestTargetLinear(cell);
+            h_stamp[cell] = st;
+        }
+        return h[cell];
+    };
+
+    int source = start.row*size + start.col, reached = -1;
+    BinaryHeapOpenList<int> openList;
+    queue<int> que;
+    g[source] = 0;
+    parent[source] = -1;
+    seen[source] = st;
+    if(mode == BREADTH_FIRST)
+        que.push(source);
+    else
+        openList.push(source, heuristic(source));
+
+    while(mode == BREADTH_FIRST ? !que.empty() : !openList.empty())
+    {
+        int cell;
+        if(mode == BREADTH_FIRST)
+        {
+            cell = que.front();
+            que.pop();
+        }
+        else
+            cell = openList.pop();
+        if(closed[cell] == st)
+            continue;
+        closed[cell] = st;
+        expansions++;
+        if(target_stamp[cell] == st)
+        {
+            reached = cell;
+            break;
+        }
+
+        grid.forEachNeighbour(cell, [&](int next, float step) {
+            float cost = g[cell] + step;
+            // BFS keeps the first parent, which has the fewest moves 
+            if(closed[next] == st || (seen[next] == st && (mode == BREADTH_FIRST || cost >= g[next])))
+                return;
+            g[next] = cost;
+            parent[next] = cell;
+            seen[next] = st;
+            if(mode == BREADTH_FIRST)
+                que.push(next);
+            else
+                openList.push(next, cost + heuristic(next));
+        });
+    }
+    if(reached < 0)
+        return path;
+
+    found = target_at[reached];
+    path_cost = g[reached];
+    for(int cell=reached; cell!=-1; cell=parent[cell])
+        path.push_back(Position(cell/size, cell%size));
+    reverse(path.begin(), path.end());
+    return path;
+}
+float MultiTargetSearch::nearestTargetDistance(int cell)
+{
+    // Visit rings of buckets around the cell's bucket. A target in ring k is at least 
+    // (k-1)*bucket_size+1 cells away, so stop once that is no closer than the best so far. 
+    int r = cell/size, c = cell%size, br = r/bucket_size, bc = c/bucket_size;
+    float best = INFINITY;
+    for(int k=0; k<buckets_per_row; k++)
+    {
+        if(k > 0 && (k-1)*bucket_size + 1 >= best)
+            break;
+        for(int i=br-k; i<=br+k; i++)
+        {
+            if(i < 0 || i >= buckets_per_row)
+                continue;
+            int step = (i == br-k || i == br+k) ? 1 : 2*k;
+            for(int j=bc-k; j<=bc+k; j+=max(1, step))
+            {
+                if(j < 0 || j >= buckets_per_row)
+                    continue;
+                const vector<int> &bucket = buckets[i*buckets_per_row + j];
+                for(int t=0; t<bucket.size(); t++)
+                    best = min(best, grid.octile(cell, bucket[t]));
+                heuristic_probes += bucket.size();
+            }
+        }
+    }
+    return best;
+}
+float MultiTargetSearch::nearestTargetLinear(int cell)
+{
+    float best = INFINITY;
+    for(int k=0; k<targets.size(); k++)
+        best = min(best, grid.octile(cell, targets[k].row*size + targets[k].col));
+    heuristic_probes += targets.size();
+    return best;
+}
+uint32_t MultiTargetSearch::nextStamp()
+{
+    size_t cells = (size_t)size*size;
+    if(seen.size() < cells)
+    {
+        g.resize(cells);
+        h.resize(cells);
+        parent.resize(cells);
+        target_at.resize(cells);
+        seen.resize(cells, 0);
+        closed.resize(cells, 0);
+        h_stamp.resize(cells, 0);
+        target_stamp.resize(cells, 0);
+    }
+    return ++current_stamp;
+}
+void MultiTargetSearch::setTargets(const vector<Position> &targets, uint32_t stamp)
+{
+    // about one target per bucket, walls and repeats are left out 
+    this->targets.clear();
+    int side = max(1, (int)ceil(sqrt((double)targets.size())));
+    bucket_size = max(4, (size + side - 1) / side);
+    buckets_per_row = (size + bucket_size - 1) / bucket_size;
+    buckets.assign(buckets_per_row*buckets_per_row, vector<int>());
+    for(int k=0; k<targets.size(); k++)
+    {
+        Position pos = targets[k];
+        if(!grid.isWalkable(pos.row, pos.col))
+            continue;
+        int cell = pos.row*size + pos.col;
+        if(target_stamp[cell] == stamp)
+            continue;
+        target_stamp[cell] = stamp;
+        target_at[cell] = k;
+        this->targets.push_back(pos);
+        buckets[(pos.row/bucket_size)*buckets_per_row + pos.col/bucket_size].push_back(cell);
+    }
+}
+
+
+// JunctionGraph Method definations --> 
+template<class OpenList>
+JunctionGraph<OpenList>::JunctionGraph(const WalkableBitset &grid) : grid(grid)
+{
+    size = grid.getSize();
+    expansions = 0;
+    path_cost = INFINITY;
+    current_stamp = 0;
+    build();
+}
+template<class OpenList>
+int JunctionGraph<OpenList>::addEdge(int u, int v, float cost, const vector<int> &cells, const vector<float> &along)
+{
+    int id;
+    if(!free_edges.empty())
+    {
+        id = free_edges.back();
+        free_edges.pop_back();
+    }
+    else
+    {
+        id = edges.size();
+        edges.push_back(Edge());
+    }
+    Edge &edge = edges[id];
+    edge.a = u;
+    edge.b = v;
+    edge.cost = cost;
+    edge.cells = cells;
+    edge.along = along;
+    for(int k=0; k<cells.size(); k++)
+    {
+        edge_at[cells[k]] = id;
+        index_at[cells[k]] = k;
+    }
+    incident[u].push_back(id);
+    if(v != u)
+        incident[v].push_back(id);
+    return id;
+}
+template<class OpenList>
+int JunctionGraph<OpenList>::addNode(int cell)
+{
+    int id;
+    if(!free_nodes.empty())
+    {
+        id = free_nodes.back();
+        free_nodes.pop_back();
+        nodes[id] = cell;
+    }
+    else
+    {
+        id = nodes.size();
+        nodes.push_back(cell);
+        incident.push_back(vector<int>());
+    }
+    node_at[cell] = id;
+    return id;
+}
+template<class OpenList>
+void JunctionGraph<OpenList>::appendCells(int edge, int from, int to, vector<Position> &path) const
+{
+    // places along an edge: -1 is junction a, cells.size() is junction b 
+    const Edge &e = edges[edge];
+    int last = e.cells.size(), dir = to > from ? 1 : -1;
+    for(int k=from+dir; k!=to+dir; k+=dir)
+    {
+        int cell = k < 0 ? nodes[e.a] : (k == last ? nodes[e.b] : e.cells[k]);
+        path.push_back(Position(cell/size, cell%size));
+    }
+}
+template<class OpenList>
+void JunctionGraph<OpenList>::build()
+{
+    int cells = size*size;
+    pruned_at.assign(cells, 0);
+    prune_count = 0;
+    node_at.assign(cells, -1);
+    edge_at.assign(cells, -1);
+    index_at.assign(cells, -1);
+    nodes.clear();
+    incident.clear();
+    edges.clear();
+    free_nodes.clear();
+    free_edges.clear();
+
+    vector<int> queue, pruned, all(cells);
+    for(int cell=0; cell<cells; cell++)
+    {
+        all[cell] = cell;
+        if(grid.isWalkable(cell/size, cell%size))
+            queue.push_back(cell);
+    }
+    prune(queue, pruned);
+    retrace(all);
+}
+template<class OpenList>
+int JunctionGraph<OpenList>::degree(int cell) const
+{
+    int r = cell/size, c = cell%size, count = 0;
+    for(int dr=-1; dr<=1; dr++)
+        for(int dc=-1; dc<=1; dc++)
+            if((dr != 0 || dc != 0) && isKept(r+dr, c+dc))
+                count++;
+    return count;
+}
+template<class OpenList>
+vector<Position> JunctionGraph<OpenList>::findPath(Position start, Position goal)
+{
+    expansions = 0;
+    path_cost = INFINITY;
+    vector<Position> path;
+    if(!grid.isWalkable(start.row, start.col) || !grid.isWalkable(goal.row, goal.col))
+        return path;
+
+    int source = start.row*size + start.col, target = goal.row*size + goal.col;
+    if(source == target)
+    {
+        path_cost = 0;
+        path.push_back(start);
+        return path;
+    }
+
+    // A shortest path only needs to climb through pruned cells (each step to a cell pruned 
+    // later) until it reaches the graph, and to go down the same way to the goal. So the 
+    // goal's climb is searched first, then A* runs from the start over its climb, the 
+    // junctions and the corridor cells it enters through, and stops on the goal's climb. 
+    int count = nodes.size(), cells = size*size, G = count + cells;
+    int st = nextStamp(G+1);
+    auto isAbove = [&](int from, int to) {
+        return pruned_at[to] == 0 || pruned_at[to] > pruned_at[from];
+    };
+
+    vector<int> goal_entries;           // cells in the graph the goal climbs to 
+    OpenList climb;
+    goal_dist[target] = 0;
+    goal_stamp[target] = st;
+    goal_parent[target] = -1;
+    climb.push(target, 0);
+    while(!climb.empty())
+    {
+        int x = climb.pop();
+        if(goal_closed[x] == st)
+            continue;
+        goal_closed[x] = st;
+        expansions++;
+        if(pruned_at[x] == 0)
+        {
+            goal_entries.push_back(x);
+            continue;
+        }
+        grid.forEachNeighbour(x, [&](int n, float step) {
+            float d = goal_dist[x] + step;
+            if(!isAbove(x, n) || (goal_stamp[n] == st && d >= goal_dist[n]))
+                return;
+            goal_dist[n] = d;
+            goal_stamp[n] = st;
+            goal_parent[n] = x;
+            climb.push(n, d);
+        });
+    }
+
+    // states: junctions, then cells (pruned, or corridor cells entered from a pruned cell), then the goal 
+    auto stateOf = [&](int cell) { return node_at[cell] >= 0 ? node_at[cell] : count + cell; };
+    auto cellOf = [&](int state) { return state < count ? nodes[state] : (state == G ? target : state - count); };
+    OpenList openList;
+    int goal_entry = -1;
+    auto relax = [&](int from, int to, float cost, int edge, int from_place, int to_place, int entry) {
+        float d = dist[from] + cost;
+        if(stamp[to] == st && d >= dist[to])
+            return;
+        dist[to] = d;
+        stamp[to] = st;
+        parent[to] = from;
+        via_edge[to] = edge;
+        via_from[to] = from_place;
+        via_to[to] = to_place;
+        if(to == G)
+            goal_entry = entry;
+        openList.push(to, d + grid.octile(cellOf(to), target));
+    };
+
+    int first = stateOf(source);
+    dist[first] = 0;
+    stamp[first] = st;
+    parent[first] = -1;
+    openList.push(first, grid.octile(source, target));
+    while(!openList.empty())
+    {
+        int v = openList.pop();
+        if(closed[v] == st)
+            continue;
+        closed[v] = st;
+        expansions++;
+        if(v == G)
+            break;
+
+        int cell = cellOf(v);
+        if(v >= count && pruned_at[cell] > 0)
+        {
+            // still climbing 
+            grid.forEachNeighbour(cell, [&](int n, float step) {
+                if(isAbove(cell, n))
+                    relax(v, stateOf(n), step, -1, 0, 0, -1);
+            });
+            if(goal_stamp[cell] == st)
+                relax(v, G, goal_dist[cell], -1, 0, 0, cell);
+            continue;
+        }
+
+        if(v >= count)
+        {
+            // a corridor cell: on to both ends, or along it to the goal's entries 
+            int e = edge_at[cell], k = index_at[cell], last = edges[e].cells.size();
+            relax(v, edges[e].a, edges[e].along[k], e, k, -1, -1);
+            relax(v, edges[e].b, edges[e].cost - edges[e].along[k], e, k, last, -1);
+            for(int j=0; j<goal_entries.size(); j++)
+            {
+                int entry = goal_entries[j];
+                if(edge_at[entry] == e)
+                    relax(v, G, fabs(edges[e].along[k] - edges[e].along[index_at[entry]]) + goal_dist[entry], e, k, index_at[entry], entry);
+            }
+            continue;
+        }
+
+        for(int k=0; k<incident[v].size(); k++)
+        {
+            const Edge &e = edges[incident[v][k]];
+            int to = e.a == v ? e.b : e.a, last = e.cells.size();
+            if(to != v)
+                relax(v, to, e.cost, incident[v][k], e.a == v ? -1 : last, e.a == v ? last : -1, -1);
+        }
+        for(int j=0; j<goal_entries.size(); j++)
+        {
+            int entry = goal_entries[j], e = edge_at[entry];
+            if(node_at[entry] == v)
+                relax(v, G, goal_dist[entry], -1, 0, 0, entry);
+            // both ends may be v, when the corridor is a loop 
+            if(e >= 0 && edges[e].a == v)
+                relax(v, G, edges[e].along[index_at[entry]] + goal_dist[entry], e, -1, index_at[entry], entry);
+            if(e >= 0 && edges[e].b == v)
+                relax(v, G, edges[e].cost - edges[e].along[index_at[entry]] + goal_dist[entry], e, edges[e].cells.size(), index_at[entry], entry);
+        }
+    }
+    if(closed[G] != st)
+        return path;
+
+    // unwind the states, expand edges back to corridor cells, then go down the goal's climb 
+    path_cost = dist[G];
+    vector<int> hops;
+    for(int v=G; v!=-1; v=parent[v])
+        hops.push_back(v);
+    reverse(hops.begin(), hops.end());
+    path.push_back(start);
+    for(int k=1; k<hops.size(); k++)
+    {
+        int v = hops[k];
+        if(via_edge[v] >= 0)
+            appendCells(via_edge[v], via_from[v], via_to[v], path);
+        else if(v != G)
+            path.push_back(Position(cellOf(v)/size, cellOf(v)%size));
+    }
+    for(int x=goal_parent[goal_entry]; x!=-1; x=goal_parent[x])
+        path.push_back(Position(x/size, x%size));
+    return path;
+}
+template<class OpenList>
+long long JunctionGraph<OpenList>::getEdgeCount() const
+{
+    return edges.size() - free_edges.size();
+}
+template<class OpenList>
+long long JunctionGraph<OpenList>::getExpansions() const
+{
+    return expansions;
+}
+template<class OpenList>
+int JunctionGraph<OpenList>::getJunctionCount() const
+{
+    return nodes.size() - free_nodes.size();
+}
+template<class OpenList>
+float JunctionGraph<OpenList>::getPathCost() const
+{
+    return path_cost;
+}
+template<class OpenList>
+int JunctionGraph<OpenList>::getPrunedCount() const
+{
+    int pruned = 0;
+    for(int cell=0; cell<pruned_at.size(); cell++)
+        if(pruned_at[cell] > 0)
+            pruned++;
+    return pruned;
+}
+template<class OpenList>
+bool JunctionGraph<OpenList>::hasDirectEdge(int u, int v) const
+{
+    for(int k=0; k<incident[u].size(); k++)
+    {
+        const Edge &e = edges[incident[u][k]];
+        if(e.cells.empty() && (e.a == v || e.b == v))
+            return true;
+    }
+    return false;
+}
+template<class OpenList>
+bool JunctionGraph<OpenList>::isDeadEnd(int cell, int turn) const
+{
+    // the open neighbours touch each other exactly when they fit in a 2x2 square; with a 
+    // turn, as they were when the cells pruned up to that turn were gone 
+    int r = cell/size, c = cell%size;
+    int r_lo = INT_MAX, r_hi = INT_MIN, c_lo = INT_MAX, c_hi = INT_MIN;
+    for(int dr=-1; dr<=1; dr++)
+    {
+        for(int dc=-1; dc<=1; dc++)
+        {
+            if((dr == 0 && dc == 0) || !isKept(r+dr, c+dc, turn))
+                continue;
+            r_lo = min(r_lo, dr);
+            r_hi = max(r_hi, dr);
+            c_lo = min(c_lo, dc);
+            c_hi = max(c_hi, dc);
+        }
+    }
+    return r_lo == INT_MAX || (r_hi - r_lo <= 1 && c_hi - c_lo <= 1);
+}
+template<class OpenList>
+bool JunctionGraph<OpenList>::isKept(int row, int col, int turn) const
+{
+    return grid.isWalkable(row, col) && (pruned_at[row*size + col] == 0 || pruned_at[row*size + col] > turn);
+}
+template<class OpenList>
+int JunctionGraph<OpenList>::nextStamp(int count)
+{
+    if(stamp.size() < count)
+    {
+        dist.resize(count);
+        parent.resize(count);
+        via_edge.resize(count);
+        via_from.resize(count);
+        via_to.resize(count);
+        stamp.resize(count, 0);
+        closed.resize(count, 0);
+    }
+    if(goal_stamp.size() < size*size)
+    {
+        goal_dist.resize(size*size);
+        goal_parent.resize(size*size);
+        goal_stamp.resize(size*size, 0);
+        goal_closed.resize(size*size, 0);
+    }
+    return ++current_stamp;
+}
+template<class OpenList>
+void JunctionGraph<OpenList>::prune(vector<int> &queue, vector<int> &pruned)
+{
+    // pruning a cell can only turn its neighbours into dead ends, so look at them again 
+    for(int k=0; k<queue.size(); k++)
+    {
+        int cell = queue[k], r = cell/size, c = cell%size;
+        if(!isKept(r, c) || !isDeadEnd(cell))
+            continue;
+        pruned_at[cell] = ++prune_count;
+        pruned.push_back(cell);
+        for(int dr=-1; dr<=1; dr++)
+            for(int dc=-1; dc<=1; dc++)
+                if((dr != 0 || dc != 0) && isKept(r+dr, c+dc))
+                    queue.push_back((r+dr)*size + (c+dc));
+    }
+}
+template<class OpenList>
+void JunctionGraph<OpenList>::removeEdge(int edge)
+{
+    Edge &e = edges[edge];
+    for(int k=0; k<e.cells.size(); k++)
+        edge_at[e.cells[k]] = -1;
+    int ends[2] = {e.a, e.b};
+    for(int side=0; side<2; side++)
+    {
+        vector<int> &list = incident[ends[side]];
+        vector<int>::iterator it = find(list.begin(), list.end(), edge);
+        if(it != list.end())
+        {
+            *it = list.back();
+            list.pop_back();
+        }
+    }
+    e.a = e.b = -1;
+    e.cells.clear();
+    e.along.clear();
+    free_edges.push_back(edge);
+}
+template<class OpenList>
+void JunctionGraph<OpenList>::removeNode(int u)
+{
+    while(!incident[u].empty())
+        removeEdge(incident[u].back());
+    node_at[nodes[u]] = -1;
+    nodes[u] = -1;
+    free_nodes.push_back(u);
+}
+template<class OpenList>
+void JunctionGraph<OpenList>::retrace(const vector<int> &dirty)
+{
+    // Drop the junctions on the dirty cells and every edge through them, then trace again 
+    // from the new junctions and from the far ends of everything dropped. 
+    vector<int> ends, loose;
+    for(int k=0; k<dirty.size(); k++)
+    {
+        int cell = dirty[k];
+        vector<int> dropped;
+        if(node_at[cell] >= 0)
+            dropped = incident[node_at[cell]];
+        else if(edge_at[cell] >= 0)
+            dropped.push_back(edge_at[cell]);
+        for(int j=0; j<dropped.size(); j++)
+        {
+            const Edge &e = edges[dropped[j]];
+            ends.push_back(nodes[e.a]);
+            ends.push_back(nodes[e.b]);
+            loose.insert(loose.end(), e.cells.begin(), e.cells.end());
+            removeEdge(dropped[j]);
+        }
+        if(node_at[cell] >= 0)
+            removeNode(node_at[cell]);
+        loose.push_back(cell);
+    }
+
+    for(int k=0; k<dirty.size(); k++)
+    {
+        int cell = dirty[k];
+        if(node_at[cell] < 0 && isKept(cell/size, cell%size) && degree(cell) != 2)
+            ends.push_back(nodes[addNode(cell)]);
+    }
+    for(int k=0; k<ends.size(); k++)
+        if(node_at[ends[k]] >= 0)
+            trace(node_at[ends[k]]);
+
+    // what is left are rings of corridor with no junction on them, give each ring one 
+    for(int k=0; k<loose.size(); k++)
+        if(isKept(loose[k]/size, loose[k]%size) && node_at[loose[k]] < 0 && edge_at[loose[k]] < 0)
+            trace(addNode(loose[k]));
+}
+template<class OpenList>
+void JunctionGraph<OpenList>::setWall(Position pos, bool wall)
+{
+    // A new wall only takes a neighbour away, so every cell pruned so far was still a dead 
+    // end at its turn; only kept cells around it can become dead ends now. A new open cell 
+    // can stop its pruned neighbours from being dead ends, so they are checked again at 
+    // their turn, in the order they were pruned; a cell that is no longer a dead end goes 
+    // back into the graph, and its neighbours pruned after it are checked in turn. Every 
+    // other cell keeps its order. The graph is re-traced around every cell that changed state. 
+    if(pos.row < 0 || pos.col < 0 || pos.row >= size || pos.col >= size || grid.isWalkable(pos.row, pos.col) != wall)
+        return;
+
+    int cell = pos.row*size + pos.col;
+    vector<int> restored, dirty, pruned;
+    auto around = [&](int cell, vector<int> &out) {
+        int r = cell/size, c = cell%size;
+        for(int nr=max(0, r-1); nr<=min(size-1, r+1); nr++)
+            for(int nc=max(0, c-1); nc<=min(size-1, c+1); nc++)
+                out.push_back(nr*size + nc);
+    };
+    grid.setWalkable(pos.row, pos.col, !wall);
+    pruned_at[cell] = 0;
+    if(!wall)
+    {
+        priority_queue<pair<int, int>, vector<pair<int, int> >, greater<pair<int, int> > > turns;
+        vector<int> next;
+        around(cell, next);
+        for(int k=0; k<next.size(); k++)
+            if(pruned_at[next[k]] > 0)
+                turns.push(make_pair(pruned_at[next[k]], next[k]));
+        while(!turns.empty())
+        {
+            int turn = turns.top().first, x = turns.top().second;
+            turns.pop();
+            if(pruned_at[x] != turn || isDeadEnd(x, turn))
+                continue;
+            pruned_at[x] = 0;
+            restored.push_back(x);
+            next.clear();
+            around(x, next);
+            for(int k=0; k<next.size(); k++)
+                if(pruned_at[next[k]] > turn)
+                    turns.push(make_pair(pruned_at[next[k]], next[k]));
+        }
+    }
+
+    around(cell, dirty);
+    for(int k=0; k<restored.size(); k++)
+        around(restored[k], dirty);
+
+    vector<int> queue = dirty;
+    prune(queue, pruned);
+    for(int k=0; k<pruned.size(); k++)
+        around(pruned[k], dirty);
+
+    sort(dirty.begin(), dirty.end());
+    dirty.erase(unique(dirty.begin(), dirty.end()), dirty.end());
+    retrace(dirty);
+}
+template<class OpenList>
+void JunctionGraph<OpenList>::trace(int u)
+{
+    // follow every corridor leaving u that is not traced yet, up to the junction at its end 
+    int start = nodes[u], r = start/size, c = start%size;
+    for(int dr=-1; dr<=1; dr++)
+    {
+        for(int dc=-1; dc<=1; dc++)
+        {
+            if((dr == 0 && dc == 0) || !isKept(r+dr, c+dc))
+                continue;
+            int next = (r+dr)*size + (c+dc);
+            if(node_at[next] >= 0)
+            {
+                if(!hasDirectEdge(u, node_at[next]))
+                    addEdge(u, node_at[next], grid.stepCost(start, next), vector<int>(), vector<float>());
+                continue;
+            }
+            if(edge_at[next] >= 0)
+                continue;
+
+            vector<int> cells;
+            vector<float> along;
+            int prev = start, curr = next;
+            float cost = grid.stepCost(start, next);
+            while(node_at[curr] < 0)
+            {
+                cells.push_back(curr);
+                along.push_back(cost);
+                // a corridor cell has exactly two open neighbours, go on through the other one 
+                int cr = curr/size, cc = curr%size, other = -1;
+                for(int k=0; k<9 && other < 0; k++)
+                {
+                    int nr = cr + k/3 - 1, nc = cc + k%3 - 1;
+                    if(k != 4 && isKept(nr, nc) && nr*size + nc != prev)
+                        other = nr*size + nc;
+                }
+                cost += grid.stepCost(curr, other);
+                prev = curr;
+                curr = other;
+            }
+            addEdge(u, node_at[curr], cost, cells, along);
+        }
+    }
+}
+
+
+// AdaptiveAStar Method definations --> 
+template<class OpenList>
+AdaptiveAStar<OpenList>::AdaptiveAStar(const WalkableBitset &grid, int max_goals) : grid(grid)
+{
+    size = grid.getSize();
+    this->max_goals = max(1, max_goals);
+    learning = true;
+    clock = 0;
+    expansions = learned = repaired = 0;
+    path_cost = INFINITY;
+    current_stamp = 0;
+}
+template<class OpenList>
+void AdaptiveAStar<OpenList>::clear()
+{
+    tables.clear();
+}
+template<class OpenList>
+vector<Position> AdaptiveAStar<OpenList>::findPath(Position start, Position goal)
+{
+    expansions = learned = 0;
+    path_cost = INFINITY;
+    vector<Position> path;
+    if(!grid.isWalkable(start.row, start.col) || !grid.isWalkable(goal.row, goal.col))
+        return path;
+    int source = start.row*size + start.col, target = goal.row*size + goal.col;
+
+    GoalTable *table = NULL;
+    if(learning)
+    {
+        typename unordered_map<int, GoalTable>::iterator it = tables.find(target);
+        if(it == tables.end())
+        {
+            if(tables.size() >= max_goals)
+            {
+                typename unordered_map<int, GoalTable>::iterator oldest = tables.begin();
+                for(typename unordered_map<int, GoalTable>::iterator t=tables.begin(); t!=tables.end(); ++t)
+                    if(t->second.last_used < oldest->second.last_used)
+                        oldest = t;
+                tables.erase(oldest);
+            }
+            it = tables.insert(make_pair(target, GoalTable())).first;
+            it->second.h.assign((size_t)size*size, -1.0f);
+        }
+        table = &it->second;
+        table->last_used = ++clock;
+    }
+
+    // A* with the learned h, ties towards the goal as in aStarSearch 
+    uint32_t stamp = nextStamp();
+    expanded.clear();
+    OpenList openList;
+    g[source] = 0;
+    parent[source] = source;
+    seen[source] = stamp;
+    openList.push(source, heuristic(table, source, target), heuristic(table, source, target));
+    while(!openList.empty())
+    {
+        int curr = openList.pop();
+        if(closed[curr] == stamp)
+            continue;
+        closed[curr] = stamp;
+        expansions++;
+        if(curr == target)
+            break;
+        expanded.push_back(curr);
+
+        grid.forEachNeighbour(curr, [&](int next, float step) {
+            float cost = g[curr] + step;
+            if(closed[next] == stamp || (seen[next] == stamp && cost >= g[next]))
+                return;
+            g[next] = cost;
+            parent[next] = curr;
+            seen[next] = stamp;
+            float h = heuristic(table, next, target);
+            openList.push(next, cost + h, h);
+        });
+    }
+    if(closed[target] != stamp)
+        return path;
+    path_cost = g[target];
+
+    // g(goal) - g(s) is consistent, and so is the larger of two consistent values 
+    if(table != NULL)
+        for(int k=0; k<expanded.size(); k++)
+        {
+            int cell = expanded[k];
+            float h = path_cost - g[cell];
+            if(h > heuristic(table, cell, target))
+            {
+                table->h[cell] = h;
+                learned++;
+            }
+        }
+
+    for(int cell=target; ; cell=parent[cell])
+    {
+        path.push_back(Position(cell/size, cell%size));
+        if(cell == source)
+            break;
+    }
+    reverse(path.begin(), path.end());
+    return path;
+}
+template<class OpenList>
+long long AdaptiveAStar<OpenList>::getExpansions() const
+{
+    return expansions;
+}
+template<class OpenList>
+int AdaptiveAStar<OpenList>::getGoalCount() const
+{
+    return tables.size();
+}
+template<class OpenList>
+long long AdaptiveAStar<OpenList>::getLearnedCount() const
+{
+    // h values raised by the last search 
+    return learned;
+}
+template<class OpenList>
+float AdaptiveAStar<OpenList>::getPathCost() const
+{
+    return path_cost;
+}
+template<class OpenList>
+long long AdaptiveAStar<OpenList>::getRepairedCount() const
+{
+    // h values lowered by the edits so far 
+    return repaired;
+}
+template<class OpenList>
+float AdaptiveAStar<OpenList>::heuristic(const GoalTable *table, int cell, int goal) const
+{
+    if(table != NULL && table->h[cell] >= 0)
+        return table->h[cell];
+    return grid.octile(cell, goal);
+}
+template<class OpenList>
+uint32_t AdaptiveAStar<OpenList>::nextStamp()
+{
+    size_t cells = (size_t)size*size;
+    if(seen.size() < cells)
+    {
+        g.resize(cells);
+        parent.resize(cells);
+        seen.resize(cells, 0);
+        closed.resize(cells, 0);
+    }
+    return ++current_stamp;
+}
+template<class OpenList>
+void AdaptiveAStar<OpenList>::repair(GoalTable &table, int goal, int cell)
+{
+    // the opened cell starts at octile, which is consistent with any learned neighbour; 
+    // the neighbours that can now get cheaper through it lower their h, and so on outwards 
+    table.h[cell] = -1.0f;
+    OpenList openList;
+    openList.push(cell, heuristic(&table, cell, goal));
+    while(!openList.empty())
+    {
+        int curr = openList.pop();
+        float h_curr = heuristic(&table, curr, goal);
+        grid.forEachNeighbour(curr, [&](int next, float step) {
+            float h = step + h_curr;
+            if(next == goal || heuristic(&table, next, goal) <= h)
+                return;
+            table.h[next] = h;
+            repaired++;
+            openList.push(next, h);
+        });
+    }
+}
+template<class OpenList>
+void AdaptiveAStar<OpenList>::setLearning(bool learning)
+{
+    this->learning = learning;
+}
+template<class OpenList>
+void AdaptiveAStar<OpenList>::setWall(Position pos, bool wall)
+{
+    if(pos.row < 0 || pos.col < 0 || pos.row >= size || pos.col >= size || grid.isWalkable(pos.row, pos.col) != wall)
+        return;
+    grid.setWalkable(pos.row, pos.col, !wall);
+    int cell = pos.row*size + pos.col;
+    for(typename unordered_map<int, GoalTable>::iterator it=tables.begin(); it!=tables.end(); )
+    {
+        // a table for a goal that is now a wall is of no use any more 
+        if(wall && it->first == cell)
+        {
+            it = tables.erase(it);
+            continue;
+        }
+        if(wall)
+            it->second.h[cell] = -1.0f;
+        else
+            repair(it->second, it->first, cell);
+        ++it;
+    }
+}
+
+
+// Arena Method definations --> 
+Arena::Arena(size_t capacity)
+{
+    memory = (char*)malloc(capacity);
+    this->capacity = memory != NULL ? capacity : 0;
+    used = peak = 0;
+}
+Arena::~Arena()
+{
+    free(memory);
+}
+void* Arena::allocate(size_t bytes, size_t alignment)
+{
+    // alignment is a power of two, at most the 16 bytes malloc aligns the block to 
+    size_t offset = (used + alignment - 1) & ~(alignment - 1);
+    if(offset > capacity || bytes > capacity - offset)
+        return NULL;
+    used = offset + bytes;
+    peak = max(peak, used);
+    return memory + offset;
+}
+size_t Arena::getCapacity() const
+{
+    return capacity;
+}
+size_t Arena::getPeak() const
+{
+    return peak;
+}
+size_t Arena::getUsed() const
+{
+    return used;
+}
+void Arena::reset()
+{
+    used = peak = 0;
+}
+
+
+// MemoryBoundedSearch Method definations --> 
+MemoryBoundedSearch::MemoryBoundedSearch(const WalkableBitset &grid, size_t budget_bytes) : grid(grid), arena(budget_bytes)
+{
+    size = grid.getSize();
+    target = -1;
+    // three arrays are aligned at the start of the arena, each can lose up to 15 bytes 
+    size_t usable = arena.getCapacity() > 48 ? arena.getCapacity() - 48 : 0;
+    max_nodes = min(usable/getBytesPerNode(), (size_t)INT_MAX/2);
+    live_nodes = peak_nodes = 0;
+    buckets = NULL;
+    bucket_mask = 0;
+    free_nodes = NULL;
+    open.items = leaves.items = NULL;
+    open.count = leaves.count = 0;
+    open.worst_first = false;
+    leaves.worst_first = true;
+    open.pos = &SearchNode::open_pos;
+    leaves.pos = &SearchNode::leaf_pos;
+    expansions = regenerations = forgotten = 0;
+    path_cost = INFINITY;
+    out_of_budget = false;
+}
+MemoryBoundedSearch::SearchNode* MemoryBoundedSearch::allocateNode()
+{
+    if(live_nodes >= max_nodes)
+        return NULL;
+    SearchNode *node = free_nodes;
+    if(node != NULL)
+        free_nodes = node->next_in_bucket;
+    else
+        node = (SearchNode*)arena.allocate(sizeof(SearchNode), alignof(SearchNode));
+    if(node == NULL)
+        return NULL;
+    live_nodes++;
+    peak_nodes = max(peak_nodes, live_nodes);
+    return node;
+}
+void MemoryBoundedSearch::backup(SearchNode *node)
+{
+    // once every successor was generated f is the least f below it; f only ever grows 
+    for(; node != NULL; node=node->parent)
+    {
+        refresh(node);
+        float f = INFINITY;
+        for(int k=0; k<8; k++)
+        {
+            if(isnan(node->child_f[k]))
+                return;
+            f = min(f, node->child_f[k]);
+        }
+        if(f <= node->f)
+            return;
+        node->f = f;
+        refresh(node);
+        if(node->parent != NULL)
+            node->parent->child_f[node->direction] = f;
+    }
+}
+bool MemoryBoundedSearch::before(const Heap &heap, const SearchNode *a, const SearchNode *b) const
+{
+    if(heap.worst_first)
+        return a->f != b->f ? a->f > b->f : a->depth < b->depth;
+    return a->key != b->key ? a->key < b->key : a->depth > b->depth;
+}
+vector<Position> MemoryBoundedSearch::findPath(Position start, Position goal, SearchBudget budget)
+{
+    expansions = regenerations = forgotten = 0;
+    path_cost = INFINITY;
+    out_of_budget = false;
+    live_nodes = peak_nodes = 0;
+    vector<Position> path;
+    if(!grid.isWalkable(start.row, start.col) || !grid.isWalkable(goal.row, goal.col))
+        return path;
+    // no path takes fewer moves than the larger of the two distances 
+    if(max(abs(start.row - goal.row), abs(start.col - goal.col)) >= max_nodes)
+        return path;
+    target = goal.row*size + goal.col;
+    auto begin = chrono::steady_clock::now();
+
+    // the index and both heaps are laid out first, sized for every node that can fit 
+    arena.reset();
+    size_t bucket_count = 1;
+    while(bucket_count*2 <= max_nodes)
+        bucket_count *= 2;
+    bucket_mask = bucket_count - 1;
+    buckets = (SearchNode**)arena.allocate(bucket_count*sizeof(SearchNode*));
+    open.items = (SearchNode**)arena.allocate(max_nodes*sizeof(SearchNode*));
+    leaves.items = (SearchNode**)arena.allocate(max_nodes*sizeof(SearchNode*));
+    memset(buckets, 0, bucket_count*sizeof(SearchNode*));
+    open.count = leaves.count = 0;
+    free_nodes = NULL;
+
+    SearchNode *root = allocateNode();
+    if(root == NULL)
+        return path;
+    root->cell = start.row*size + start.col;
+    root->depth = 0;
+    root->g = 0;
+    root->f = grid.octile(root->cell, target);
+    root->parent = NULL;
+    root->direction = root->children = 0;
+    root->open_pos = root->leaf_pos = -1;
+    for(int k=0; k<8; k++)
+    {
+        root->child[k] = NULL;
+        root->child_f[k] = NAN;
+    }
+    root->next_in_bucket = NULL;
+    buckets[((uint32_t)root->cell*2654435761u) & bucket_mask] = root;
+    refresh(root);
+
+    SearchNode *found = NULL;
+    while(open.count > 0 && found == NULL)
+    {
+        SearchNode *curr = open.items[0];
+        if(curr->cell == target)
+        {
+            found = curr;
+            continue;
+        }
+        if(budget.max_expansions >= 0 && expansions >= budget.max_expansions)
+        {
+            out_of_budget = true;
+            break;
+        }
+        // reading the clock on every generation costs more than the generation 
+        if(budget.max_micros >= 0 && (expansions & 63) == 0 &&
+           chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - begin).count() >= budget.max_micros)
+        {
+            out_of_budget = true;
+            break;
+        }
+
+        // the next successor never generated, then the forgotten one with the least f 
+        int k = 0;
+        while(k < 8 && !isnan(curr->child_f[k]))
+            k++;
+        bool regenerate = k == 8;
+        if(regenerate)
+        {
+            k = -1;
+            for(int d=0; d<8; d++)
+                if(curr->child[d] == NULL && curr->child_f[d] < INFINITY && (k < 0 || curr->child_f[d] < curr->child_f[k]))
+                    k = d;
+        }
+        int row = curr->cell/size + KERNEL_DROW[k], col = curr->cell%size + KERNEL_DCOL[k];
+        if(!grid.isWalkable(row, col))
+        {
+            curr->child_f[k] = INFINITY;
+            backup(curr);
+            continue;
+        }
+        int cell = row*size + col;
+        float g = curr->g + ((KERNEL_DROW[k] != 0 && KERNEL_DCOL[k] != 0) ? sqrtf(2.0f) : 1.0f);
+
+        // a cell held at no higher g is pruned, leaves holding it at a higher g go for good 
+        bool dominated = false;
+        size_t bucket = ((uint32_t)cell*2654435761u) & bucket_mask;
+        for(SearchNode *node=buckets[bucket], *next; node != NULL && !dominated; node=next)
+        {
+            next = node->next_in_bucket;
+            if(node->cell != cell)
+                continue;
+            if(node->g <= g + 1e-4f)
+                dominated = true;
+            else if(node->children == 0)
+                forget(node, INFINITY);
+        }
+        // a successor as deep as memory can hold a path to, that is not the goal, is a dead end 
+        if(dominated || (curr->depth + 2 >= max_nodes && cell != target))
+        {
+            curr->child_f[k] = INFINITY;
+            backup(curr);
+            continue;
+        }
+
+        // memory is full: the worst leaf other than curr goes and its parent keeps its f 
+        SearchNode *node = allocateNode();
+        if(node == NULL)
+        {
+            bool was_leaf = curr->leaf_pos >= 0;
+            if(was_leaf)
+                heapRemove(leaves, curr);
+            if(leaves.count > 0)
+                forget(leaves.items[0], leaves.items[0]->f);
+            if(was_leaf)
+                refresh(curr);
+            node = allocateNode();
+            if(node == NULL)
+            {
+                curr->child_f[k] = INFINITY;
+                backup(curr);
+                continue;
+            }
+        }
+        node->cell = cell;
+        node->depth = curr->depth + 1;
+        node->g = g;
+        node->f = max(curr->f, regenerate ? curr->child_f[k] : g + grid.octile(cell, target));
+        node->parent = curr;
+        node->direction = k;
+        node->children = 0;
+        node->open_pos = node->leaf_pos = -1;
+        for(int d=0; d<8; d++)
+        {
+            node->child[d] = NULL;
+            node->child_f[d] = NAN;
+        }
+        node->next_in_bucket = buckets[bucket];
+        buckets[bucket] = node;
+        curr->child[k] = node;
+        curr->child_f[k] = node->f;
+        curr->children++;
+        expansions++;
+        if(regenerate)
+            regenerations++;
+        refresh(node);
+        backup(curr);
+    }
+    if(found == NULL)
+        return path;
+
+    path_cost = found->g;
+    for(SearchNode *node=found; node != NULL; node=node->parent)
+        path.push_back(Position(node->cell/size, node->cell%size));
+    reverse(path.begin(), path.end());
+    return path;
+}
+void MemoryBoundedSearch::forget(SearchNode *node, float f)
+{
+    heapSet(open, node, false);
+    heapSet(leaves, node, false);
+    SearchNode **link = &buckets[((uint32_t)node->cell*2654435761u) & bucket_mask];
+    while(*link != node)
+        link = &(*link)->next_in_bucket;
+    *link = node->next_in_bucket;
+
+    SearchNode *parent = node->parent;
+    parent->child[node->direction] = NULL;
+    parent->child_f[node->direction] = f;
+    parent->children--;
+    node->next_in_bucket = free_nodes;
+    free_nodes = node;
+    live_nodes--;
+    forgotten++;
+    backup(parent);
+}
+size_t MemoryBoundedSearch::getBudget() const
+{
+    return arena.getCapacity();
+}
+size_t MemoryBoundedSearch::getBytesPerNode()
+{
+    // the node, its slot in both heaps and at most one index bucket 
+    return sizeof(SearchNode) + 3*sizeof(SearchNode*);
+}
+long long MemoryBoundedSearch::getExpansions() const
+{
+    // successors generated, regenerated ones included 
+    return expansions;
+}
+long long MemoryBoundedSearch::getForgottenCount() const
+{
+    return forgotten;
+}
+size_t MemoryBoundedSearch::getMaxNodes() const
+{
+    return max_nodes;
+}
+float MemoryBoundedSearch::getPathCost() const
+{
+    return path_cost;
+}
+size_t MemoryBoundedSearch::getPeakBytes() const
+{
+    // measured by the arena, never more than the budget 
+    return arena.getPeak();
+}
+size_t MemoryBoundedSearch::getPeakNodes() const
+{
+    return peak_nodes;
+}
+long long MemoryBoundedSearch::getRegenerations() const
+{
+    return regenerations;
+}
+bool MemoryBoundedSearch::isOutOfBudget() const
+{
+    // the last search stopped on its SearchBudget, not because no path fits 
+    return out_of_budget;
+}
+void MemoryBoundedSearch::heapRemove(Heap &heap, SearchNode *node)
+{
+    int hole = node->*heap.pos;
+    node->*heap.pos = -1;
+    SearchNode *last = heap.items[--heap.count];
+    if(last == node)
+        return;
+    heap.items[hole] = last;
+    last->*heap.pos = hole;
+    siftUp(heap, hole);
+    siftDown(heap, last->*heap.pos);
+}
+void MemoryBoundedSearch::heapSet(Heap &heap, SearchNode *node, bool member)
+{
+    // adds, moves or removes node after its key changed 
+    int pos = node->*heap.pos;
+    if(!member)
+    {
+        if(pos >= 0)
+            heapRemove(heap, node);
+        return;
+    }
+    if(pos < 0)
+    {
+        pos = heap.count++;
+        heap.items[pos] = node;
+        node->*heap.pos = pos;
+    }
+    siftUp(heap, pos);
+    siftDown(heap, node->*heap.pos);
+}
+void MemoryBoundedSearch::refresh(SearchNode *node)
+{
+    // in open while there is something left to generate: the goal stays in until it is picked 
+    bool complete = true;
+    float forgotten_f = INFINITY;
+    for(int k=0; k<8; k++)
+        if(isnan(node->child_f[k]))
+            complete = false;
+        else if(node->child[k] == NULL)
+            forgotten_f = min(forgotten_f, node->child_f[k]);
+    node->key = (complete && node->cell != target) ? forgotten_f : node->f;
+    heapSet(open, node, node->key < INFINITY);
+    heapSet(leaves, node, node->children == 0);
+}
+void MemoryBoundedSearch::setWall(Position pos, bool wall)
+{
+    if(pos.row < 0 || pos.col < 0 || pos.row >= size || pos.col >= size)
+        return;
+    grid.setWalkable(pos.row, pos.col, !wall);
+}
+void MemoryBoundedSearch::siftDown(Heap &heap, int hole)
+{
+    SearchNode *node = heap.items[hole];
+    while(true)
+    {
+        int child = 2*hole + 1;
+        if(child >= heap.count)
+            break;
+        if(child + 1 < heap.count && before(heap, heap.items[child+1], heap.items[child]))
+            child++;
+        if(!before(heap, heap.items[child], node))
+            break;
+        heap.items[hole] = heap.items[child];
+        heap.items[hole]->*heap.pos = hole;
+        hole = child;
+    }
+    heap.items[hole] = node;
+    node->*heap.pos = hole;
+}
+void MemoryBoundedSearch::siftUp(Heap &heap, int hole)
+{
+    SearchNode *node = heap.items[hole];
+    while(hole > 0)
+    {
+        int parent = (hole - 1)/2;
+        if(!before(heap, node, heap.items[parent]))
+            break;
+        heap.items[hole] = heap.items[parent];
+        heap.items[hole]->*heap.pos = hole;
+        hole = parent;
+    }
+    heap.items[hole] = node;
+    node->*heap.pos = hole;
+}
+
+
+// Voxel Method definations --> 
+Voxel::Voxel(int row, int col, int layer)
+{
+    this->row = row;
+    this->col = col;
+    this->layer = layer;
+}
+bool Voxel::operator == (const Voxel &other) const
+{
+    return row == other.row && col == other.col && layer == other.layer;
+}
+
+
+// VoxelGrid Method definations --> 
+const int VoxelGrid::DROW[26]   = {-1, 1, 0, 0, 0, 0,   -1, -1, 1, 1, -1, -1, 1, 1, 0, 0, 0, 0,   -1, -1, -1, -1, 1, 1, 1, 1};
+const int VoxelGrid::DCOL[26]   = {0, 0, -1, 1, 0, 0,   -1, 1, -1, 1, 0, 0, 0, 0, -1, -1, 1, 1,   -1, -1, 1, 1, -1, -1, 1, 1};
+const int VoxelGrid::DLAYER[26] = {0, 0, 0, 0, -1, 1,   0, 0, 0, 0, -1, 1, -1, 1, -1, 1, -1, 1,   -1, 1, -1, 1, -1, 1, -1, 1};
+VoxelGrid::VoxelGrid(int rows, int cols, int layers, bool walkable)
+{
+    this->rows = rows;
+    this->cols = cols;
+    this->layers = layers;
+    words_per_row = (cols + 63) / 64;
+    bits.assign((size_t)rows*layers*words_per_row, 0);
+    if(!walkable)
+        return;
+
+    // every word full, less the padding past the last column 
+    uint64_t last_mask = cols % 64 == 0 ? ~0ULL : (1ULL << (cols % 64)) - 1;
+    for(size_t w=0; w<bits.size(); w++)
+        bits[w] = w % words_per_row == words_per_row - 1 ? last_mask : ~0ULL;
+}
+long long VoxelGrid::countWalkable() const
+{
+    long long count = 0;
+    for(size_t w=0; w<bits.size(); w++)
+        count += __builtin_popcountll(bits[w]);
+    return count;
+}
+uint64_t VoxelGrid::checksum() const
+{
+    // FNV-1a over the dimensions and the words 
+    uint64_t hash = 1469598103934665603ULL;
+    uint64_t values[3] = {(uint64_t)rows, (uint64_t)cols, (uint64_t)layers};
+    for(int k=0; k<3; k++)
+    {
+        hash ^= values[k];
+        hash *= 1099511628211ULL;
+    }
+    for(size_t w=0; w<bits.size(); w++)
+    {
+        hash ^= bits[w];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+float VoxelGrid::distance(Voxel a, Voxel b, Connectivity connectivity)
+{
+    // the cheapest mix of moves with no walls in the way, d[0] <= d[1] <= d[2] 
+    int d[3] = {abs(a.row - b.row), abs(a.col - b.col), abs(a.layer - b.layer)};
+    sort(d, d + 3);
+    if(connectivity == FACES)
+        return d[0] + d[1] + d[2];
+    if(connectivity == CORNERS)
+        return (sqrtf(3.0f) - sqrtf(2.0f))*d[0] + (sqrtf(2.0f) - 1.0f)*d[1] + d[2];
+    // two-axis moves while two axes are left to change, the rest one axis at a time 
+    int sum = d[0] + d[1] + d[2], pairs = min(sum/2, d[0] + d[1]);
+    return sqrtf(2.0f)*pairs + (sum - 2*pairs);
+}
+void VoxelGrid::fillBuilding(uint64_t seed, int storey, float density)
+{
+    // storeys of storey-1 layers under a solid slab. Walls and pillars run floor to ceiling: a 
+    // 2D random fill at density, the same in every layer of a storey. Every slab has a 4x4 
+    // stairwell somewhere in each 32x32 area 
+    storey = max(2, storey);
+    parallelFor(0, (layers + storey - 1) / storey, [&](long long lo, long long hi) {
+        vector<uint64_t> plan((size_t)rows*words_per_row);
+        for(long long s=lo; s<hi; s++)
+        {
+            Random random(Random::mix(seed, s));
+            for(int i=0; i<rows; i++)
+                for(int w=0; w<words_per_row; w++)
+                {
+                    uint64_t word = 0;
+                    for(int b=0; b<64 && w*64 + b < cols; b++)
+                        if(random.nextFloat() >= density)
+                            word |= 1ULL << b;
+                    plan[(size_t)i*words_per_row + w] = word;
+                }
+            int first = s*storey, slab = min(layers, first + storey) - 1;
+            for(int layer=first; layer<slab; layer++)
+                copy(plan.begin(), plan.end(), bits.begin() + (size_t)layer*rows*words_per_row);
+            if(slab < first + storey - 1)
+            {
+                // the top storey is cut short by the volume and has no slab 
+                copy(plan.begin(), plan.end(), bits.begin() + (size_t)slab*rows*words_per_row);
+                continue;
+            }
+            fill(bits.begin() + (size_t)slab*rows*words_per_row, bits.begin() + (size_t)(slab + 1)*rows*words_per_row, 0ULL);
+            for(int r0=0; r0<rows; r0+=32)
+                for(int c0=0; c0<cols; c0+=32)
+                {
+                    int r = r0 + random.nextInt(max(1, min(32, rows - r0) - 3));
+                    int c = c0 + random.nextInt(max(1, min(32, cols - c0) - 3));
+                    for(int i=r; i<min(rows, r + 4); i++)
+                        for(int j=c; j<min(cols, c + 4); j++)
+                            setWalkable(i, j, slab, true);
+                }
+        }
+    });
+}
+void VoxelGrid::fillRandom(uint64_t seed, float density)
+{
+    // each voxel is a wall with probability density, one random stream per layer 
+    parallelFor(0, layers, [&](long long lo, long long hi) {
+        for(long long layer=lo; layer<hi; layer++)
+        {
+            Random random(Random::mix(seed, layer));
+            uint64_t *words = &bits[(size_t)layer*rows*words_per_row];
+            for(int i=0; i<rows; i++)
+                for(int w=0; w<words_per_row; w++)
+                {
+                    uint64_t word = 0;
+                    for(int b=0; b<64 && w*64 + b < cols; b++)
+                        if(random.nextFloat() >= density)
+                            word |= 1ULL << b;
+                    words[(size_t)i*words_per_row + w] = word;
+                }
+        }
+    });
+}
+int VoxelGrid::getCols() const
+{
+    return cols;
+}
+int VoxelGrid::getLayers() const
+{
+    return layers;
+}
+int VoxelGrid::getRows() const
+{
+    return rows;
+}
+bool VoxelGrid::isWalkable(int row, int col, int layer) const
+{
+    if(row < 0 || col < 0 || layer < 0 || row >= rows || col >= cols || layer >= layers)
+        return false;
+    return (bits[((size_t)layer*rows + row)*words_per_row + (col >> 6)] >> (col & 63)) & 1;
+}
+bool VoxelGrid::load(const string &file)
+{
+    // layout: magic, rows, cols, layers, then the words, padding included 
+    ifstream in(file.c_str(), ios::binary);
+    char magic[8];
+    int32_t dims[3];
+    if(!in || !in.read(magic, 8) || memcmp(magic, "VOXEL001", 8) != 0 || !in.read((char*)dims, sizeof(dims)))
+        return false;
+    // the searches number voxels with 32 bits 
+    if(dims[0] < 0 || dims[1] < 0 || dims[2] < 0 || (int64_t)dims[0]*dims[1]*dims[2] > 0xFFFFFFFFLL)
+        return false;
+    int saved_words_per_row = (dims[1] + 63) / 64;
+    vector<uint64_t> saved((size_t)dims[0]*dims[2]*saved_words_per_row);
+    if(!saved.empty() && !in.read((char*)&saved[0], saved.size()*sizeof(uint64_t)))
+        return false;
+
+    rows = dims[0];
+    cols = dims[1];
+    layers = dims[2];
+    words_per_row = saved_words_per_row;
+    bits.swap(saved);
+    return true;
+}
+bool VoxelGrid::save(const string &file) const
+{
+    ofstream out(file.c_str(), ios::binary);
+    if(!out)
+        return false;
+    int32_t dims[3] = {rows, cols, layers};
+    out.write("VOXEL001", 8);
+    out.write((const char*)dims, sizeof(dims));
+    out.write((const char*)bits.data(), bits.size()*sizeof(uint64_t));
+    return (bool)out;
+}
+void VoxelGrid::setWalkable(int row, int col, int layer, bool walkable)
+{
+    if(row < 0 || col < 0 || layer < 0 || row >= rows || col >= cols || layer >= layers)
+        return;
+    uint64_t &word = bits[((size_t)layer*rows + row)*words_per_row + (col >> 6)];
+    if(walkable)
+        word |= 1ULL << (col & 63);
+    else
+        word &= ~(1ULL << (col & 63));
+}
+float VoxelGrid::stepCost(int direction)
+{
+    return direction < 6 ? 1.0f : direction < 18 ? sqrtf(2.0f) : sqrtf(3.0f);
+}
+
+
+// VoxelSearch Method definations --> 
+template<class OpenList>
+VoxelSearch<OpenList>::VoxelSearch(const VoxelGrid &grid, VoxelGrid::Connectivity connectivity) : grid(grid)
+{
+    this->connectivity = connectivity;
+    algorithm = A_STAR_SEARCH;
+    status = NOT_FOUND;
+    brick_rows = (grid.getRows() + 15) / 16;
+    brick_cols = (grid.getCols() + 15) / 16;
+    bricks.assign((size_t)brick_rows*brick_cols*((grid.getLayers() + 15) / 16), NULL);
+    touched_bricks = 0;
+    current_stamp = 0;
+    source = target = 0;
+    expansions = 0;
+    path_cost = INFINITY;
+}
+template<class OpenList>
+VoxelSearch<OpenList>::~VoxelSearch()
+{
+    for(size_t k=0; k<bricks.size(); k++)
+        delete bricks[k];
+}
+template<class OpenList>
+void VoxelSearch<OpenList>::begin(SearchAlgorithm algorithm, Voxel start, Voxel goal)
+{
+    this->algorithm = algorithm;
+    status = RUNNING;
+    open_list.clear();
+    fifo.clear();
+    touched_bricks = 0;
+    current_stamp++;
+    expansions = 0;
+    path_cost = INFINITY;
+    if(!isSupported(algorithm) || !grid.isWalkable(start.row, start.col, start.layer) || !grid.isWalkable(goal.row, goal.col, goal.layer))
+    {
+        finish(false);
+        return;
+    }
+    source = ((uint32_t)start.layer*grid.getRows() + start.row)*grid.getCols() + start.col;
+    target = ((uint32_t)goal.layer*grid.getRows() + goal.row)*grid.getCols() + goal.col;
+
+    int slot;
+    Brick *brick = touch(brickOf(start.row, start.col, start.layer, slot));
+    brick->g[slot] = 0;
+    brick->from[slot] = START;
+    if(algorithm == A_STAR_SEARCH)
+        open_list.push(source, heuristic(source), heuristic(source));
+    else
+        fifo.push_back(source);
+}
+template<class OpenList>
+size_t VoxelSearch<OpenList>::brickOf(int row, int col, int layer, int &slot) const
+{
+    slot = ((layer & 15) << 8) | ((row & 15) << 4) | (col & 15);
+    return ((size_t)(layer >> 4)*brick_rows + (row >> 4))*brick_cols + (col >> 4);
+}
+template<class OpenList>
+bool VoxelSearch<OpenList>::expandAStar()
+{
+    while(!open_list.empty())
+    {
+        uint32_t curr = open_list.pop();
+        Voxel voxel = toVoxel(curr);
+        int slot;
+        Brick *brick = bricks[brickOf(voxel.row, voxel.col, voxel.layer, slot)];
+
+        // a cheaper copy of this voxel was pushed later and already expanded 
+        if(brick->from[slot] & CLOSED)
+            continue;
+        brick->from[slot] |= CLOSED;
+        expansions++;
+        if(curr == target)
+            return finish(true);
+
+        float g = brick->g[slot];
+        for(int k=0; k<connectivity; k++)
+        {
+            int r = voxel.row + VoxelGrid::DROW[k], c = voxel.col + VoxelGrid::DCOL[k], l = voxel.layer + VoxelGrid::DLAYER[k];
+            if(!grid.isWalkable(r, c, l))
+                continue;
+            int next_slot;
+            Brick *next_brick = touch(brickOf(r, c, l, next_slot));
+            float cost = g + VoxelGrid::stepCost(k);
+            if((next_brick->from[next_slot] & CLOSED) || cost >= next_brick->g[next_slot])
+                continue;
+            next_brick->g[next_slot] = cost;
+            next_brick->from[next_slot] = k;
+            // the open list keeps the key it was given, so push again instead of decrease-key 
+            // f is rounded to 1/1024: equal cost paths reach a voxel with g a few ulps apart, 
+            // which would order the plateau by noise instead of by h; paths can come out less 
+            // than 1/1024 longer than optimal 
+            uint32_t next = ((uint32_t)l*grid.getRows() + r)*grid.getCols() + c;
+            float h = heuristic(next);
+            open_list.push(next, roundf((cost + h)*1024)/1024, h);
+        }
+        return true;
+    }
+    return finish(false);
+}
+template<class OpenList>
+bool VoxelSearch<OpenList>::expandBreadthFirst()
+{
+    if(fifo.empty())
+        return finish(false);
+
+    uint32_t curr = fifo.front();
+    fifo.pop_front();
+    expansions++;
+    if(curr == target)
+        return finish(true);
+
+    // a voxel is queued once, the first time it is reached, with the fewest moves 
+    Voxel voxel = toVoxel(curr);
+    int slot;
+    float g = bricks[brickOf(voxel.row, voxel.col, voxel.layer, slot)]->g[slot];
+    for(int k=0; k<connectivity; k++)
+    {
+        int r = voxel.row + VoxelGrid::DROW[k], c = voxel.col + VoxelGrid::DCOL[k], l = voxel.layer + VoxelGrid::DLAYER[k];
+        if(!grid.isWalkable(r, c, l))
+            continue;
+        int next_slot;
+        Brick *next_brick = touch(brickOf(r, c, l, next_slot));
+        if(next_brick->from[next_slot] != NONE)
+            continue;
+        next_brick->g[next_slot] = g + VoxelGrid::stepCost(k);
+        next_brick->from[next_slot] = k;
+        fifo.push_back(((uint32_t)l*grid.getRows() + r)*grid.getCols() + c);
+    }
+    return true;
+}
+template<class OpenList>
+vector<Voxel> VoxelSearch<OpenList>::findPath(SearchAlgorithm algorithm, Voxel start, Voxel goal)
+{
+    begin(algorithm, start, goal);
+    step();
+    return getPath();
+}
+template<class OpenList>
+bool VoxelSearch<OpenList>::finish(bool found)
+{
+    status = found ? FOUND : NOT_FOUND;
+    if(found)
+    {
+        Voxel goal = toVoxel(target);
+        int slot;
+        path_cost = bricks[brickOf(goal.row, goal.col, goal.layer, slot)]->g[slot];
+    }
+    return false;
+}
+template<class OpenList>
+long long VoxelSearch<OpenList>::getExpansions() const
+{
+    return expansions;
+}
+template<class OpenList>
+vector<Voxel> VoxelSearch<OpenList>::getPath() const
+{
+    // walks the moves back from the goal, empty unless the search found it 
+    vector<Voxel> path;
+    if(status != FOUND)
+        return path;
+    Voxel voxel = toVoxel(target);
+    while(true)
+    {
+        path.push_back(voxel);
+        int slot;
+        int k = bricks[brickOf(voxel.row, voxel.col, voxel.layer, slot)]->from[slot] & ~CLOSED;
+        if(k == START)
+            break;
+        voxel = Voxel(voxel.row - VoxelGrid::DROW[k], voxel.col - VoxelGrid::DCOL[k], voxel.layer - VoxelGrid::DLAYER[k]);
+    }
+    reverse(path.begin(), path.end());
+    return path;
+}
+template<class OpenList>
+float VoxelSearch<OpenList>::getPathCost() const
+{
+    return path_cost;
+}
+template<class OpenList>
+size_t VoxelSearch<OpenList>::getScratchBytes() const
+{
+    // bricks the last search touched 
+    return touched_bricks*sizeof(Brick);
+}
+template<class OpenList>
+typename VoxelSearch<OpenList>::Status VoxelSearch<OpenList>::getStatus() const
+{
+    return status;
+}
+template<class OpenList>
+float VoxelSearch<OpenList>::heuristic(uint32_t cell) const
+{
+    return VoxelGrid::distance(toVoxel(cell), toVoxel(target), connectivity);
+}
+template<class OpenList>
+bool VoxelSearch<OpenList>::isSupported(SearchAlgorithm algorithm)
+{
+    return algorithm == BREADTH_FIRST_SEARCH || algorithm == A_STAR_SEARCH;
+}
+template<class OpenList>
+typename VoxelSearch<OpenList>::Status VoxelSearch<OpenList>::step(long long max_expansions)
+{
+    for(long long k=0; k<max_expansions && status == RUNNING; k++)
+    {
+        if(algorithm == BREADTH_FIRST_SEARCH)
+            expandBreadthFirst();
+        else
+            expandAStar();
+    }
+    return status;
+}
+template<class OpenList>
+Voxel VoxelSearch<OpenList>::toVoxel(uint32_t cell) const
+{
+    uint32_t plane = (uint32_t)grid.getRows()*grid.getCols();
+    uint32_t rest = cell % plane;
+    return Voxel(rest / grid.getCols(), rest % grid.getCols(), cell / plane);
+}
+template<class OpenList>
+typename VoxelSearch<OpenList>::Brick* VoxelSearch<OpenList>::touch(size_t brick)
+{
+    // a brick first touched by this search starts out unreached 
+    Brick *&touched = bricks[brick];
+    if(touched == NULL)
+    {
+        touched = new Brick;
+        touched->stamp = 0;
+    }
+    if(touched->stamp != current_stamp)
+    {
+        touched->stamp = current_stamp;
+        fill(touched->g, touched->g + 4096, INFINITY);
+        memset(touched->from, NONE, sizeof(touched->from));
+        touched_bricks++;
+    }
+    return touched;
+}
+
+
+// AlternativeRoutes Method definations --> 
+template<class OpenList>
+AlternativeRoutes<OpenList>::AlternativeRoutes(const WalkableBitset &grid) : grid(grid)
+{
+    size = grid.getSize();
+    reuse_tree = true;
+    tree_goal = -1;
+    expansions = tree_builds = 0;
+    tree_ms = 0;
+    penalized = false;
+    current_stamp = banned_stamp = 0;
+}
+template<class OpenList>
+void AlternativeRoutes<OpenList>::addRoute(const vector<int> &cells, chrono::steady_clock::time_point &since, long long &counted)
+{
+    // the overlap is taken before the route's own cells are counted 
+    Route route;
+    route.cost = 0;
+    int shared = 0;
+    for(int k=0; k<cells.size(); k++)
+    {
+        route.path.push_back(Position(cells[k]/size, cells[k]%size));
+        if(k > 0)
+            route.cost += grid.stepCost(cells[k-1], cells[k]);
+        if(k > 0 && k+1 < cells.size() && uses[cells[k]] > 0)
+            shared++;
+    }
+    for(int k=1; k+1<cells.size(); k++)
+        uses[cells[k]]++;
+    route.overlap = cells.size() > 2 ? (float)shared / (cells.size() - 2) : 0.0f;
+
+    chrono::steady_clock::time_point now = chrono::steady_clock::now();
+    route.ms = chrono::duration<double, milli>(now - since).count();
+    route.expansions = expansions - counted;
+    since = now;
+    counted = expansions;
+    routes.push_back(route);
+}
+template<class OpenList>
+bool AlternativeRoutes<OpenList>::begin(Position start, Position goal, int &source, int &target)
+{
+    // forget the last query's counts and penalties, they only sit on its routes 
+    size_t cells = (size_t)size*size;
+    if(uses.size() < cells)
+    {
+        uses.assign(cells, 0);
+        extra.assign(cells, 0.0f);
+        banned.assign(cells, 0);
+    }
+    for(int r=0; r<routes.size(); r++)
+        for(int k=0; k<routes[r].path.size(); k++)
+        {
+            int cell = routes[r].path[k].row*size + routes[r].path[k].col;
+            uses[cell] = 0;
+            extra[cell] = 0.0f;
+        }
+    routes.clear();
+    expansions = 0;
+    penalized = false;
+    banned_stamp++;
+
+    if(!grid.isWalkable(start.row, start.col) || !grid.isWalkable(goal.row, goal.col))
+        return false;
+    source = start.row*size + start.col;
+    target = goal.row*size + goal.col;
+    if(!reuse_tree)
+        return true;
+    if(tree_goal != target)
+        buildTree(target);
+    return to_goal[source] < INFINITY;
+}
+template<class OpenList>
+void AlternativeRoutes<OpenList>::buildTree(int target)
+{
+    // Dijkstra backwards from the goal, every move costs the same both ways 
+    auto begin = chrono::steady_clock::now();
+    size_t cells = (size_t)size*size;
+    to_goal.assign(cells, INFINITY);
+    next_hop.assign(cells, -1);
+    uint32_t stamp = nextStamp();
+    OpenList openList;
+    to_goal[target] = 0;
+    next_hop[target] = target;
+    openList.push(target, 0);
+    while(!openList.empty())
+    {
+        int curr = openList.pop();
+        if(closed[curr] == stamp)
+            continue;
+        closed[curr] = stamp;
+        expansions++;
+
+        grid.forEachNeighbour(curr, [&](int next, float step) {
+            float distance = to_goal[curr] + step;
+            if(distance < to_goal[next])
+            {
+                to_goal[next] = distance;
+                next_hop[next] = curr;
+                openList.push(next, distance);
+            }
+        });
+    }
+    tree_goal = target;
+    tree_builds++;
+    tree_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count();
+}
+template<class OpenList>
+const vector<typename AlternativeRoutes<OpenList>::Route>& AlternativeRoutes<OpenList>::diverse(Position start, Position goal, int k, float penalty)
+{
+    chrono::steady_clock::time_point since = chrono::steady_clock::now();
+    long long counted = 0;
+    int source, target;
+    vector<int> no_moves, cells;
+    if(k <= 0 || !begin(start, goal, source, target) || search(source, target, no_moves, cells) == INFINITY)
+        return routes;
+    vector<vector<int> > found(1, cells);
+    addRoute(cells, since, counted);
+
+    // every search adds the penalty to the cells it used, so a route found again is pushed 
+    // harder the next time; a few tries per route before giving up 
+    penalized = true;
+    for(int attempt=0; found.size() < k && attempt < 4*k; attempt++)
+    {
+        for(int j=1; j+1<cells.size(); j++)
+            extra[cells[j]] += penalty;
+        search(source, target, no_moves, cells);
+        if(find(found.begin(), found.end(), cells) != found.end())
+            continue;
+        found.push_back(cells);
+        addRoute(cells, since, counted);
+    }
+    return routes;
+}
+template<class OpenList>
+long long AlternativeRoutes<OpenList>::getExpansions() const
+{
+    // by the last query, a tree it grew included 
+    return expansions;
+}
+template<class OpenList>
+const vector<typename AlternativeRoutes<OpenList>::Route>& AlternativeRoutes<OpenList>::getRoutes() const
+{
+    return routes;
+}
+template<class OpenList>
+long long AlternativeRoutes<OpenList>::getTreeBuilds() const
+{
+    return tree_builds;
+}
+template<class OpenList>
+double AlternativeRoutes<OpenList>::getTreeMs() const
+{
+    // of the last tree grown 
+    return tree_ms;
+}
+template<class OpenList>
+float AlternativeRoutes<OpenList>::heuristic(int cell, int target) const
+{
+    if(reuse_tree)
+        return to_goal[cell];
+    return grid.octile(cell, target);
+}
+template<class OpenList>
+const vector<typename AlternativeRoutes<OpenList>::Route>& AlternativeRoutes<OpenList>::kShortest(Position start, Position goal, int k)
+{
+    chrono::steady_clock::time_point since = chrono::steady_clock::now();
+    long long counted = 0;
+    int source, target;
+    vector<int> no_moves, cells;
+    if(k <= 0 || !begin(start, goal, source, target) || search(source, target, no_moves, cells) == INFINITY)
+        return routes;
+    vector<vector<int> > found(1, cells);
+    vector<int> deviations(1, 0);
+    addRoute(cells, since, counted);
+
+    vector<Candidate> candidates;
+    set<vector<int> > known(found.begin(), found.end());    // routes and candidates 
+    vector<int> common, banned_moves;
+    while(found.size() < k)
+    {
+        // how long a prefix each route shares with the last one, whose next moves are banned 
+        const vector<int> &last = found.back();
+        common.assign(found.size(), 0);
+        for(int p=0; p<found.size(); p++)
+            while(common[p] < min(found[p].size(), last.size()) && found[p][common[p]] == last[common[p]])
+                common[p]++;
+
+        // spurs from where the last route left its parent on; the earlier ones were tried 
+        // for the parent. The root before the spur cell is banned, so no route loops 
+        banned_stamp++;
+        float root_cost = 0;
+        for(int i=0; i<deviations.back(); i++)
+        {
+            banned[last[i]] = banned_stamp;
+            root_cost += grid.stepCost(last[i], last[i+1]);
+        }
+        for(int i=deviations.back(); i+1<last.size(); i++)
+        {
+            banned_moves.clear();
+            for(int p=0; p<found.size(); p++)
+                if(common[p] > i && found[p].size() > i+1)
+                    banned_moves.push_back(found[p][i+1]);
+            float spur_cost = search(last[i], target, banned_moves, cells);
+            if(spur_cost < INFINITY)
+            {
+                Candidate candidate;
+                candidate.cells.assign(last.begin(), last.begin() + i);
+                candidate.cells.insert(candidate.cells.end(), cells.begin(), cells.end());
+                candidate.cost = root_cost + spur_cost;
+                candidate.deviation = i;
+                if(known.insert(candidate.cells).second)
+                    candidates.push_back(candidate);
+            }
+            banned[last[i]] = banned_stamp;
+            root_cost += grid.stepCost(last[i], last[i+1]);
+        }
+        if(candidates.empty())
+            break;
+
+        int best = 0;
+        for(int c=1; c<candidates.size(); c++)
+            if(candidates[c].cost < candidates[best].cost)
+                best = c;
+        found.push_back(candidates[best].cells);
+        deviations.push_back(candidates[best].deviation);
+        candidates.erase(candidates.begin() + best);
+        addRoute(found.back(), since, counted);
+    }
+    return routes;
+}
+template<class OpenList>
+uint32_t AlternativeRoutes<OpenList>::nextStamp()
+{
+    size_t cells = (size_t)size*size;
+    if(seen.size() < cells)
+    {
+        g.resize(cells);
+        parent.resize(cells);
+        seen.resize(cells, 0);
+        closed.resize(cells, 0);
+    }
+    return ++current_stamp;
+}
+template<class OpenList>
+string AlternativeRoutes<OpenList>::report() const
+{
+    ostringstream out;
+    if(routes.empty())
+        return "No route";
+    out<<routes.size()<<" routes, "<<expansions<<" expansions";
+    if(reuse_tree)
+        out<<", tree of "<<tree_builds<<(tree_builds == 1 ? " build" : " builds")<<" (last "<<tree_ms<<" ms)";
+    out<<endl;
+    for(int r=0; r<routes.size(); r++)
+    {
+        out<<"  "<<r+1<<". cost "<<routes[r].cost;
+        if(r > 0)
+            out<<" (+"<<max(0.0f, 100*(routes[r].cost/max(1e-6f, routes[0].cost) - 1))<<"%), "<<100*routes[r].overlap<<"% shared";
+        out<<", "<<routes[r].ms<<" ms, "<<routes[r].expansions<<" expanded"<<endl;
+    }
+    return out.str();
+}
+template<class OpenList>
+float AlternativeRoutes<OpenList>::search(int source, int target, const vector<int> &banned_moves, vector<int> &cells)
+{
+    // the tree's own path when nothing on it is banned or penalized, read off without a search 
+    cells.clear();
+    if(reuse_tree && !penalized && to_goal[source] < INFINITY)
+    {
+        bool open = find(banned_moves.begin(), banned_moves.end(), next_hop[source]) == banned_moves.end();
+        for(int cell=next_hop[source]; open && cell != target; cell=next_hop[cell])
+            open = banned[cell] != banned_stamp;
+        if(open)
+        {
+            for(int cell=source; ; cell=next_hop[cell])
+            {
+                cells.push_back(cell);
+                if(cell == target)
+                    break;
+            }
+            return to_goal[source];
+        }
+    }
+
+    // otherwise A* around the bans and penalties, ties towards the goal 
+    uint32_t stamp = nextStamp();
+    OpenList openList;
+    g[source] = 0;
+    parent[source] = source;
+    seen[source] = stamp;
+    openList.push(source, heuristic(source, target), heuristic(source, target));
+    while(!openList.empty())
+    {
+        int curr = openList.pop();
+        if(closed[curr] == stamp)
+            continue;
+        closed[curr] = stamp;
+        expansions++;
+        if(curr == target)
+            break;
+
+        grid.forEachNeighbour(curr, [&](int next, float step) {
+            float h = heuristic(next, target);
+            if(banned[next] == banned_stamp || h == INFINITY
+               || (curr == source && find(banned_moves.begin(), banned_moves.end(), next) != banned_moves.end()))
+                return;
+            float cost = g[curr] + step*(1.0f + extra[next]);
+            if(closed[next] == stamp || (seen[next] == stamp && cost >= g[next]))
+                return;
+            g[next] = cost;
+            parent[next] = curr;
+            seen[next] = stamp;
+            openList.push(next, cost + h, h);
+        });
+    }
+    if(closed[target] != stamp)
+        return INFINITY;
+    for(int cell=target; ; cell=parent[cell])
+    {
+        cells.push_back(cell);
+        if(cell == source)
+            break;
+    }
+    reverse(cells.begin(), cells.end());
+    return g[target];
+}
+template<class OpenList>
+void AlternativeRoutes<OpenList>::setTreeReuse(bool reuse)
+{
+    // off: every search starts from the octile distance, as plain Yen would 
+    reuse_tree = reuse;
+}
+template<class OpenList>
+void AlternativeRoutes<OpenList>::setWall(Position pos, bool wall)
+{
+    // the tree is grown again on the next query 
+    if(pos.row < 0 || pos.col < 0 || pos.row >= size || pos.col >= size || grid.isWalkable(pos.row, pos.col) != wall)
+        return;
+    grid.setWalkable(pos.row, pos.col, !wall);
+    tree_goal = -1;
+}
+
+
+// ParallelBreadthFirstSearch Method definations --> 
+ParallelBreadthFirstSearch::ParallelBreadthFirstSearch(const WalkableBitset &grid) : grid(grid), next_chunk(0)
+{
+    size = grid.getSize();
+    walkable = unvisited = reached = 0;
+    level = levels = bottom_up_levels = 0;
+    bottom_up = done = false;
+}
+void ParallelBreadthFirstSearch::expandBottomUp(int thread)
+{
+    // rows are claimed in chunks; a cell is only written by the thread owning its row, 
+    // but its neighbours are read by others, so all accesses are atomic 
+    const int ROWS = 8;
+    vector<int32_t> &out = next[thread];
+    while(true)
+    {
+        long long lo = next_chunk.fetch_add(ROWS);
+        if(lo >= size)
+            break;
+        int hi = min((long long)size, lo + ROWS);
+        for(int i=lo; i<hi; i++)
+            for(int j=0; j<size; j++)
+            {
+                int cell = i*size + j;
+                if(!grid.isWalkable(i, j) || __atomic_load_n(&distances[cell], __ATOMIC_RELAXED) != -1)
+                    continue;
+                bool found = false;
+                for(int di=-1; di<=1 && !found; di++)
+                    for(int dj=-1; dj<=1 && !found; dj++)
+                        if((di != 0 || dj != 0) && grid.isWalkable(i+di, j+dj)
+                            && __atomic_load_n(&distances[cell + di*size + dj], __ATOMIC_RELAXED) == level)
+                            found = true;
+                if(found)
+                {
+                    __atomic_store_n(&distances[cell], level + 1, __ATOMIC_RELAXED);
+                    out.push_back(cell);
+                }
+            }
+    }
+}
+void ParallelBreadthFirstSearch::expandTopDown(int thread)
+{
+    // a cell joins the next frontier of whichever thread claims it first 
+    const long long CHUNK = 256;
+    vector<int32_t> &out = next[thread];
+    long long count = frontier.size();
+    while(true)
+    {
+        long long lo = next_chunk.fetch_add(CHUNK);
+        if(lo >= count)
+            break;
+        long long hi = min(count, lo + CHUNK);
+        for(long long k=lo; k<hi; k++)
+        {
+            int cell = frontier[k];
+            int i = cell / size, j = cell % size;
+            for(int di=-1; di<=1; di++)
+                for(int dj=-1; dj<=1; dj++)
+                {
+                    if((di == 0 && dj == 0) || !grid.isWalkable(i+di, j+dj))
+                        continue;
+                    int32_t *slot = &distances[cell + di*size + dj];
+                    int32_t unseen = -1;
+                    if(__atomic_load_n(slot, __ATOMIC_RELAXED) == -1
+                        && __atomic_compare_exchange_n(slot, &unseen, level + 1, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                        out.push_back(cell + di*size + dj);
+                }
+        }
+    }
+}
+int ParallelBreadthFirstSearch::getBottomUpLevels() const
+{
+    return bottom_up_levels;
+}
+const vector<int32_t>& ParallelBreadthFirstSearch::getDistances() const
+{
+    return distances;
+}
+int ParallelBreadthFirstSearch::getLevels() const
+{
+    return levels;
+}
+long long ParallelBreadthFirstSearch::getReached() const
+{
+    return reached;
+}
+void ParallelBreadthFirstSearch::planLevel()
+{
+    // runs on one thread between levels: lays out the next frontier and picks its direction 
+    size_t total = 0;
+    for(int t=0; t<next.size(); t++)
+    {
+        offsets[t] = total;
+        total += next[t].size();
+    }
+    levels++;
+    if(bottom_up)
+        bottom_up_levels++;
+    reached += total;
+    unvisited -= total;
+    if(total == 0)
+    {
+        done = true;
+        return;
+    }
+
+    // the degree is near uniform, so cell counts stand in for Beamer's edge counts 
+    bool growing = total > frontier.size();
+    if(!bottom_up)
+        bottom_up = growing && (long long)total > unvisited / ALPHA;
+    else
+        bottom_up = growing || (long long)total > walkable / BETA;
+
+    frontier.resize(total);
+    level++;
+    next_chunk = 0;
+}
+void ParallelBreadthFirstSearch::run(Position source, int threads)
+{
+    int thread_count = threads > 0 ? threads : max(1u, thread::hardware_concurrency());
+    distances.assign((size_t)size*size, -1);
+    frontier.clear();
+    levels = bottom_up_levels = 0;
+    reached = 0;
+    if(!grid.isWalkable(source.row, source.col))
+        return;
+
+    int cell = source.row*size + source.col;
+    distances[cell] = 0;
+    frontier.push_back(cell);
+    walkable = grid.countWalkable();
+    unvisited = walkable - 1;
+    reached = 1;
+    level = 0;
+    bottom_up = done = false;
+    next.assign(thread_count, vector<int32_t>());
+    offsets.assign(thread_count, 0);
+    next_chunk = 0;
+
+    // one team for the whole search, synchronised by a barrier between levels 
+    ThreadBarrier barrier(thread_count);
+    vector<thread> team;
+    for(int t=1; t<thread_count; t++)
+        team.emplace_back(&ParallelBreadthFirstSearch::work, this, t, ref(barrier));
+    work(0, barrier);
+    for(int t=0; t<team.size(); t++)
+        team[t].join();
+}
+void ParallelBreadthFirstSearch::work(int thread, ThreadBarrier &barrier)
+{
+    while(true)
+    {
+        if(bottom_up)
+            expandBottomUp(thread);
+        else
+            expandTopDown(thread);
+        barrier.wait();
+
+        if(thread == 0)
+            planLevel();
+        barrier.wait();
+        if(done)
+            break;
+
+        // every thread copies its own buffer into the next frontier 
+        copy(next[thread].begin(), next[thread].end(), frontier.begin() + offsets[thread]);
+        next[thread].clear();
+        barrier.wait();
+    }
+}
+
+
+// Bounds Method definations -->
+Bounds::Bounds()
+{
+    top = left = INT_MAX;
+    bottom = right = INT_MIN;
+}
+bool Bounds::contains(Position pos, int margin) const
+{
+    return pos.row >= top-margin && pos.row <= bottom+margin && pos.col >= left-margin && pos.col <= right+margin;
+}
+void Bounds::include(Position pos)
+{
+    top = min(top, pos.row);
+    left = min(left, pos.col);
+    bottom = max(bottom, pos.row);
+    right = max(right, pos.col);
+}
+bool Bounds::isEmpty() const
+{
+    return top > bottom;
+}
+
+// PathQuery Method definations -->
+PathQuery::PathQuery(Position start, Position end, int algorithm, bool diagonal)
+{
+    this->start = start;
+    this->end = end;
+    this->algorithm = algorithm;
+    this->diagonal = diagonal;
+}
+bool PathQuery::operator == (const PathQuery &other) const
+{
+    return start.row == other.start.row && start.col == other.start.col && end.row == other.end.row
+        && end.col == other.end.col && algorithm == other.algorithm && diagonal == other.diagonal;
+}
+size_t PathQueryHashFunction::operator() (const PathQuery &query) const
+{
+    uint64_t key = ((uint64_t)(uint32_t)query.start.row << 48) ^ ((uint64_t)(uint32_t)query.start.col << 32)
+                 ^ ((uint64_t)(uint32_t)query.end.row << 16) ^ (uint64_t)(uint32_t)query.end.col;
+    key = key * 0x9E3779B97F4A7C15ULL + query.algorithm*2 + query.diagonal;
+    return key ^ (key >> 29);
+}
+
+// CompactPath Method definations -->
+const int CompactPath::DROW[8] = {-1, -1, 0, 1, 1, 1, 0, -1};
+const int CompactPath::DCOL[8] = {0, 1, 1, 1, 0, -1, -1, -1};
+CompactPath::CompactPath()
+{
+    clear();
+}
+CompactPath::CompactPath(const vector<Position> &path)
+{
+    clear();
+    for(int k=0; k<path.size(); k++)
+        append(path[k]);
+}
+void CompactPath::append(Position pos)
+{
+    if(length == 0)
+    {
+        start = last = pos;
+        length = 1;
+        return;
+    }
+
+    int drow = pos.row - last.row, dcol = pos.col - last.col;
+    int direction = directionOf(drow, dcol);
+    if(direction < 0)
+    {
+        int16_t offsets[2] = {(int16_t)drow, (int16_t)dcol};
+        runs.push_back(0);
+        runs.insert(runs.end(), (const uint8_t*)offsets, (const uint8_t*)offsets + sizeof(offsets));
+        last_run = -1;
+    }
+    else if(last_run >= 0 && (runs[last_run] & 7) == direction && (runs[last_run] >> 3) < MAX_RUN)
+        runs[last_run] += 8;
+    else
+    {
+        last_run = runs.size();
+        runs.push_back(8 | direction);
+    }
+    last = pos;
+    length++;
+}
+CompactPath::Iterator CompactPath::begin() const
+{
+    return Iterator(runs.empty() ? NULL : &runs[0], 0, length, start);
+}
+void CompactPath::clear()
+{
+    start = last = Position();
+    length = 0;
+    last_run = -1;
+    runs.clear();
+}
+bool CompactPath::decode(const uint8_t *data, size_t bytes)
+{
+    // header, then runs that have to add up to length - 1 steps 
+    clear();
+    if(bytes < HEADER_BYTES)
+        return false;
+    uint16_t row, col;
+    uint32_t count;
+    memcpy(&row, data, 2);
+    memcpy(&col, data + 2, 2);
+    memcpy(&count, data + 4, 4);
+    runs.assign(data + HEADER_BYTES, data + bytes);
+
+    long long steps = 0;
+    Position pos(row, col);
+    for(size_t offset=0; offset<runs.size(); )
+    {
+        int run = runs[offset] >> 3, direction = runs[offset] & 7;
+        if(run == 0)
+        {
+            if(offset + 5 > runs.size())
+                break;
+            int16_t offsets[2];
+            memcpy(offsets, &runs[offset + 1], sizeof(offsets));
+            pos.row += offsets[0];
+            pos.col += offsets[1];
+            last_run = -1;
+            steps++;
+            offset += 5;
+        }
+        else
+        {
+            pos.row += run*DROW[direction];
+            pos.col += run*DCOL[direction];
+            last_run = offset;
+            steps += run;
+            offset++;
+        }
+    }
+    if(count == 0 ? !runs.empty() : steps != (long long)count - 1)
+    {
+        clear();
+        return false;
+    }
+    if(count > 0)
+    {
+        start = Position(row, col);
+        last = pos;
+        length = count;
+    }
+    return true;
+}
+int CompactPath::directionOf(int drow, int dcol)
+{
+    if(abs(drow) > 1 || abs(dcol) > 1 || (drow == 0 && dcol == 0))
+        return -1;
+    for(int d=0; d<8; d++)
+        if(DROW[d] == drow && DCOL[d] == dcol)
+            return d;
+    return -1;
+}
+bool CompactPath::empty() const
+{
+    return length == 0;
+}
+void CompactPath::encode(string &out) const
+{
+    // appends, so a response header can already be in out 
+    uint16_t row = length > 0 ? start.row : 0, col = length > 0 ? start.col : 0;
+    uint32_t count = length;
+    out.append((const char*)&row, 2);
+    out.append((const char*)&col, 2);
+    out.append((const char*)&count, 4);
+    if(!runs.empty())
+        out.append((const char*)&runs[0], runs.size());
+}
+CompactPath::Iterator CompactPath::end() const
+{
+    return Iterator(NULL, length, length, last);
+}
+size_t CompactPath::getByteSize() const
+{
+    return HEADER_BYTES + runs.size();
+}
+Position CompactPath::getEnd() const
+{
+    return last;
+}
+float CompactPath::getLength() const
+{
+    // a run costs its steps, times sqrt(2) when diagonal; jumps are straight segments 
+    float length = 0;
+    for(size_t offset=0; offset<runs.size(); )
+    {
+        int run = runs[offset] >> 3, direction = runs[offset] & 7;
+        if(run == 0)
+        {
+            int16_t offsets[2];
+            memcpy(offsets, &runs[offset + 1], sizeof(offsets));
+            length += sqrtf((float)offsets[0]*offsets[0] + (float)offsets[1]*offsets[1]);
+            offset += 5;
+        }
+        else
+        {
+            length += (direction & 1) ? run*sqrtf(2.0f) : run;
+            offset++;
+        }
+    }
+    return length;
+}
+Position CompactPath::getStart() const
+{
+    return start;
+}
+bool CompactPath::load(const string &file)
+{
+    ifstream in(file.c_str(), ios::binary);
+    char magic[8];
+    if(!in || !in.read(magic, 8) || memcmp(magic, "CPATH001", 8) != 0)
+        return false;
+    string data((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    return decode((const uint8_t*)data.data(), data.size());
+}
+void CompactPath::reverse()
+{
+    // each entry lands mirrored at the other end of the buffer, with its move turned around 
+    if(length <= 1)
+        return;
+    vector<uint8_t> reversed(runs.size());
+    for(size_t offset=0; offset<runs.size(); )
+    {
+        size_t bytes = (runs[offset] >> 3) == 0 ? 5 : 1;
+        uint8_t *out = &reversed[runs.size() - offset - bytes];
+        if(bytes == 1)
+            out[0] = (runs[offset] & ~7) | ((runs[offset] + 4) & 7);
+        else
+        {
+            int16_t offsets[2];
+            memcpy(offsets, &runs[offset + 1], sizeof(offsets));
+            offsets[0] = -offsets[0];
+            offsets[1] = -offsets[1];
+            out[0] = 0;
+            memcpy(out + 1, offsets, sizeof(offsets));
+        }
+        offset += bytes;
+    }
+    last_run = (runs[0] >> 3) != 0 ? (int)runs.size() - 1 : -1;
+    runs.swap(reversed);
+    swap(start, last);
+}
+bool CompactPath::save(const string &file) const
+{
+    string data = "CPATH001";
+    encode(data);
+    ofstream out(file.c_str(), ios::binary);
+    return out.write(data.data(), data.size()) ? true : false;
+}
+int CompactPath::size() const
+{
+    return length;
+}
+vector<Position> CompactPath::toVector() const
+{
+    vector<Position> path;
+    path.reserve(length);
+    for(Iterator it=begin(); it!=end(); ++it)
+        path.push_back(*it);
+    return path;
+}
+
+// CompactPath::Iterator Method definations -->
+CompactPath::Iterator::Iterator(const uint8_t *runs, int index, int length, Position pos)
+{
+    this->runs = runs;
+    this->index = index;
+    this->length = length;
+    this->pos = pos;
+    offset = 0;
+    left = direction = 0;
+}
+bool CompactPath::Iterator::operator != (const Iterator &other) const
+{
+    return index != other.index;
+}
+const Position& CompactPath::Iterator::operator * () const
+{
+    return pos;
+}
+CompactPath::Iterator& CompactPath::Iterator::operator ++ ()
+{
+    if(++index >= length)
+        return *this;
+    if(left == 0)
+    {
+        uint8_t run = runs[offset++];
+        if((run >> 3) == 0)
+        {
+            int16_t offsets[2];
+            memcpy(offsets, runs + offset, sizeof(offsets));
+            offset += sizeof(offsets);
+            pos.row += offsets[0];
+            pos.col += offsets[1];
+            return *this;
+        }
+        direction = run & 7;
+        left = run >> 3;
+    }
+    pos.row += DROW[direction];
+    pos.col += DCOL[direction];
+    left--;
+    return *this;
+}
+
+// PathCache Method definations -->
+PathCache::PathCache(size_t budget_bytes)
+{
+    budget = budget_bytes;
+    bytes = 0;
+    hits = misses = invalidations = evictions = 0;
+}
+void PathCache::clear()
+{
+    invalidations += entries.size();
+    entries.clear();
+    index.clear();
+    bytes = 0;
+}
+void PathCache::display() const
+{
+    cout<<"Path cache: "<<entries.size()<<" entries, "<<bytes<<"/"<<budget<<" bytes, "
+        <<hits<<" hits, "<<misses<<" misses, "<<invalidations<<" invalidations, "<<evictions<<" evictions"<<endl;
+}
+void PathCache::erase(list<Entry>::iterator it)
+{
+    bytes -= it->bytes;
+    index.erase(it->query);
+    entries.erase(it);
+}
+size_t PathCache::getBytes() const
+{
+    return bytes;
+}
+long long PathCache::getEvictions() const
+{
+    return evictions;
+}
+long long PathCache::getHits() const
+{
+    return hits;
+}
+long long PathCache::getInvalidations() const
+{
+    return invalidations;
+}
+long long PathCache::getMisses() const
+{
+    return misses;
+}
+const PathCache::Entry* PathCache::lookup(const PathQuery &query, uint64_t version)
+{
+    unordered_map<PathQuery, list<Entry>::iterator, PathQueryHashFunction>::iterator it = index.find(query);
+    if(it == index.end())
+    {
+        misses++;
+        return NULL;
+    }
+
+    // an entry from an older board the edit hooks did not see 
+    if(it->second->version != version)
+    {
+        invalidations++;
+        misses++;
+        erase(it->second);
+        return NULL;
+    }
+
+    hits++;
+    entries.splice(entries.begin(), entries, it->second);
+    return &entries.front();
+}
+void PathCache::onWallInserted(Position pos, uint64_t version)
+{
+    for(list<Entry>::iterator it=entries.begin(); it!=entries.end(); )
+    {
+        list<Entry>::iterator curr = it++;
+        bool on_path = false;
+        if(curr->path_bounds.contains(pos))
+        {
+            // any-angle entries keep waypoints only, their segments may cross pos 
+            bool any_angle = curr->query.algorithm == THETA_STAR_SEARCH || curr->query.algorithm == LAZY_THETA_STAR_SEARCH;
+            on_path = any_angle;
+            for(CompactPath::Iterator cell=curr->path.begin(); cell!=curr->path.end() && !on_path; ++cell)
+                on_path = (*cell).row == pos.row && (*cell).col == pos.col;
+        }
+
+        if(on_path)
+        {
+            invalidations++;
+            erase(curr);
+        }
+        else
+            curr->version = version;
+    }
+}
+void PathCache::onWallRemoved(Position pos, uint64_t version)
+{
+    for(list<Entry>::iterator it=entries.begin(); it!=entries.end(); )
+    {
+        list<Entry>::iterator curr = it++;
+        if(curr->explored_bounds.isEmpty() || curr->explored_bounds.contains(pos, 1))
+        {
+            invalidations++;
+            erase(curr);
+        }
+        else
+            curr->version = version;
+    }
+}
+void PathCache::setBudget(size_t budget_bytes)
+{
+    budget = budget_bytes;
+    while(bytes > budget && !entries.empty())
+    {
+        evictions++;
+        erase(--entries.end());
+    }
+}
+void PathCache::store(const PathQuery &query, uint64_t version, const vector<Position> &path, const Bounds &explored)
+{
+    unordered_map<PathQuery, list<Entry>::iterator, PathQueryHashFunction>::iterator it = index.find(query);
+    if(it != index.end())
+        erase(it->second);
+
+    Entry entry;
+    entry.query = query;
+    entry.path = CompactPath(path);
+    entry.explored_bounds = explored;
+    for(int k=0; k<path.size(); k++)
+        entry.path_bounds.include(path[k]);
+    entry.version = version;
+    entry.bytes = sizeof(Entry) + entry.path.getByteSize() + 4*sizeof(void*);
+    if(entry.bytes > budget)
+        return;
+
+    entries.push_front(entry);
+    index[query] = entries.begin();
+    bytes += entry.bytes;
+
+    // evict least recently used entries until the budget holds 
+    while(bytes > budget)
+    {
+        evictions++;
+        erase(--entries.end());
+    }
+}
+
+
+// OpenListEntry Method definations -->
+template<typename Item>
+bool OpenListEntry<Item>::operator < (const OpenListEntry &other) const
+{
+    if(key != other.key)
+        return key < other.key;
+    return tie < other.tie;
+}
+
+// DAryHeapOpenList Method definations -->
+template<typename Item, int D>
+void DAryHeapOpenList<Item, D>::clear()
+{
+    heap.clear();
+}
+template<typename Item, int D>
+bool DAryHeapOpenList<Item, D>::empty() const
+{
+    return heap.empty();
+}
+template<typename Item, int D>
+Item DAryHeapOpenList<Item, D>::pop()
+{
+    TRACE_SAMPLE("open list pop");
+    Item top = heap[0].item;
+    OpenListEntry<Item> last = heap.back();
+    heap.pop_back();
+    if(heap.empty())
+        return top;
+
+    // sift the last entry down from the root 
+    size_t hole = 0;
+    while(true)
+    {
+        size_t first = hole*D + 1;
+        if(first >= heap.size())
+            break;
+        size_t best = first;
+        for(size_t k=first+1; k<min(first+D, heap.size()); k++)
+            if(heap[k] < heap[best])
+                best = k;
+        if(!(heap[best] < last))
+            break;
+        heap[hole] = heap[best];
+        hole = best;
+    }
+    heap[hole] = last;
+    return top;
+}
+template<typename Item, int D>
+void DAryHeapOpenList<Item, D>::push(const Item &item, float key, float tie)
+{
+    TRACE_SAMPLE("open list push");
+    OpenListEntry<Item> entry = {item, key, tie};
+    size_t hole = heap.size();
+    heap.push_back(entry);
+    while(hole > 0)
+    {
+        size_t parent = (hole-1) / D;
+        if(!(entry < heap[parent]))
+            break;
+        heap[hole] = heap[parent];
+        hole = parent;
+    }
+    heap[hole] = entry;
+}
+template<typename Item, int D>
+template<typename Function>
+void DAryHeapOpenList<Item, D>::forEach(Function fn) const
+{
+    for(size_t k=0; k<heap.size(); k++)
+        fn(heap[k].item);
+}
+template<typename Item, int D>
+size_t DAryHeapOpenList<Item, D>::size() const
+{
+    return heap.size();
+}
+
+// PairingHeapOpenList Method definations -->
+template<typename Item>
+PairingHeapOpenList<Item>::PairingHeapOpenList()
+{
+    root = -1;
+    count = 0;
+}
+template<typename Item>
+void PairingHeapOpenList<Item>::clear()
+{
+    nodes.clear();
+    free_nodes.clear();
+    root = -1;
+    count = 0;
+}
+template<typename Item>
+bool PairingHeapOpenList<Item>::empty() const
+{
+    return count == 0;
+}
+template<typename Item>
+template<typename Function>
+void PairingHeapOpenList<Item>::forEach(Function fn) const
+{
+    // the tree from the root, recycled nodes are not in it 
+    vector<int> pending;
+    if(root >= 0)
+        pending.push_back(root);
+    while(!pending.empty())
+    {
+        int node = pending.back();
+        pending.pop_back();
+        fn(nodes[node].entry.item);
+        if(nodes[node].child >= 0)
+            pending.push_back(nodes[node].child);
+        if(nodes[node].sibling >= 0)
+            pending.push_back(nodes[node].sibling);
+    }
+}
+template<typename Item>
+int PairingHeapOpenList<Item>::meld(int a, int b)
+{
+    if(a < 0)
+        return b;
+    if(b < 0)
+        return a;
+    if(nodes[b].entry < nodes[a].entry)
+        swap(a, b);
+    nodes[b].sibling = nodes[a].child;
+    nodes[a].child = b;
+    return a;
+}
+template<typename Item>
+Item PairingHeapOpenList<Item>::pop()
+{
+    TRACE_SAMPLE("open list pop");
+    int old_root = root;
+    Item top = nodes[old_root].entry.item;
+    free_nodes.push_back(old_root);
+    count--;
+
+    // two pass merge: meld children pairwise left to right, then fold right to left 
+    pairs.clear();
+    for(int child=nodes[old_root].child; child>=0; )
+    {
+        int first = child, second = nodes[first].sibling;
+        child = second >= 0 ? nodes[second].sibling : -1;
+        nodes[first].sibling = -1;
+        if(second >= 0)
+            nodes[second].sibling = -1;
+        pairs.push_back(meld(first, second));
+    }
+    root = -1;
+    for(int k=(int)pairs.size()-1; k>=0; k--)
+        root = meld(pairs[k], root);
+    return top;
+}
+template<typename Item>
+void PairingHeapOpenList<Item>::push(const Item &item, float key, float tie)
+{
+    TRACE_SAMPLE("open list push");
+    HeapNode node = {{item, key, tie}, -1, -1};
+    int index;
+    if(!free_nodes.empty())
+    {
+        index = free_nodes.back();
+        free_nodes.pop_back();
+        nodes[index] = node;
+    }
+    else
+    {
+        index = nodes.size();
+        nodes.push_back(node);
+    }
+    root = meld(root, index);
+    count++;
+}
+template<typename Item>
+size_t PairingHeapOpenList<Item>::size() const
+{
+    return count;
+}
+
+// RadixHeapOpenList Method definations -->
+template<typename Item>
+RadixHeapOpenList<Item>::RadixHeapOpenList()
+{
+    last = 0;
+    count = 0;
+}
+template<typename Item>
+int RadixHeapOpenList<Item>::bucketOf(uint32_t key, uint32_t last)
+{
+    // bucket = position of the highest bit where key differs from the last popped key 
+    return key == last ? 0 : 32 - __builtin_clz(key ^ last);
+}
+template<typename Item>
+void RadixHeapOpenList<Item>::clear()
+{
+    for(int b=0; b<33; b++)
+    {
+        buckets[b].clear();
+        bucket_keys[b].clear();
+    }
+    last = 0;
+    count = 0;
+}
+template<typename Item>
+bool RadixHeapOpenList<Item>::empty() const
+{
+    return count == 0;
+}
+template<typename Item>
+template<typename Function>
+void RadixHeapOpenList<Item>::forEach(Function fn) const
+{
+    for(int b=0; b<33; b++)
+        for(size_t k=0; k<buckets[b].size(); k++)
+            fn(buckets[b][k].item);
+}
+template<typename Item>
+Item RadixHeapOpenList<Item>::pop()
+{
+    TRACE_SAMPLE("open list pop");
+    if(buckets[0].empty())
+    {
+        // move the smallest non empty bucket down, relative to its minimum 
+        int b = 1;
+        while(buckets[b].empty())
+            b++;
+        last = *min_element(bucket_keys[b].begin(), bucket_keys[b].end());
+        for(size_t k=0; k<buckets[b].size(); k++)
         {
-            retracePath();
-            result.setSuccess();
-            return true;
+            int target = bucketOf(bucket_keys[b][k], last);
+            buckets[target].push_back(buckets[b][k]);
+            bucket_keys[target].push_back(bucket_keys[b][k]);
         }
-        
-        // update its neighbours
-        updateNeighbourCost(curr);
-
-        // push its neighbours 
-        vector<NodeHandle> neighbours = getNeighbours(curr);
-        for(int i=0; i<neighbours.size(); i++)
-        {            
-            if(!neighbours[i].isWalkable() || open.find(neighbours[i]) != open.end() || neighbours[i].isExplored())
-                continue;
-            
-            que.push(neighbours[i]);
-            open.insert(neighbours[i]);
+        buckets[b].clear();
+        bucket_keys[b].clear();
+    }
+
+    Item top = buckets[0].back().item;
+    buckets[0].pop_back();
+    bucket_keys[0].pop_back();
+    count--;
+    return top;
+}
+template<typename Item>
+void RadixHeapOpenList<Item>::push(const Item &item, float key, float tie)
+{
+    TRACE_SAMPLE("open list push");
+    uint32_t quantized = max(quantize(key), last);
+    int b = bucketOf(quantized, last);
+    OpenListEntry<Item> entry = {item, key, tie};
+    buckets[b].push_back(entry);
+    bucket_keys[b].push_back(quantized);
+    count++;
+}
+template<typename Item>
+uint32_t RadixHeapOpenList<Item>::quantize(float key)
+{
+    return key <= 0 ? 0 : (uint32_t)min(key*256.0f, 4.0e9f);
+}
+template<typename Item>
+size_t RadixHeapOpenList<Item>::size() const
+{
+    return count;
+}
+
+// BucketQueueOpenList Method definations -->
+template<typename Item>
+BucketQueueOpenList<Item>::BucketQueueOpenList()
+{
+    cursor = count = 0;
+}
+template<typename Item>
+void BucketQueueOpenList<Item>::clear()
+{
+    buckets.clear();
+    cursor = count = 0;
+}
+template<typename Item>
+bool BucketQueueOpenList<Item>::empty() const
+{
+    return count == 0;
+}
+template<typename Item>
+template<typename Function>
+void BucketQueueOpenList<Item>::forEach(Function fn) const
+{
+    for(size_t b=cursor; b<buckets.size(); b++)
+        for(size_t k=0; k<buckets[b].size(); k++)
+            fn(buckets[b][k]);
+}
+template<typename Item>
+Item BucketQueueOpenList<Item>::pop()
+{
+    TRACE_SAMPLE("open list pop");
+    while(buckets[cursor].empty())
+        cursor++;
+    Item top = buckets[cursor].back();
+    buckets[cursor].pop_back();
+    count--;
+    return top;
+}
+template<typename Item>
+void BucketQueueOpenList<Item>::push(const Item &item, float key, float)
+{
+    TRACE_SAMPLE("open list push");
+    size_t bucket = key <= 0 ? 0 : (size_t)(key*16.0f);
+    bucket = max(bucket, cursor);
+    if(bucket >= buckets.size())
+        buckets.resize(bucket+1);
+    buckets[bucket].push_back(item);
+    count++;
+}
+template<typename Item>
+size_t BucketQueueOpenList<Item>::size() const
+{
+    return count;
+}
+
+// TwoLevelBucketOpenList Method definations -->
+template<typename Item>
+TwoLevelBucketOpenList<Item>::TwoLevelBucketOpenList()
+{
+    coarse_cursor = fine_cursor = count = 0;
+}
+template<typename Item>
+void TwoLevelBucketOpenList<Item>::clear()
+{
+    coarse.clear();
+    for(int k=0; k<64; k++)
+        fine[k].clear();
+    coarse_cursor = fine_cursor = count = 0;
+}
+template<typename Item>
+bool TwoLevelBucketOpenList<Item>::empty() const
+{
+    return count == 0;
+}
+template<typename Item>
+template<typename Function>
+void TwoLevelBucketOpenList<Item>::forEach(Function fn) const
+{
+    for(int f=0; f<64; f++)
+        for(size_t k=0; k<fine[f].size(); k++)
+            fn(fine[f][k]);
+    for(size_t c=0; c<coarse.size(); c++)
+        for(size_t k=0; k<coarse[c].size(); k++)
+            fn(coarse[c][k].second);
+}
+template<typename Item>
+Item TwoLevelBucketOpenList<Item>::pop()
+{
+    TRACE_SAMPLE("open list pop");
+    while(true)
+    {
+        while(fine_cursor < 64 && fine[fine_cursor].empty())
+            fine_cursor++;
+        if(fine_cursor < 64)
+            break;
+
+        // the current coarse bucket is used up, split the next non empty one 
+        coarse_cursor++;
+        while(coarse_cursor < coarse.size() && coarse[coarse_cursor].empty())
+            coarse_cursor++;
+        fine_cursor = 0;
+        if(coarse_cursor < coarse.size())
+        {
+            vector<pair<uint32_t, Item> > &bucket = coarse[coarse_cursor];
+            for(size_t k=0; k<bucket.size(); k++)
+                fine[bucket[k].first & 63].push_back(bucket[k].second);
+            bucket.clear();
         }
-        
-    }    
+    }
 
-    result.setFailure();
-    return false;
+    Item top = fine[fine_cursor].back();
+    fine[fine_cursor].pop_back();
+    count--;
+    return top;
 }
+template<typename Item>
+void TwoLevelBucketOpenList<Item>::push(const Item &item, float key, float)
+{
+    TRACE_SAMPLE("open list push");
+    uint32_t quantized = key <= 0 ? 0 : (uint32_t)min(key*16.0f, 4.0e9f);
+    size_t coarse_index = quantized >> 6;
 
-void Game::display()
+    // keys behind the cursor are clamped to it 
+    if(coarse_index < coarse_cursor || (coarse_index == coarse_cursor && (quantized & 63) < fine_cursor))
+    {
+        coarse_index = coarse_cursor;
+        quantized = (uint32_t)(coarse_cursor << 6) | fine_cursor;
+    }
+
+    if(coarse_index == coarse_cursor)
+        fine[quantized & 63].push_back(item);
+    else
+    {
+        if(coarse_index >= coarse.size())
+            coarse.resize(coarse_index+1);
+        coarse[coarse_index].push_back(make_pair(quantized, item));
+    }
+    count++;
+}
+template<typename Item>
+size_t TwoLevelBucketOpenList<Item>::size() const
 {
-    // Create a buffer 
-    char **buffer = new char*[size];
-    for(int i=0; i<size; i++)
+    return count;
+}
+
+
+// Terminal Method definations --> 
+Terminal::Terminal()
+{
+    raw = false;
+    closed = false;
+    interactive = isatty(STDIN_FILENO) && tcgetattr(STDIN_FILENO, &original) == 0;
+}
+Terminal::~Terminal()
+{
+    setRawMode(false);
+}
+void Terminal::clearScreen()
+{
+    // home, clear, drop the scrollback 
+    static const char sequence[] = "\033[H\033[2J\033[3J";
+    cout<<sequence<<flush;
+}
+void Terminal::getSize(int &rows, int &cols)
+{
+    // the size of the window stdout is drawn in, 24x80 when it is not a terminal 
+    winsize window;
+    if(ioctl(STDOUT_FILENO, TIOCGWINSZ, &window) == 0 && window.ws_row > 0 && window.ws_col > 0)
+    {
+        rows = window.ws_row;
+        cols = window.ws_col;
+        return;
+    }
+    rows = 24;
+    cols = 80;
+}
+bool Terminal::isClosed() const
+{
+    return closed;
+}
+int Terminal::readKey(int timeout_ms)
+{
+    // -1 on timeout or once stdin is closed 
+    if(closed)
+        return -1;
+    cout<<flush;
+    setRawMode(true);
+    if(timeout_ms >= 0 && !(waitForInput(-1, timeout_ms) & KEY_READY))
+        return -1;
+
+    unsigned char key;
+    ssize_t n;
+    do
+        n = read(STDIN_FILENO, &key, 1);
+    while(n < 0 && errno == EINTR);
+    if(n <= 0)
+    {
+        closed = true;
+        return -1;
+    }
+    return key;
+}
+void Terminal::setRawMode(bool enable)
+{
+    if(!interactive || raw == enable)
+        return;
+
+    // keep output processing and signals so printing and Ctrl-C behave as before 
+    termios mode = original;
+    if(enable)
+    {
+        mode.c_lflag &= ~(ICANON | ECHO);
+        mode.c_cc[VMIN] = 1;
+        mode.c_cc[VTIME] = 0;
+    }
+    tcsetattr(STDIN_FILENO, TCSANOW, &mode);
+    raw = enable;
+}
+int Terminal::waitForInput(int fd, int timeout_ms)
+{
+    // returns a mask of KEY_READY and FD_READY, 0 on timeout 
+    pollfd fds[2];
+    int count = 0, key_slot = -1, fd_slot = -1;
+    if(!closed)
+    {
+        fds[count].fd = STDIN_FILENO;
+        fds[count].events = POLLIN;
+        key_slot = count++;
+    }
+    if(fd >= 0)
     {
-        buffer[i] = new char[size];
+        fds[count].fd = fd;
+        fds[count].events = POLLIN;
+        fd_slot = count++;
     }
+    if(count == 0 || poll(fds, count, timeout_ms) <= 0)
+        return 0;
+
+    // a hang up on stdin is reported as a key so the read sees the EOF 
+    int mask = 0;
+    if(key_slot >= 0 && (fds[key_slot].revents & (POLLIN | POLLHUP | POLLERR)))
+        mask |= KEY_READY;
+    if(fd_slot >= 0 && (fds[fd_slot].revents & (POLLIN | POLLHUP)))
+        mask |= FD_READY;
+    return mask;
+}
+
 
-    // Set the buffer
-    cout<<"\t***Game Board***\t"<<endl;
+// TileSummary Method definations --> 
+constexpr int TileSummary::TILE;
+TileSummary::TileSummary(int size)
+{
+    this->size = size;
+    tiles_per_row = (size + TILE - 1) / TILE;
+    counts.assign((size_t)tiles_per_row*tiles_per_row*MARKS, 0);
+}
+void TileSummary::add(Position pos, Mark mark, int delta)
+{
+    counts[((size_t)(pos.row/TILE)*tiles_per_row + pos.col/TILE)*MARKS + mark] += delta;
+}
+void TileSummary::clear(Mark mark)
+{
+    for(size_t k=mark; k<counts.size(); k+=MARKS)
+        counts[k] = 0;
+}
+int TileSummary::getTilesPerRow() const
+{
+    return tiles_per_row;
+}
+void TileSummary::rebuild(const Board &board)
+{
+    // after the whole board changed at once 
+    counts.assign(counts.size(), 0);
     for(int i=0; i<size; i++)
     {
         for(int j=0; j<size; j++)
         {
-            buffer[i][j] = board[i][j].isWalkable() ? SYMBOL_EMPTY : SYMBOL_WALL;
+            NodeHandle cell = board[i][j];
+            if(!cell.isWalkable())
+                add(Position(i, j), WALL, 1);
+            if(cell.isExplored())
+                add(Position(i, j), EXPLORED, 1);
+            if(cell.isVisited())
+                add(Position(i, j), VISITED, 1);
+        }
+    }
+}
+TileSummary::Counts TileSummary::sum(int tile_top, int tile_left, int tile_bottom, int tile_right) const
+{
+    // tiles [tile_top, tile_bottom) x [tile_left, tile_right), edge tiles hold fewer cells 
+    Counts total;
+    total.cells = (long long)(min(size, tile_bottom*TILE) - tile_top*TILE) * (min(size, tile_right*TILE) - tile_left*TILE);
+    for(int m=0; m<MARKS; m++)
+        total.marks[m] = 0;
+    for(int i=tile_top; i<tile_bottom; i++)
+    {
+        const uint16_t *tile = &counts[((size_t)i*tiles_per_row + tile_left)*MARKS];
+        for(int j=tile_left; j<tile_right; j++, tile+=MARKS)
+            for(int m=0; m<MARKS; m++)
+                total.marks[m] += tile[m];
+    }
+    return total;
+}
+
+
+// Viewport Method definations --> 
+// std::min and std::max take references, so the constants need a definition before C++17 
+constexpr int Viewport::WHOLE, Viewport::MIN_CELLS, Viewport::MARGIN, Viewport::RESERVED_ROWS;
+Viewport::Viewport(int size)
+{
+    this->size = size;
+    tiles_per_row = (size + TileSummary::TILE - 1) / TileSummary::TILE;
+    top = left = 0;
+    rows = cols = size;
+    blocks = 0;
+}
+bool Viewport::contains(Position pos) const
+{
+    return pos.row >= top && pos.row < top + rows && pos.col >= left && pos.col < left + cols;
+}
+void Viewport::fit(int terminal_rows, int terminal_cols)
+{
+    // every cell takes two columns, and so does every minimap block 
+    int board_rows = terminal_rows - RESERVED_ROWS;
+    if(size <= WHOLE || (size <= board_rows && 2*size <= terminal_cols))
+    {
+        top = left = 0;
+        rows = cols = size;
+        blocks = 0;
+        return;
+    }
+    rows = min(size, max(MIN_CELLS, board_rows));
+    blocks = min(rows, tiles_per_row);
+    cols = min(size, max(MIN_CELLS, (terminal_cols - 2*blocks - 2) / 2));
+    scroll();
+}
+void Viewport::follow(Position focus)
+{
+    this->focus = focus;
+    scroll();
+}
+int Viewport::getBlocks() const
+{
+    return blocks;
+}
+int Viewport::getCols() const
+{
+    return cols;
+}
+int Viewport::getLeft() const
+{
+    return left;
+}
+int Viewport::getRows() const
+{
+    return rows;
+}
+int Viewport::getTop() const
+{
+    return top;
+}
+bool Viewport::isWhole() const
+{
+    return rows == size && cols == size;
+}
+void Viewport::scroll()
+{
+    // as little as keeps the focus MARGIN cells inside, then back onto the board 
+    int row_margin = min(MARGIN, (rows - 1) / 2), col_margin = min(MARGIN, (cols - 1) / 2);
+    if(focus.row >= 0 && focus.col >= 0)
+    {
+        top = min(top, focus.row - row_margin);
+        top = max(top, focus.row + row_margin - rows + 1);
+        left = min(left, focus.col - col_margin);
+        left = max(left, focus.col + col_margin - cols + 1);
+    }
+    top = max(0, min(top, size - rows));
+    left = max(0, min(left, size - cols));
+}
+
+
+// SearchControl Method definations --> 
+SearchControl::SearchControl(int delay_us)
+: cancelled(false), paused(false), finished(false), delay_us(delay_us)
+{
+    frame_id = 0;
+    if(pipe(notify_pipe) != 0)
+        notify_pipe[0] = notify_pipe[1] = -1;
+    for(int i=0; i<2; i++)
+        if(notify_pipe[i] >= 0)
+            fcntl(notify_pipe[i], F_SETFL, fcntl(notify_pipe[i], F_GETFL) | O_NONBLOCK);
+}
+SearchControl::~SearchControl()
+{
+    for(int i=0; i<2; i++)
+        if(notify_pipe[i] >= 0)
+            close(notify_pipe[i]);
+}
+void SearchControl::cancel()
+{
+    {
+        lock_guard<mutex> lock(state_mutex);
+        cancelled = true;
+    }
+    wake.notify_all();
+}
+void SearchControl::drainNotifications()
+{
+    char buffer[64];
+    while(notify_pipe[0] >= 0 && read(notify_pipe[0], buffer, sizeof(buffer)) > 0);
+}
+void SearchControl::finish()
+{
+    finished = true;
+    if(notify_pipe[1] >= 0)
+        write(notify_pipe[1], "f", 1);
+}
+int SearchControl::getDelay() const
+{
+    return delay_us;
+}
+int SearchControl::getNotifyFd() const
+{
+    return notify_pipe[0];
+}
+bool SearchControl::isCancelled() const
+{
+    return cancelled;
+}
+bool SearchControl::isFinished() const
+{
+    return finished;
+}
+bool SearchControl::isPaused() const
+{
+    return paused;
+}
+bool SearchControl::publish(const string &new_frame, int delay_factor)
+{
+    // hand the frame over, then sleep; cancel, pause and speed changes cut the sleep short 
+    unique_lock<mutex> lock(state_mutex);
+    frame = new_frame;
+    frame_id++;
+    if(notify_pipe[1] >= 0)
+        write(notify_pipe[1], "n", 1);
+
+    chrono::steady_clock::time_point deadline = chrono::steady_clock::now() + chrono::microseconds((long long)delay_us*delay_factor);
+    while(!cancelled)
+    {
+        if(paused)
+        {
+            wake.wait(lock);
+            deadline = chrono::steady_clock::now() + chrono::microseconds((long long)delay_us*delay_factor);
+            continue;
         }
+        if(wake.wait_until(lock, deadline) == cv_status::timeout)
+            break;
+        // woken early: a speed change takes effect from now on 
+        chrono::steady_clock::time_point shorter = chrono::steady_clock::now() + chrono::microseconds((long long)delay_us*delay_factor);
+        deadline = min(deadline, shorter);
+    }
+    return !cancelled;
+}
+void SearchControl::setDelay(int delay_us)
+{
+    {
+        lock_guard<mutex> lock(state_mutex);
+        this->delay_us = max(0, delay_us);
     }
-    buffer[start.getPosition().row][start.getPosition().col] = SYMBOL_START;
-    buffer[end.getPosition().row][end.getPosition().col] = SYMBOL_END;
+    wake.notify_all();
+}
+bool SearchControl::takeFrame(string &out, uint64_t &seen_id)
+{
+    // copy the latest frame if it is newer than the one already drawn 
+    lock_guard<mutex> lock(state_mutex);
+    if(frame_id == seen_id)
+        return false;
+    out = frame;
+    seen_id = frame_id;
+    return true;
+}
+void SearchControl::togglePause()
+{
+    {
+        lock_guard<mutex> lock(state_mutex);
+        paused = !paused;
+    }
+    wake.notify_all();
+}
+
+
+// LatencyMeter Method definations --> 
+LatencyMeter::LatencyMeter()
+{
+    pending = false;
+    count = 0;
+    total_ms = max_ms = last_ms = 0;
+}
+void LatencyMeter::keyPressed()
+{
+    key_time = chrono::steady_clock::now();
+    pending = true;
+}
+void LatencyMeter::redrawn()
+{
+    if(!pending)
+        return;
+    last_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - key_time).count();
+    total_ms += last_ms;
+    max_ms = max(max_ms, last_ms);
+    count++;
+    pending = false;
+}
+string LatencyMeter::summary() const
+{
+    if(count == 0)
+        return "-";
+    ostringstream out;
+    out.precision(3);
+    out<<"last "<<last_ms<<" ms, mean "<<total_ms/count<<" ms, max "<<max_ms<<" ms";
+    return out.str();
+}
+
+
+// CacheMissCounter Method definations --> 
+CacheMissCounter::CacheMissCounter()
+{
+    perf_event_attr attributes;
+    memset(&attributes, 0, sizeof(attributes));
+    attributes.size = sizeof(attributes);
+    attributes.type = PERF_TYPE_HARDWARE;
+    attributes.config = PERF_COUNT_HW_CACHE_MISSES;
+    attributes.disabled = 1;
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+    fd = syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0);
+}
+CacheMissCounter::~CacheMissCounter()
+{
+    if(fd >= 0)
+        close(fd);
+}
+bool CacheMissCounter::isAvailable() const
+{
+    return fd >= 0;
+}
+void CacheMissCounter::start()
+{
+    if(fd < 0)
+        return;
+    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+}
+long long CacheMissCounter::stop()
+{
+    long long count = -1;
+    if(fd < 0)
+        return count;
+    ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    if(read(fd, &count, sizeof(count)) != sizeof(count))
+        count = -1;
+    return count;
+}
+
 
-    // Print the buffer 
-    for(int i=0; i<size; i++)
+// ThreadBarrier Method definations --> 
+ThreadBarrier::ThreadBarrier(int count)
+{
+    this->count = count;
+    waiting = 0;
+    generation = 0;
+}
+void ThreadBarrier::wait()
+{
+    unique_lock<mutex> guard(lock);
+    uint64_t arrived_in = generation;
+    if(++waiting == count)
     {
-        for(int j=0; j<size; j++)
-        {
-            cout<<buffer[i][j]<<" ";
-        }
-        cout<<endl;
+        waiting = 0;
+        generation++;
+        released.notify_all();
+        return;
     }
+    released.wait(guard, [&]() { return generation != arrived_in; });
+}
 
-    cout<<endl;
+
+#ifdef MAZE_TRACE
+// Tracer Method definations --> 
+mutex Tracer::registry_mutex;
+vector<Tracer::Buffer*> Tracer::buffers;
+chrono::steady_clock::time_point Tracer::epoch = chrono::steady_clock::now();
+
+void Tracer::counter(const char *name, long long value)
+{
+    record(name, now(), value, 0);
 }
-void Game::displayEditControls()
+Tracer::Buffer& Tracer::local()
 {
-    cout<<">> Controls: "<<endl;
-    cout<<"1. Move controls:\t\tw - Up;\t\ts - Down;\ta - Left;\td - Right."<<endl;
-    cout<<"2. Change Curser Mode: \tx - Insert Wall;\tz - Remove Wall;\tc - Select Cell."<<endl;
-    cout<<"3. Replace Start and End: \tq - Put start node;\te - Put end node."<<endl;
-    cout<<endl;
+    // the lock is only taken once per thread, when its buffer is registered 
+    static thread_local Buffer *buffer = NULL;
+    if(buffer == NULL)
+    {
+        buffer = new Buffer();
+        buffer->dropped = 0;
+        buffer->events.reserve(4096);
+        lock_guard<mutex> lock(registry_mutex);
+        if(buffers.empty())
+            atexit(writeAtExit);
+        buffer->tid = buffers.size() + 1;
+        buffers.push_back(buffer);
+    }
+    return *buffer;
 }
-void Game::displayEditUI()
+uint64_t Tracer::now()
 {
-    cout << ">> Legend:\t" << endl;
-    cout << ". : Empty Cell" << endl;
-    cout << "# : Wall" << endl;
-    cout << "@ : Explored Cell" << endl;
-    cout << "$ : Path to traverse" << endl;
-    cout << "S : Start Node" << endl;
-    cout << "E : End Node" << endl;
-    cout << "+ : Curser Position." << endl;
-    cout<<endl;
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - epoch).count();
 }
-
-void Game::displayEditMode()
+void Tracer::record(const char *name, uint64_t begin_ns, long long duration_ns, int sample_rate)
 {
-    // Create a buffer 
-    char **buffer = new char*[size];
-    for(int i=0; i<size; i++)
+    Buffer &buffer = local();
+    if(buffer.events.size() >= MAX_EVENTS)
     {
-        buffer[i] = new char[size];
+        buffer.dropped++;
+        return;
     }
-
-    // Set the buffer
-    cout<<"\t***Game Board***\t"<<endl;
-    for(int i=0; i<size; i++)
+    Event event = {name, begin_ns, duration_ns, sample_rate};
+    buffer.events.push_back(event);
+}
+void Tracer::summary(ostream &os)
+{
+    // sampled phases are scaled up by their sample rate 
+    struct Total
     {
-        for(int j=0; j<size; j++)
+        long long events;
+        double ms;
+        int sample_rate;
+    };
+    map<string, Total> totals;
+    long long dropped = 0;
+    lock_guard<mutex> lock(registry_mutex);
+    for(int b=0; b<buffers.size(); b++)
+    {
+        dropped += buffers[b]->dropped;
+        for(int k=0; k<buffers[b]->events.size(); k++)
         {
-            buffer[i][j] = board[i][j].isWalkable() ? SYMBOL_EMPTY : SYMBOL_WALL;
+            const Event &event = buffers[b]->events[k];
+            if(event.sample_rate == 0)
+                continue;
+            Total &total = totals[event.name];
+            total.events++;
+            total.ms += event.value * 1e-6 * event.sample_rate;
+            total.sample_rate = event.sample_rate;
         }
     }
-    buffer[start.getPosition().row][start.getPosition().col] = SYMBOL_START;
-    buffer[end.getPosition().row][end.getPosition().col] = SYMBOL_END;
-    buffer[curser.getPosition().row][curser.getPosition().col] = SYMBOL_CURSER;    // just added the curser 
-    
-    // Print the buffer 
-    for(int i=0; i<size; i++)
+    os<<"Trace summary (phase: events, total ms):"<<endl;
+    for(map<string, Total>::iterator it=totals.begin(); it!=totals.end(); it++)
     {
-        for(int j=0; j<size; j++)
-        {
-            cout<<buffer[i][j]<<" ";
-        }
-        cout<<endl;
+        os<<"  "<<it->first<<": "<<it->second.events;
+        if(it->second.sample_rate > 1)
+            os<<" samples (1 in "<<it->second.sample_rate<<")";
+        os<<", "<<it->second.ms<<" ms"<<endl;
     }
-    cout<<"Curser mode: "<<getCurserMode()<<endl;
-
-    cout<<endl;
+    if(dropped > 0)
+        os<<"  "<<dropped<<" events dropped, buffers full"<<endl;
 }
-void Game::displayGameState()
+bool Tracer::write(const string &file)
 {
-    // Create a buffer 
-    char **buffer = new char*[size];
-    for(int i=0; i<size; i++)
-    {
-        buffer[i] = new char[size];
-    }
-
-    // Set the buffer
-    cout<<"\t***Game Board***\t"<<endl;
-    for(int i=0; i<size; i++)
+    // only safe once the threads that recorded have been joined 
+    ofstream out(file.c_str());
+    if(!out)
+        return false;
+    out.setf(ios::fixed);
+    out.precision(3);
+    out<<"{\"traceEvents\":[";
+    bool first = true;
+    auto separator = [&]() {
+        if(!first)
+            out<<",\n";
+        first = false;
+    };
+    lock_guard<mutex> lock(registry_mutex);
+    int pid = getpid();
+    for(int b=0; b<buffers.size(); b++)
     {
-        for(int j=0; j<size; j++)
+        const Buffer &buffer = *buffers[b];
+        separator();
+        out<<"{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":"<<pid<<",\"tid\":"<<buffer.tid
+           <<",\"args\":{\"name\":\"thread "<<buffer.tid<<"\"}}";
+        for(int k=0; k<buffer.events.size(); k++)
         {
-            NodeHandle curr = board[i][j];
-            if(curr.isExplored())
-                buffer[i][j] = SYMBOL_EXPLORED;
+            const Event &event = buffer.events[k];
+            separator();
+            out<<"{\"name\":\""<<event.name<<"\",\"cat\":\"maze\",\"pid\":"<<pid<<",\"tid\":"<<buffer.tid
+               <<",\"ts\":"<<event.begin_ns/1000.0;
+            if(event.sample_rate == 0)
+                out<<",\"ph\":\"C\",\"args\":{\"value\":"<<event.value<<"}}";
             else
-                buffer[i][j] = board[i][j].isWalkable() ? SYMBOL_EMPTY : SYMBOL_WALL;
+                out<<",\"ph\":\"X\",\"dur\":"<<event.value/1000.0<<",\"args\":{\"sampled\":\"1/"<<event.sample_rate<<"\"}}";
         }
     }
+    out<<"],\"displayTimeUnit\":\"ns\"}"<<endl;
+    return (bool)out;
+}
+void Tracer::writeAtExit()
+{
+    const char *file = getenv("MAZE_TRACE_FILE");
+    string name = file != NULL ? file : "maze_trace.json";
+    summary(cerr);
+    if(write(name))
+        cerr<<"Trace written to "<<name<<endl;
+    else
+        cerr<<"Could not write the trace to "<<name<<endl;
+}
 
-    buffer[start.getPosition().row][start.getPosition().col] = SYMBOL_START;
-    buffer[end.getPosition().row][end.getPosition().col] = SYMBOL_END;
 
-    // Print the buffer 
-    for(int i=0; i<size; i++)
-    {
-        for(int j=0; j<size; j++)
-        {
-            cout<<buffer[i][j]<<" ";
-        }
-        cout<<endl;
-    }
+// TraceScope Method definations --> 
+TraceScope::TraceScope(const char *name, int sample_rate)
+{
+    this->name = name;
+    this->sample_rate = sample_rate;
+    begin_ns = sample_rate != 0 ? Tracer::now() : 0;
+}
+TraceScope::~TraceScope()
+{
+    if(sample_rate != 0)
+        Tracer::record(name, begin_ns, Tracer::now() - begin_ns, sample_rate);
+}
+#endif
 
-    cout<<endl;
+
+// Benchmark section -->
+static double elapsedMs(chrono::steady_clock::time_point since)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - since).count();
 }
-void Game::displayPath()
+static int benchGenerators(int size, uint64_t seed)
 {
-    // Create a buffer 
-    char **buffer = new char*[size];
-    for(int i=0; i<size; i++)
-    {
-        buffer[i] = new char[size];
-    }
+    cout<<"Generators on a "<<size<<"x"<<size<<" board, seed "<<seed<<", "<<max(1u, thread::hardware_concurrency())<<" threads"<<endl;
 
-    // Set the buffer
-    cout<<"\t***Game Board***\t"<<endl;
-    for(int i=0; i<size; i++)
+    auto begin = chrono::steady_clock::now();
+    Game game(size);
+    cout<<"Board allocation: "<<elapsedMs(begin)<<" ms"<<endl;
+
+    for(int type=MazeGenerator::RECURSIVE_BACKTRACKER; type<=MazeGenerator::RANDOM_FILL; type++)
     {
-        for(int j=0; j<size; j++)
-        {
-            NodeHandle curr=board[i][j];
-            if(curr.isVisited())
-                buffer[i][j] = SYMBOL_VISITED;
-            else
-                buffer[i][j] = board[i][j].isWalkable() ? SYMBOL_EMPTY : SYMBOL_WALL;
-        }
+        begin = chrono::steady_clock::now();
+        MazeGenerator::GeneratorType generator = (MazeGenerator::GeneratorType)type;
+        game.generateBoard(generator, seed);
+        double ms = elapsedMs(begin);
+
+        long long walls = 0;
+        for(int i=0; i<size; i++)
+            for(int j=0; j<size; j++)
+                walls += game.wallAt(i, j);
+
+        cout<<MazeGenerator::getName(generator)<<": "<<ms<<" ms, "
+            <<(double)size*size/ms/1000.0<<" Mcells/s, walls "<<100.0*walls/((double)size*size)<<"%"<<endl;
     }
-
-    buffer[start.getPosition().row][start.getPosition().col] = SYMBOL_START;
-    buffer[end.getPosition().row][end.getPosition().col] = SYMBOL_END;
-
-    // Print the buffer 
-    for(int i=0; i<size; i++)
+    return 0;
+}
+// Open cells reachable from the centre of the board, in a seeded random order 
+static vector<Position> shuffledReachableCells(const Game &game, uint64_t seed)
+{
+    int size = game.getSize();
+    Position origin = game.findNearestWalkable(Position(size/2, size/2));
+    vector<uint8_t> seen((size_t)size*size, 0);
+    vector<Position> cells;
+    cells.push_back(origin);
+    seen[(size_t)origin.row*size+origin.col] = 1;
+    for(size_t head=0; head<cells.size(); head++)
     {
-        for(int j=0; j<size; j++)
+        for(int dx=-1; dx<=1; dx++)
         {
-            cout<<buffer[i][j]<<" ";
+            for(int dy=-1; dy<=1; dy++)
+            {
+                int r = cells[head].row+dx, c = cells[head].col+dy;
+                if(game.wallAt(r, c) || seen[(size_t)r*size+c])
+                    continue;
+                seen[(size_t)r*size+c] = 1;
+                cells.push_back(Position(r, c));
+            }
         }
-        cout<<endl;
     }
 
-    cout<<endl;
-
+    Random random(seed);
+    for(size_t i=cells.size(); i>1; i--)
+        swap(cells[i-1], cells[random.nextInt(i)]);
+    return cells;
 }
-void Game::enterEditMode()
+static int benchAgents(int size, uint64_t seed)
 {
-    gameMode = GameEnum::EDIT;
-    curserMode = CurserMode::SELECT;
+    Game game(size);
+    game.generateBoard(MazeGenerator::CELLULAR_AUTOMATA, seed, 0.38f);
+    vector<Position> cells = shuffledReachableCells(game, seed);
+    cout<<"WHCA* on a "<<size<<"x"<<size<<" cave board, "<<cells.size()<<" reachable cells, window 16"<<endl;
 
-    // Edit loop 
-    while(gameMode == GameEnum::EDIT)
+    int counts[] = {10, 25, 50, 100, 250, 500, 1000};
+    for(int k=0; k<sizeof(counts)/sizeof(counts[0]); k++)
     {
-        // Clear the screen first 
-        system("clear");
-
-        // dipslay board in edit mode 
-        cout<<"\t***Edit Mode***\t"<<endl;
-        displayEditMode();
+        int n = counts[k];
+        if(2*n > cells.size())
+            break;
 
-        // display edit instructions 
-        displayEditControls();
-        displayEditUI();
-        // get input and execute edit command 
-        cout<<"Your Response: ";
+        vector<Agent> agents;
+        for(int a=0; a<n; a++)
+            agents.push_back(Agent(cells[a], cells[n+a]));
 
-        system("stty raw");
-        char key = getchar();
-        system("stty cooked");
+        MultiAgentStats stats = game.planAgents(agents);
+        cout<<n<<" agents: "<<stats.plan_ms<<" ms, "<<stats.agentsPerSecond()<<" agents/s, "
+            <<"reached "<<stats.reached<<", makespan "<<stats.makespan<<", sum of costs "<<stats.sum_of_costs<<", "
+            <<"conflicts avoided "<<stats.conflicts_avoided<<", residual "<<stats.residual_conflicts<<endl;
+    }
+    return 0;
+}
+static int benchAnyAngle(int size, uint64_t seed)
+{
+    Game game(size);
+    game.setVisualize(false);
+    cout<<"Any-angle search on "<<size<<"x"<<size<<" boards, 20 queries per board"<<endl;
 
-        switch(key)
+    MazeGenerator::GeneratorType types[] = {MazeGenerator::CELLULAR_AUTOMATA, MazeGenerator::ROOMS_AND_CORRIDORS, MazeGenerator::RANDOM_FILL};
+    for(int t=0; t<3; t++)
+    {
+        game.generateBoard(types[t], seed, types[t] == MazeGenerator::RANDOM_FILL ? 0.2f : 0.4f);
+        vector<Position> cells = shuffledReachableCells(game, seed);
+        WalkableBitset grid(game);
+        AnyAngleSearch search(grid);
+
+        double astar_ms = 0, smooth_ms = 0, theta_ms = 0, lazy_ms = 0;
+        long long grid_cells = 0, grid_turns = 0, smoothed = 0, theta = 0, lazy = 0;
+        double grid_length = 0, smooth_length = 0, theta_length = 0, lazy_length = 0;
+        long long theta_los = 0, lazy_los = 0;
+        int queries = min(20, (int)cells.size()/2);
+        for(int q=0; q<queries; q++)
         {
-            // Execute the responses 
-            case 'w':
-                moveUp();
-                break;
-            case 'a':
-                moveLeft();
-                break;
-            case 's':
-                moveDown();
-                break;
-            case 'd':
-                moveRight();
-                break;
-            case 'q':
-                putStart();
-                break;
-            case 'e':
-                putEnd();
-                break;
-            case 'x':
-                changeCurserMode(CurserMode::INSERT_WALL);
-                break;
-            case 'z':
-                changeCurserMode(CurserMode::REMOVE_WALL);
-                break;
-            case 'c':
-                changeCurserMode(CurserMode::SELECT);
-                break;
-            case '0':
-                gameMode = GameEnum::PATH_FINDING;
-                break;
+            Position from = cells[2*q], to = cells[2*q+1];
+
+            auto begin = chrono::steady_clock::now();
+            game.setEndpoints(from, to);
+            game.aStarSearch();
+            vector<Position> path = game.getPath();
+            astar_ms += elapsedMs(begin);
+
+            begin = chrono::steady_clock::now();
+            vector<Position> smooth = search.smoothPath(path);
+            smooth_ms += elapsedMs(begin);
+
+            begin = chrono::steady_clock::now();
+            vector<Position> theta_path = search.thetaStar(from, to, false);
+            theta_ms += elapsedMs(begin);
+            theta_los += search.getLineOfSightChecks();
+
+            begin = chrono::steady_clock::now();
+            vector<Position> lazy_path = search.thetaStar(from, to, true);
+            lazy_ms += elapsedMs(begin);
+            lazy_los += search.getLineOfSightChecks();
+
+            grid_cells += path.size();
+            grid_turns += AnyAngleSearch::turningPoints(path).size();
+            smoothed += smooth.size();
+            theta += theta_path.size();
+            lazy += lazy_path.size();
+            grid_length += AnyAngleSearch::pathLength(path);
+            smooth_length += AnyAngleSearch::pathLength(smooth);
+            theta_length += AnyAngleSearch::pathLength(theta_path);
+            lazy_length += AnyAngleSearch::pathLength(lazy_path);
         }
 
-
+        cout<<MazeGenerator::getName(types[t])<<":"<<endl;
+        cout<<"  A* grid path:   "<<astar_ms<<" ms, "<<grid_cells<<" cells, "<<grid_turns<<" turning points, length "<<grid_length<<endl;
+        cout<<"  + smoothing:    "<<smooth_ms<<" ms, "<<smoothed<<" waypoints ("<<100.0*(1.0-(double)smoothed/max(1LL, grid_turns))<<"% fewer), length "<<smooth_length<<endl;
+        cout<<"  Theta*:         "<<theta_ms<<" ms, "<<theta<<" waypoints, length "<<theta_length<<", "<<theta_los<<" LOS checks"<<endl;
+        cout<<"  Lazy Theta*:    "<<lazy_ms<<" ms, "<<lazy<<" waypoints, length "<<lazy_length<<", "<<lazy_los<<" LOS checks"<<endl;
     }
-
+    return 0;
 }
-void Game::exitGame()
+static float octileLength(const vector<Position> &path)
 {
-    should_close = true;
+    float length = 0;
+    for(int k=0; k+1<path.size(); k++)
+        length += (path[k].row != path[k+1].row && path[k].col != path[k+1].col) ? sqrt(2.0f) : 1.0f;
+    return length;
 }
-void Game::findPath()
+static int benchCache(int size, uint64_t seed)
 {
-    while(gameMode == GameEnum::PATH_FINDING)
-    {
-        // clear screan 
-        system("clear");
-
-        // display the game
-        displayPath();
-        result.display();
-
-        // clear the buffers
-        clearBuffer(BUFFER_ALL_BIT);
-        result.reset();
+    const int QUERIES = 40, STREAM = 2000, EDIT_EVERY = 25;
+    size_t budgets[] = {0, 8u<<10, 16u<<20};
+    vector<float> reference;
 
-        // display algorithms menu
-        cout<<"\t***Chose an Algorithm to Solve The Maze***\t"<<endl;
-        cout<<"1. Depth First Search"<<endl;
-        cout<<"2. Breadth First Search"<<endl;
-        cout<<"3. Best First Search algorithm"<<endl;
-        cout<<"4. Greedy Best First Search algorithm"<<endl;
-        cout<<"5. A Star algorithm"<<endl;
-        cout<<"0. Exit"<<endl;
-        cout<<"Enter your choice: ";
+    cout<<"Path cache on a "<<size<<"x"<<size<<" cave board: "<<STREAM<<" A* queries over "<<QUERIES
+        <<" distinct pairs, one wall edit every "<<EDIT_EVERY<<" queries"<<endl;
+    for(int b=0; b<3; b++)
+    {
+        // same board, query stream and edits for every budget 
+        Game game(size);
+        game.setVisualize(false);
+        game.generateBoard(MazeGenerator::CELLULAR_AUTOMATA, seed, 0.4f);
+        game.getPathCache().setBudget(budgets[b]);
+        vector<Position> cells = shuffledReachableCells(game, seed);
+        Random random(seed);
+
+        int invalid = 0;
+        double drift = 0;
+        auto begin = chrono::steady_clock::now();
+        for(int q=0; q<STREAM; q++)
+        {
+            if(q % EDIT_EVERY == EDIT_EVERY-1)
+            {
+                Position cell(random.nextInt(size), random.nextInt(size));
+                game.setWall(cell, !game.wallAt(cell.row, cell.col));
+            }
 
+            int pair = random.nextInt(QUERIES);
+            game.setEndpoints(cells[2*pair], cells[2*pair+1]);
+            vector<Position> path = game.solve(A_STAR_SEARCH);
 
-        // get input and execute that algorithm 
-        char choice;
-        system("stty raw");
-        choice=getchar();
-        system("stty cooked");
+            // a served path must still be walkable and connect the endpoints 
+            bool valid = path.empty() || (path.front().row == cells[2*pair].row && path.front().col == cells[2*pair].col
+                                       && path.back().row == cells[2*pair+1].row && path.back().col == cells[2*pair+1].col);
+            for(int k=0; k<path.size() && valid; k++)
+            {
+                valid = !game.wallAt(path[k].row, path[k].col);
+                if(k > 0)
+                    valid = valid && abs(path[k].row-path[k-1].row) <= 1 && abs(path[k].col-path[k-1].col) <= 1;
+            }
+            invalid += !valid;
 
-        switch(choice)
-        {
-            case '1':
-                result.setAlgorithm("Depth First Search");
-                depthFirstSearch(start);
-                break;
-            case '2':
-                result.setAlgorithm("Breadth First Search");
-                breadthFirstSearch();
-                break;
-            case '3':
-                result.setAlgorithm("Best First Search");
-                bestFirstSearch();
-                break;
-            case '4':
-                result.setAlgorithm("Greedy Best First Search");
-                greedyBestFirstSearch();
-                break;
-            case '5':
-                result.setAlgorithm("A star");
-                aStarSearch();
-                break;
-            case '0':
-                gameMode = GameEnum::MENU;
-                break;
-                
+            // the run without a cache is the reference for the cached ones 
+            float length = octileLength(path);
+            if(b == 0)
+                reference.push_back(length);
+            else
+                drift += fabs(reference[q] - length);
         }
+        double ms = elapsedMs(begin);
 
-        
-        
+        PathCache &cache = game.getPathCache();
+        cout<<"Budget "<<budgets[b]<<" bytes: "<<ms<<" ms, "<<cache.getHits()<<" hits, "<<cache.getMisses()<<" misses, "
+            <<cache.getInvalidations()<<" invalidations, "<<cache.getEvictions()<<" evictions, "
+            <<cache.getBytes()<<" bytes held, "<<invalid<<" invalid paths, mean cost drift "<<drift/STREAM<<endl;
     }
-
-}
-float Game::getChessBoardDistance(const NodeHandle src, const NodeHandle dst) 
-{
-    Position distance = src.getPosition() - dst.getPosition();
-
-    int dx = abs(distance.row);
-    int dy = abs(distance.col);
-
-    return sqrt(2.0f)*min(dx, dy) + abs(dx-dy);
-}
-string Game::getCurserMode()
-{
-    if(curserMode == CurserMode::INSERT_WALL)
-        return "Insesrt Wall";
-    else if(curserMode == CurserMode::REMOVE_WALL)
-        return "Remove Wall";
-    else 
-        return "Select";
-}
-float Game::getEuclidianDistance(const NodeHandle src, const NodeHandle dst) 
-{
-    Position distance = src.getPosition() - dst.getPosition();
-    
-    int dx = abs(distance.row);
-    int dy = abs(distance.col);
-
-    return sqrt(dx*dx+dy*dy);
+    return 0;
 }
-
-void Game::getInput()
+static void benchAnytimeRun(const string &name, AnytimeSearch<> &search, const vector<Position> &cells, const vector<float> &optimal,
+                            bool repeat, float epsilon, SearchBudget budget)
 {
-    // display the main menu 
-    cout<<"1. Edit Board"<<endl;
-    cout<<"2. Find Path"<<endl;
-    cout<<"0. Exit"<<endl;
-
-    // ask for choice 
-    char choice;
-    cout<<"Enter your choice here: ";
-    system("stty raw");
-    choice=getchar();
-    system("stty cooked");
-
-    switch(choice)
+    double total_ms = 0, first_ms = 0, ratio = 0, bound = 0;
+    long long expansions = 0;
+    int found = 0, exhausted = 0, violations = 0;
+    for(int q=0; q<optimal.size(); q++)
     {
-        case '1':
-            enterEditMode();
-            break;
-        case '2':
-            findPath();
-            break;
-        case '0':
-            exitGame();
-            break;
+        auto begin = chrono::steady_clock::now();
+        vector<Position> path = repeat ? search.araStar(cells[2*q], cells[2*q+1], epsilon, 0.5f, budget)
+                                       : search.weightedAStar(cells[2*q], cells[2*q+1], epsilon, budget);
+        total_ms += elapsedMs(begin);
+        expansions += search.getExpansions();
+        exhausted += search.isBudgetExhausted();
+        if(path.empty())
+            continue;
+
+        found++;
+        first_ms += search.getFirstSolutionMs();
+        ratio += search.getPathCost()/optimal[q];
+        bound += search.getBound();
+        // the reported bound must hold against the optimal cost 
+        if(search.getPathCost() > search.getBound()*optimal[q]*1.0001f)
+            violations++;
     }
 
+    cout<<"  "<<name<<": "<<total_ms<<" ms, "<<expansions<<" expansions, "<<found<<"/"<<optimal.size()<<" found, "
+        <<exhausted<<" out of budget, first solution "<<first_ms/max(1, found)<<" ms, cost ratio "<<ratio/max(1, found)
+        <<", bound "<<bound/max(1, found)<<", "<<violations<<" bound violations"<<endl;
 }
-float Game::getManhattanDistance(const NodeHandle src, const NodeHandle dst) 
+static int benchAnytime(int size, uint64_t seed)
 {
-    Position distance = src.getPosition() - dst.getPosition();
-    return abs(distance.row) + abs(distance.col);
+    Game game(size);
+    game.setVisualize(false);
+    cout<<"Weighted A* and ARA* on "<<size<<"x"<<size<<" boards, 20 queries per board (means per found path)"<<endl;
+
+    MazeGenerator::GeneratorType types[] = {MazeGenerator::CELLULAR_AUTOMATA, MazeGenerator::ROOMS_AND_CORRIDORS, MazeGenerator::RANDOM_FILL};
+    for(int t=0; t<3; t++)
+    {
+        game.generateBoard(types[t], seed, types[t] == MazeGenerator::RANDOM_FILL ? 0.3f : 0.4f);
+        vector<Position> cells = shuffledReachableCells(game, seed);
+        WalkableBitset grid(game);
+        AnytimeSearch<> search(grid);
+        cout<<MazeGenerator::getName(types[t])<<":"<<endl;
+
+        // epsilon 1 is plain A*, its costs are the reference 
+        vector<float> optimal;
+        int queries = min(20, (int)cells.size()/2);
+        for(int q=0; q<queries; q++)
+        {
+            search.weightedAStar(cells[2*q], cells[2*q+1], 1.0f);
+            optimal.push_back(max(search.getPathCost(), 1e-6f));
+        }
+
+        benchAnytimeRun("A* (epsilon 1)     ", search, cells, optimal, false, 1.0f, SearchBudget());
+        benchAnytimeRun("Weighted A* 1.5    ", search, cells, optimal, false, 1.5f, SearchBudget());
+        benchAnytimeRun("Weighted A* 3      ", search, cells, optimal, false, 3.0f, SearchBudget());
+        benchAnytimeRun("ARA* 3, unlimited  ", search, cells, optimal, true, 3.0f, SearchBudget());
+        benchAnytimeRun("ARA* 3, 2000 exp.  ", search, cells, optimal, true, 3.0f, SearchBudget(2000));
+        benchAnytimeRun("ARA* 3, 10000 exp. ", search, cells, optimal, true, 3.0f, SearchBudget(10000));
+        benchAnytimeRun("ARA* 3, 1 ms       ", search, cells, optimal, true, 3.0f, SearchBudget(-1, 1000));
+        benchAnytimeRun("ARA* 3, 5 ms       ", search, cells, optimal, true, 3.0f, SearchBudget(-1, 5000));
+    }
+    return 0;
 }
-bool Game::greedyBestFirstSearch()
+static int benchSubgoals(int size, uint64_t seed)
 {
-    // Declare and Initialize data-structures
-    priority_queue<NodeHandle, vector<NodeHandle>, NodeHandleComparatorHCost> openList;
-    unordered_set<NodeHandle, NodeHandleHashFunction> open;
-    openList.push(start);
-    open.insert(start);
+    Game game(size);
+    game.setVisualize(false);
+    cout<<"Subgoal graphs on "<<size<<"x"<<size<<" boards, 200 queries per board, costs checked against A*"<<endl;
 
-    while(!openList.empty())
+    string index_file = "/tmp/maze_subgoal_" + to_string(getpid()) + ".idx";
+    MazeGenerator::GeneratorType types[] = {MazeGenerator::CELLULAR_AUTOMATA, MazeGenerator::ROOMS_AND_CORRIDORS, MazeGenerator::RECURSIVE_BACKTRACKER, MazeGenerator::RANDOM_FILL};
+    for(int t=0; t<4; t++)
     {
-        // pop the first node 
-        NodeHandle curr = openList.top();
-        openList.pop();
-        open.erase(curr);
-        curr.markAsExplored();
-        result.incSearchCost();
-        
-        // Display the progress and add a delay 
-        system("clear");
-        cout<<"Finding a path ... "<<endl;
-        displayGameState();
-        usleep(50000);
-                    
-        // check if its the end node 
-        if(curr == end) 
-        {
-            retracePath();
-            result.setSuccess();
-            return true;
+        game.generateBoard(types[t], seed, types[t] == MazeGenerator::RANDOM_FILL ? 0.2f : 0.4f);
+        vector<Position> cells = shuffledReachableCells(game, seed);
+        WalkableBitset grid(game);
+        AnytimeSearch<> reference(grid);
+
+        auto begin = chrono::steady_clock::now();
+        SubgoalGraph<> simple(grid, false);
+        double simple_ms = elapsedMs(begin);
+        begin = chrono::steady_clock::now();
+        SubgoalGraph<> two_level(grid, true);
+        double two_level_ms = elapsedMs(begin);
+
+        // save, then load through the constructor as a later run on the same board would 
+        remove(index_file.c_str());
+        two_level.save(index_file);
+        begin = chrono::steady_clock::now();
+        SubgoalGraph<> loaded(grid, true, index_file);
+        double load_ms = elapsedMs(begin);
+
+        int queries = min(200, (int)cells.size()/2);
+        double astar_ms = 0, simple_query_ms = 0, two_level_query_ms = 0, loaded_ms = 0;
+        long long astar_expanded = 0, simple_expanded = 0, two_level_expanded = 0;
+        int mismatches = 0;
+        auto check = [&](float cost, float optimal) {
+            if(fabs(cost - optimal) > 1e-2f * max(1.0f, optimal))
+                mismatches++;
+        };
+        for(int q=0; q<queries; q++)
+        {
+            Position from = cells[2*q], to = cells[2*q+1];
+            begin = chrono::steady_clock::now();
+            reference.weightedAStar(from, to, 1.0f);
+            astar_ms += elapsedMs(begin);
+            astar_expanded += reference.getExpansions();
+            float optimal = reference.getPathCost();
+
+            begin = chrono::steady_clock::now();
+            simple.findPath(from, to);
+            simple_query_ms += elapsedMs(begin);
+            simple_expanded += simple.getExpansions();
+            check(simple.getPathCost(), optimal);
+
+            begin = chrono::steady_clock::now();
+            two_level.findPath(from, to);
+            two_level_query_ms += elapsedMs(begin);
+            two_level_expanded += two_level.getExpansions();
+            check(two_level.getPathCost(), optimal);
+
+            begin = chrono::steady_clock::now();
+            loaded.findPath(from, to);
+            loaded_ms += elapsedMs(begin);
+            check(loaded.getPathCost(), optimal);
         }
-        
-        // update its neighbours
-        updateNeighbourCost(curr);
-
-        // push its neighbours 
-        vector<NodeHandle> neighbours = getNeighbours(curr);
-        for(int i=0; i<neighbours.size(); i++)
-        {            
-            if(!neighbours[i].isWalkable() || neighbours[i].isExplored() || open.find(neighbours[i]) != open.end())
+
+        // wall edits: local repair against building from scratch 
+        Random random(Random::mix(seed, t));
+        double repair_ms = 0, rebuild_ms = 0;
+        int edits = 0;
+        for(int e=0; e<50; e++)
+        {
+            Position pos = cells[random.nextInt(cells.size())];
+            bool wall = !game.wallAt(pos.row, pos.col);
+            game.setWall(pos, wall);
+            if(game.wallAt(pos.row, pos.col) != wall)
                 continue;
-            
-            openList.push(neighbours[i]);
-            open.insert(neighbours[i]);
+            edits++;
+            begin = chrono::steady_clock::now();
+            simple.setWall(pos, wall);
+            repair_ms += elapsedMs(begin);
+        }
+        WalkableBitset edited(game);
+        begin = chrono::steady_clock::now();
+        SubgoalGraph<> rebuilt(edited, false);
+        rebuild_ms = elapsedMs(begin);
+        AnytimeSearch<> edited_reference(edited);
+        int edited_mismatches = 0;
+        for(int q=0; q<queries; q++)
+        {
+            edited_reference.weightedAStar(cells[2*q], cells[2*q+1], 1.0f);
+            simple.findPath(cells[2*q], cells[2*q+1]);
+            float optimal = edited_reference.getPathCost(), cost = simple.getPathCost();
+            if(!(isinf(optimal) && isinf(cost)) && fabs(cost - optimal) > 1e-2f * max(1.0f, optimal))
+                edited_mismatches++;
         }
-        
-    }    
 
-    result.setFailure();
-    return false;
+        cout<<MazeGenerator::getName(types[t])<<":"<<endl;
+        cout<<"  SSG: "<<simple.getSubgoalCount()<<" subgoals, "<<simple.getEdgeCount()<<" edges, built in "<<simple_ms<<" ms"<<endl;
+        cout<<"  TSG: "<<two_level.getGlobalCount()<<" global subgoals, "<<two_level.getEdgeCount()<<" edges, built in "<<two_level_ms
+            <<" ms, loaded from file in "<<load_ms<<" ms"<<endl;
+        cout<<"  A*:  "<<astar_ms<<" ms, "<<astar_expanded<<" expansions"<<endl;
+        cout<<"  SSG: "<<simple_query_ms<<" ms, "<<simple_expanded<<" expansions"<<endl;
+        cout<<"  TSG: "<<two_level_query_ms<<" ms, "<<two_level_expanded<<" expansions (loaded copy "<<loaded_ms<<" ms), "<<mismatches<<" cost mismatches"<<endl;
+        cout<<"  "<<edits<<" wall edits: local repair "<<repair_ms<<" ms in total, full rebuild "<<rebuild_ms<<" ms, "<<edited_mismatches<<" cost mismatches after repair"<<endl;
+    }
+    remove(index_file.c_str());
+    return 0;
 }
-vector<NodeHandle> Game::getNeighbours(const NodeHandle &curr)
+static int benchJunctions(int size, uint64_t seed)
 {
-    vector<NodeHandle> neighbourList;
-    int dx, dy;
-    for(int dx=-1; dx<=1; dx++)
+    Game game(size);
+    game.setVisualize(false);
+    cout<<"Junction graphs on "<<size<<"x"<<size<<" boards, 200 queries per board, costs checked against A*"<<endl;
+    int failures = 0;
+
+    MazeGenerator::GeneratorType types[] = {MazeGenerator::RECURSIVE_BACKTRACKER, MazeGenerator::KRUSKAL, MazeGenerator::ROOMS_AND_CORRIDORS, MazeGenerator::CELLULAR_AUTOMATA};
+    for(int t=0; t<4; t++)
     {
-        for(int dy=-1; dy<=1; dy++)
+        game.generateBoard(types[t], seed, 0.4f);
+        vector<Position> cells = shuffledReachableCells(game, seed);
+        WalkableBitset grid(game);
+        AnytimeSearch<> reference(grid);
+
+        auto begin = chrono::steady_clock::now();
+        JunctionGraph<> graph(grid);
+        double build_ms = elapsedMs(begin);
+        int junctions = graph.getJunctionCount(), pruned = graph.getPrunedCount();
+        long long edge_count = graph.getEdgeCount();
+
+        int queries = min(200, (int)cells.size()/2), mismatches = 0;
+        double astar_ms = 0, graph_ms = 0;
+        long long astar_expanded = 0, graph_expanded = 0;
+        for(int q=0; q<queries; q++)
         {
-            if(dx == 0 && dy == 0)
-                continue;
-            
-            int x=curr.getPosition().row+dx;
-            int y=curr.getPosition().col+dy;
-            
-            if(isOutOfBounds(Position(x,y)))
+            Position from = cells[2*q], to = cells[2*q+1];
+            begin = chrono::steady_clock::now();
+            reference.weightedAStar(from, to, 1.0f);
+            astar_ms += elapsedMs(begin);
+            astar_expanded += reference.getExpansions();
+
+            begin = chrono::steady_clock::now();
+            vector<Position> path = graph.findPath(from, to);
+            graph_ms += elapsedMs(begin);
+            graph_expanded += graph.getExpansions();
+            float optimal = reference.getPathCost();
+            if(fabs(graph.getPathCost() - optimal) > 1e-2f * max(1.0f, optimal) || fabs(octileLength(path) - optimal) > 1e-2f * max(1.0f, optimal))
+                mismatches++;
+        }
+
+        // wall edits: local repair against building from scratch; every other edit opens a 
+        // wall, which on a maze joins two corridors and undoes the pruning up from them 
+        Random random(Random::mix(seed, t));
+        double repair_ms = 0, slowest_ms = 0;
+        int edits = 0;
+        for(int e=0; e<50; e++)
+        {
+            Position pos = cells[random.nextInt(cells.size())];
+            for(int tries=0; e % 2 == 1 && tries < 100 && !game.wallAt(pos.row, pos.col); tries++)
+                pos = Position(1 + random.nextInt(size-2), 1 + random.nextInt(size-2));
+            bool wall = !game.wallAt(pos.row, pos.col);
+            game.setWall(pos, wall);
+            if(game.wallAt(pos.row, pos.col) != wall)
                 continue;
-            
-            if(board[x][y].isWalkable())
-                neighbourList.push_back(board[x][y]);
+            edits++;
+            begin = chrono::steady_clock::now();
+            graph.setWall(pos, wall);
+            double ms = elapsedMs(begin);
+            repair_ms += ms;
+            slowest_ms = max(slowest_ms, ms);
+        }
+        WalkableBitset edited(game);
+        begin = chrono::steady_clock::now();
+        JunctionGraph<> rebuilt(edited);
+        double rebuild_ms = elapsedMs(begin);
+        AnytimeSearch<> edited_reference(edited);
+        int edited_mismatches = 0;
+        for(int q=0; q<queries; q++)
+        {
+            edited_reference.weightedAStar(cells[2*q], cells[2*q+1], 1.0f);
+            graph.findPath(cells[2*q], cells[2*q+1]);
+            float optimal = edited_reference.getPathCost(), cost = graph.getPathCost();
+            if(!(isinf(optimal) && isinf(cost)) && fabs(cost - optimal) > 1e-2f * max(1.0f, optimal))
+                edited_mismatches++;
+        }
 
+        cout<<MazeGenerator::getName(types[t])<<": "<<cells.size()<<" open cells"<<endl;
+        cout<<"  graph: "<<pruned<<" cells pruned as dead ends, "<<junctions<<" junctions, "<<edge_count<<" edges, built in "<<build_ms<<" ms"<<endl;
+        cout<<"  A*:    "<<astar_ms<<" ms, "<<astar_expanded<<" expansions"<<endl;
+        cout<<"  graph: "<<graph_ms<<" ms, "<<graph_expanded<<" expansions, "<<mismatches<<" cost mismatches"<<endl;
+        cout<<"  "<<edits<<" wall edits: local repair "<<repair_ms<<" ms in total, "<<slowest_ms<<" ms at most, full rebuild "<<rebuild_ms<<" ms, "
+            <<edited_mismatches<<" cost mismatches after repair"<<endl;
+
+        // on mazes every corridor is pruned, so this is where a repair could grow to the whole board 
+        bool maze = types[t] == MazeGenerator::RECURSIVE_BACKTRACKER || types[t] == MazeGenerator::KRUSKAL;
+        if(mismatches || edited_mismatches || (maze && slowest_ms >= rebuild_ms))
+        {
+            cout<<"  FAILED: "<<(maze && slowest_ms >= rebuild_ms ? "a repair is slower than a rebuild" : "costs differ from A*")<<endl;
+            failures++;
         }
     }
-    return neighbourList;
-}
-
-bool Game::isOutOfBounds(Position curr) const
-{
-    if(curr.row < 0 || curr.col < 0 || curr.row >= size || curr.col >= size)
-        return true;
-    return false;
+    return failures > 0;
 }
-void Game::moveUp()
+static int benchPathDatabase(int size, uint64_t seed)
 {
-    int x, y;
-    x = curser.getPosition().row-1;
-    y = curser.getPosition().col;
+    Game game(size);
+    game.setVisualize(false);
+    cout<<"Compressed path database on "<<size<<"x"<<size<<" boards, "<<max(1u, thread::hardware_concurrency())<<" build threads"<<endl;
 
-    if(isOutOfBounds(Position(x,y)))
-        return;
-    
-    curser = board[x][y];
-    applyCurser();
+    string file = "/tmp/maze_cpd_" + to_string(getpid()) + ".cpd";
+    MazeGenerator::GeneratorType types[] = {MazeGenerator::CELLULAR_AUTOMATA, MazeGenerator::ROOMS_AND_CORRIDORS, MazeGenerator::RECURSIVE_BACKTRACKER};
+    for(int t=0; t<3; t++)
+    {
+        game.generateBoard(types[t], seed, 0.4f);
+        vector<Position> cells = shuffledReachableCells(game, seed);
+        WalkableBitset grid(game);
+
+        auto begin = chrono::steady_clock::now();
+        long long runs, entries = (long long)cells.size()*cells.size();
+        {
+            CompressedPathDatabase built(grid);
+            runs = built.getRunCount();
+            remove(file.c_str());
+            built.save(file);
+        }
+        double build_ms = elapsedMs(begin);
+        struct stat info;
+        long long file_bytes = stat(file.c_str(), &info) == 0 ? info.st_size : -1;
+
+        begin = chrono::steady_clock::now();
+        CompressedPathDatabase database(grid, file);
+        double load_ms = elapsedMs(begin);
+
+        // first move latency over random pairs 
+        Random random(Random::mix(seed, t));
+        vector<pair<Position, Position> > pairs;
+        for(int k=0; k<4096; k++)
+            pairs.push_back(make_pair(cells[random.nextInt(cells.size())], cells[random.nextInt(cells.size())]));
+        int lookups = 1000000, checksum = 0;
+        begin = chrono::steady_clock::now();
+        for(int k=0; k<lookups; k++)
+            checksum += database.firstMove(pairs[k & 4095].first, pairs[k & 4095].second);
+        double lookup_ms = elapsedMs(begin);
+
+        // whole paths against A* 
+        AnytimeSearch<> reference(grid);
+        double astar_ms = 0, path_ms = 0;
+        int queries = min(200, (int)cells.size()/2), mismatches = 0;
+        for(int q=0; q<queries; q++)
+        {
+            begin = chrono::steady_clock::now();
+            reference.weightedAStar(cells[2*q], cells[2*q+1], 1.0f);
+            astar_ms += elapsedMs(begin);
+            begin = chrono::steady_clock::now();
+            vector<Position> path = database.path(cells[2*q], cells[2*q+1]);
+            path_ms += elapsedMs(begin);
+            if(fabs(octileLength(path) - reference.getPathCost()) > 1e-2f*max(1.0f, reference.getPathCost()))
+                mismatches++;
+        }
+
+        cout<<MazeGenerator::getName(types[t])<<": "<<cells.size()<<" open cells"<<endl;
+        cout<<"  build "<<build_ms<<" ms, "<<runs<<" runs ("<<(double)runs/cells.size()<<" per source, "
+            <<(double)entries/max(1LL, runs)<<" targets per run)"<<endl;
+        cout<<"  file "<<file_bytes/1024.0<<" KiB (uncompressed 4 bit table "<<entries/2/1024.0<<" KiB), mapped in "<<load_ms<<" ms"
+            <<(database.isMapped() ? "" : " (not mapped!)")<<endl;
+        cout<<"  first move: "<<lookup_ms*1e6/lookups<<" ns per lookup (checksum "<<checksum<<")"<<endl;
+        cout<<"  whole paths: "<<path_ms<<" ms against "<<astar_ms<<" ms for A*, "<<mismatches<<" cost mismatches"<<endl;
+    }
+    remove(file.c_str());
+    return 0;
 }
-void Game::moveDown()
+static int benchTargets(int size, uint64_t seed)
 {
-    int x, y;
-    x = curser.getPosition().row+1;
-    y = curser.getPosition().col;
+    const int QUERIES = 20;
+    Game game(size);
+    game.setVisualize(false);
+    game.generateBoard(MazeGenerator::CELLULAR_AUTOMATA, seed, 0.4f);
+    vector<Position> cells = shuffledReachableCells(game, seed);
+    WalkableBitset grid(game);
+    AnytimeSearch<> reference(grid);
+    MultiTargetSearch search(grid);
+    cout<<"Nearest of k targets on a "<<size<<"x"<<size<<" cave board, "<<QUERIES<<" queries per k (ms in total, expansions per query)"<<endl;
+
+    int counts[] = {1, 4, 16, 64, 256};
+    for(int t=0; t<5; t++)
+    {
+        int k = counts[t];
+        vector<Position> targets(cells.begin() + QUERIES, cells.begin() + QUERIES + k);
+
+        // one A* per target, as a single end forces today 
+        double each_ms = 0;
+        vector<float> nearest_cost(QUERIES), all_costs;
+        bool run_each = k <= 64;
+        for(int q=0; q<QUERIES && run_each; q++)
+        {
+            auto begin = chrono::steady_clock::now();
+            nearest_cost[q] = INFINITY;
+            for(int j=0; j<k; j++)
+            {
+                reference.weightedAStar(cells[q], targets[j], 1.0f);
+                nearest_cost[q] = min(nearest_cost[q], reference.getPathCost());
+                all_costs.push_back(reference.getPathCost());
+            }
+            each_ms += elapsedMs(begin);
+        }
 
-    if(isOutOfBounds(Position(x,y)))
-        return;
-    curser = board[x][y];
-    applyCurser();
+        const char *labels[] = {"Dijkstra", "BFS", "A* (buckets)", "A* (linear)"};
+        MultiTargetSearch::Mode modes[] = {MultiTargetSearch::DIJKSTRA, MultiTargetSearch::BREADTH_FIRST, MultiTargetSearch::A_STAR, MultiTargetSearch::A_STAR_LINEAR};
+        cout<<"k = "<<k<<":"<<endl;
+        if(run_each)
+            cout<<"  A* per target: "<<each_ms<<" ms"<<endl;
+        for(int m=0; m<4; m++)
+        {
+            double ms = 0;
+            long long expanded = 0, probes = 0;
+            int mismatches = 0;
+            for(int q=0; q<QUERIES; q++)
+            {
+                auto begin = chrono::steady_clock::now();
+                vector<Position> path = search.nearest(cells[q], targets, modes[m]);
+                ms += elapsedMs(begin);
+                expanded += search.getExpansions();
+                probes += search.getHeuristicProbes();
+                if(m == 0 && !run_each)
+                    nearest_cost[q] = search.getPathCost();
+                // BFS finds the fewest moves, not the lowest cost 
+                if(modes[m] != MultiTargetSearch::BREADTH_FIRST && fabs(search.getPathCost() - nearest_cost[q]) > 1e-2f * max(1.0f, nearest_cost[q]))
+                    mismatches++;
+                if(fabs(octileLength(path) - search.getPathCost()) > 1e-2f * max(1.0f, search.getPathCost()))
+                    mismatches++;
+            }
+            cout<<"  "<<labels[m]<<": "<<ms<<" ms, "<<expanded/QUERIES<<" expansions";
+            if(probes > 0)
+                cout<<", "<<probes/max(1LL, expanded)<<" targets probed per expansion";
+            cout<<", "<<mismatches<<" mismatches"<<endl;
+        }
+
+        // one-to-many: every distance from one search 
+        double many_ms = 0;
+        int mismatches = 0;
+        for(int q=0; q<QUERIES; q++)
+        {
+            auto begin = chrono::steady_clock::now();
+            vector<float> distances = search.distances(cells[q], targets);
+            many_ms += elapsedMs(begin);
+            for(int j=0; j<k && run_each; j++)
+                if(fabs(distances[j] - all_costs[q*k + j]) > 1e-2f * max(1.0f, all_costs[q*k + j]))
+                    mismatches++;
+        }
+        cout<<"  all distances in one pass: "<<many_ms<<" ms";
+        if(run_each)
+            cout<<", "<<mismatches<<" mismatches against A* per target";
+        cout<<endl;
+    }
+    return 0;
 }
-void Game::moveLeft()
+static int benchTrace(int size, uint64_t seed)
 {
-    int x, y;
-    x = curser.getPosition().row;
-    y = curser.getPosition().col-1;
-
-    if(isOutOfBounds(Position(x,y)))
-        return;
-    curser = board[x][y];
-    applyCurser();
+    // run with and without -DMAZE_TRACE to see what the trace points cost 
+    const int QUERIES = 20, ROUNDS = 3;
+    Game game(size);
+    game.setVisualize(false);
+    game.getPathCache().setBudget(0);
+#ifdef MAZE_TRACE
+    string tracing = "tracing on";
+#else
+    string tracing = "tracing compiled out";
+#endif
+    cout<<"Game searches through solve() on "<<size<<"x"<<size<<" boards, "<<QUERIES<<" queries, best of "<<ROUNDS<<" rounds, "<<tracing<<endl;
+
+    SearchAlgorithm algorithms[] = {DEPTH_FIRST_SEARCH, BREADTH_FIRST_SEARCH, BEST_FIRST_SEARCH, GREEDY_BEST_FIRST_SEARCH, A_STAR_SEARCH};
+    MazeGenerator::GeneratorType types[] = {MazeGenerator::CELLULAR_AUTOMATA, MazeGenerator::ROOMS_AND_CORRIDORS, MazeGenerator::RECURSIVE_BACKTRACKER};
+    double total_ms = 0;
+    for(int t=0; t<3; t++)
+    {
+        game.generateBoard(types[t], seed, 0.4f);
+        vector<Position> cells = shuffledReachableCells(game, seed);
+        int queries = min(QUERIES, (int)cells.size()/2);
+        cout<<MazeGenerator::getName(types[t])<<":";
+        for(int a=0; a<5; a++)
+        {
+            double best_ms = INFINITY;
+            for(int round=0; round<ROUNDS; round++)
+            {
+                auto begin = chrono::steady_clock::now();
+                for(int q=0; q<queries; q++)
+                {
+                    game.setEndpoints(cells[2*q], cells[2*q+1]);
+                    game.solve(algorithms[a]);
+                }
+                best_ms = min(best_ms, elapsedMs(begin));
+            }
+            total_ms += best_ms;
+            cout<<" "<<Game::getAlgorithmName(algorithms[a])<<" "<<best_ms<<" ms"<<(a < 4 ? "," : "");
+        }
+        cout<<endl;
+    }
+    cout<<"Total: "<<total_ms<<" ms"<<endl;
+    return 0;
 }
-void Game::moveRight()
+static int benchParallelBfs(int size, uint64_t seed)
 {
-    int x, y;
-    x = curser.getPosition().row;
-    y = curser.getPosition().col+1;
-
-    if(isOutOfBounds(Position(x,y)))
-        return;
-    curser = board[x][y];
-    applyCurser();
+    // the board is built straight into a bitset: a Game of 10^8 cells would not fit in memory 
+    const float WALL_DENSITY = 0.3f;
+    WalkableBitset grid(size, true);
+    Random random(seed);
+    for(int i=0; i<size; i++)
+        for(int j=0; j<size; j++)
+            if(random.nextFloat() < WALL_DENSITY)
+                grid.setWalkable(i, j, false);
+    Position source(size/2, size/2);
+    grid.setWalkable(source.row, source.col, true);
+    cout<<"Parallel BFS on a "<<size<<"x"<<size<<" random fill, "<<grid.countWalkable()<<" open cells, "
+        <<thread::hardware_concurrency()<<" hardware threads"<<endl;
+
+    // serial reference: a plain queue BFS 
+    auto begin = chrono::steady_clock::now();
+    vector<int32_t> expected((size_t)size*size, -1);
+    vector<int32_t> queue(1, source.row*size + source.col);
+    expected[queue[0]] = 0;
+    for(size_t head=0; head<queue.size(); head++)
+    {
+        int cell = queue[head];
+        int i = cell / size, j = cell % size;
+        for(int di=-1; di<=1; di++)
+            for(int dj=-1; dj<=1; dj++)
+            {
+                int next = cell + di*size + dj;
+                if((di != 0 || dj != 0) && grid.isWalkable(i+di, j+dj) && expected[next] == -1)
+                {
+                    expected[next] = expected[cell] + 1;
+                    queue.push_back(next);
+                }
+            }
+    }
+    double serial_ms = elapsedMs(begin);
+    cout<<"Serial queue BFS: "<<serial_ms<<" ms, "<<queue.size()<<" cells reached"<<endl;
+    vector<int32_t>().swap(queue);
+
+    ParallelBreadthFirstSearch search(grid);
+    int thread_counts[] = {1, 2, 4, 8, 16, 32};
+    double one_thread_ms = 0;
+    for(int t=0; t<6; t++)
+    {
+        begin = chrono::steady_clock::now();
+        search.run(source, thread_counts[t]);
+        double ms = elapsedMs(begin);
+        if(t == 0)
+            one_thread_ms = ms;
+
+        const vector<int32_t> &distances = search.getDistances();
+        long long mismatches = 0;
+        for(size_t k=0; k<distances.size(); k++)
+            if(distances[k] != expected[k])
+                mismatches++;
+        cout<<"  "<<thread_counts[t]<<" threads: "<<ms<<" ms, speed-up "<<one_thread_ms/ms<<", "
+            <<search.getReached()/(ms*1000)<<" M cells/s, "<<search.getLevels()<<" levels ("
+            <<search.getBottomUpLevels()<<" bottom-up), "<<mismatches<<" mismatches"<<endl;
+    }
+    return 0;
 }
-void Game::putEnd()
+static string benchLatencySummary(vector<double> ms)
 {
-    if(curser.isWalkable() && curser != start)
-        end = curser;
+    if(ms.empty())
+        return "-";
+    sort(ms.begin(), ms.end());
+    double total = 0;
+    for(int k=0; k<ms.size(); k++)
+        total += ms[k];
+    ostringstream out;
+    out<<"mean "<<total/ms.size()<<" ms, p50 "<<ms[ms.size()/2]<<" ms, p99 "<<ms[ms.size()*99/100]<<" ms, max "<<ms.back()<<" ms";
+    return out.str();
 }
-void Game::putStart()
+static bool benchSnapshotQuery(const VersionedBoard &board, Position from, Position to, double &ms, uint64_t &versions_behind)
 {
-    if(curser.isWalkable() && curser != end)
-        start = curser;
+    // pins a version, searches it, and checks the path against the same version 
+    auto begin = chrono::steady_clock::now();
+    BoardSnapshot snapshot = board.snapshot();
+    WalkableBitset grid(snapshot);
+    AnytimeSearch<> search(grid);
+    vector<Position> path = search.weightedAStar(from, to, 1.0f);
+    ms = elapsedMs(begin);
+    versions_behind = board.getVersion() - snapshot.getVersion();
+
+    bool valid = path.empty() || (path.front().row == from.row && path.front().col == from.col
+                               && path.back().row == to.row && path.back().col == to.col);
+    for(int k=0; k<path.size() && valid; k++)
+    {
+        valid = snapshot.isWalkable(path[k].row, path[k].col);
+        if(k > 0)
+            valid = valid && abs(path[k].row-path[k-1].row) <= 1 && abs(path[k].col-path[k-1].col) <= 1;
+    }
+    return valid;
 }
-void Game::retracePath()
+static int benchSnapshots(int size, uint64_t seed)
 {
-    // clear the explored buffer 
-    if(end.getParent() == NULL) {
-        cout<<"Parent of End node is NULL!"<<endl;
-        return;
+    const int EDITS = 20000, BATCH = 64, QUERIES = 100;
+    Game game(size);
+    game.setVisualize(false);
+    game.generateBoard(MazeGenerator::CELLULAR_AUTOMATA, seed, 0.4f);
+    vector<Position> cells = shuffledReachableCells(game, seed);
+    int queries = min(QUERIES, (int)cells.size()/2);
+    VersionedBoard board(game);
+    cout<<"Board snapshots on a "<<size<<"x"<<size<<" cave board, "<<BoardSnapshot::TILE<<"x"<<BoardSnapshot::TILE<<" tiles"<<endl;
+
+    // edit throughput alone, checked against a bitset edited in place 
+    WalkableBitset mirror(game);
+    Random random(seed);
+    auto begin = chrono::steady_clock::now();
+    for(int k=0; k<EDITS; k++)
+    {
+        Position cell(random.nextInt(size), random.nextInt(size));
+        bool wall = random.nextInt(2);
+        board.setWall(cell, wall);
+        mirror.setWalkable(cell.row, cell.col, !wall);
     }
-    
-    NodeHandle curr = end.getParent();
-    while(curr.getParent() != NULL && curr != start) 
+    double single_ms = elapsedMs(begin);
+    long long edits = board.getEdits(), copied = board.getTilesCopied(), pointers = board.getPointersCopied();
+    long long versions = board.getVersion(), tiles_per_row = (size + BoardSnapshot::TILE - 1) / BoardSnapshot::TILE;
+
+    vector<pair<Position, bool> > batch;
+    begin = chrono::steady_clock::now();
+    for(int k=0; k<EDITS; k++)
     {
-        // display the progress 
-        system("clear");
-        displayPath();
-        
-        // add a delay 
-        usleep(300000);
+        Position cell(random.nextInt(size), random.nextInt(size));
+        batch.push_back(make_pair(cell, (bool)random.nextInt(2)));
+        mirror.setWalkable(cell.row, cell.col, !batch.back().second);
+        if(batch.size() == BATCH)
+        {
+            board.apply(batch);
+            batch.clear();
+        }
+    }
+    board.apply(batch);
+    double batch_ms = elapsedMs(begin);
 
-        // move to next node
-        curr.markAsVisited();
-        curr = curr.getParent();
-        result.incPathCost();
+    // what an edit would cost if every version were a full copy 
+    begin = chrono::steady_clock::now();
+    for(int k=0; k<EDITS/100; k++)
+    {
+        WalkableBitset copy = mirror;
+        copy.setWalkable(k % size, k % size, false);
     }
+    double full_copy_ms = elapsedMs(begin) * 100;
+
+    bool matches = WalkableBitset(board.snapshot()).checksum() == mirror.checksum();
+    cout<<"Edits: "<<EDITS*1e-3/single_ms<<" M/s one per version ("<<copied/(double)max(1LL, edits)<<" tiles copied per change, "
+        <<pointers/(double)max(1LL, versions)<<" of "<<tiles_per_row*tiles_per_row<<" tile pointers copied per version), "
+        <<EDITS*1e-3/batch_ms<<" M/s in batches of "<<BATCH<<", "<<EDITS*1e-3/full_copy_ms<<" M/s copying the whole board, "
+        <<(matches ? "snapshot matches" : "SNAPSHOT DIFFERS")<<endl;
+
+    // query latency alone, then with a writer streaming edits 
+    for(int concurrent=0; concurrent<2; concurrent++)
+    {
+        atomic<bool> stop(false);
+        atomic<long long> streamed(0);
+        thread writer;
+        if(concurrent)
+            writer = thread([&]() {
+                Random edits_random(Random::mix(seed, 1));
+                while(!stop)
+                {
+                    board.setWall(Position(edits_random.nextInt(size), edits_random.nextInt(size)), edits_random.nextInt(2));
+                    streamed++;
+                }
+            });
 
+        vector<double> latencies;
+        int invalid = 0;
+        uint64_t behind = 0;
+        begin = chrono::steady_clock::now();
+        for(int q=0; q<queries; q++)
+        {
+            double ms;
+            uint64_t versions_behind;
+            invalid += !benchSnapshotQuery(board, cells[2*q], cells[2*q+1], ms, versions_behind);
+            latencies.push_back(ms);
+            behind += versions_behind;
+        }
+        double ms = elapsedMs(begin);
+        stop = true;
+        if(concurrent)
+            writer.join();
+
+        cout<<(concurrent ? "Queries while editing: " : "Queries alone: ")<<benchLatencySummary(latencies)<<", "<<invalid<<" invalid paths";
+        if(concurrent)
+            cout<<", "<<streamed*1e-3/ms<<" M edits/s alongside, "<<behind/(double)queries<<" versions published during a query";
+        cout<<endl;
+    }
+    return 0;
 }
-bool Game::shouldClose()
+static int benchDaemon(int size, uint64_t seed)
 {
-    return should_close;
-}
+    // server and load generator in one process, talking over a real socket 
+    const int QUERIES = 4000;
+    Game game(size);
+    game.setVisualize(false);
+    game.generateBoard(MazeGenerator::CELLULAR_AUTOMATA, seed, 0.4f);
+    WalkableBitset grid(game.snapshot());
+    PathServer server(grid);
+    string socket_path = "/tmp/maze-bench-" + to_string(getpid()) + ".sock";
+    if(!server.listen(socket_path))
+    {
+        cout<<"Can not listen on "<<socket_path<<": "<<strerror(errno)<<endl;
+        return 1;
+    }
+    thread serving(&PathServer::run, &server);
+    cout<<"Path server on a "<<size<<"x"<<size<<" cave board, "<<QUERIES<<" path queries per run"<<endl;
 
-void Game::updateNeighbourCost(NodeHandle curr)
+    PathLoadGenerator load(socket_path, shuffledReachableCells(game, seed));
+    int client_counts[] = {1, 4, 16}, pipelines[] = {1, 16};
+    for(int c=0; c<3; c++)
+        for(int p=0; p<2; p++)
+        {
+            load.run(client_counts[c], QUERIES/client_counts[c], pipelines[p]);
+            cout<<"  "<<client_counts[c]<<" clients, pipeline "<<pipelines[p]<<": "<<load.report()<<endl;
+        }
+    load.run(16, QUERIES/16, 16, PathServer::OP_ROUTE);
+    cout<<"  16 clients, pipeline 16, compact routes: "<<load.report()<<endl;
+
+    // the load only joins reachable cells, so the server's count of queries without a path 
+    // has to be exactly these: to an open pocket cut off from the rest, or to a wall 
+    const int UNREACHABLE = 3;
+    vector<Position> reachable = shuffledReachableCells(game, seed);
+    vector<uint8_t> joined((size_t)size*size, 0);
+    for(int k=0; k<reachable.size(); k++)
+        joined[(size_t)reachable[k].row*size + reachable[k].col] = 1;
+    Position pocket(-1, -1);
+    for(int pass=0; pass<2 && pocket.row < 0; pass++)
+        for(int r=0; r<size && pocket.row < 0; r++)
+            for(int c=0; c<size && pocket.row < 0; c++)
+                if(!joined[(size_t)r*size + c] && game.wallAt(r, c) == (pass == 1))
+                    pocket = Position(r, c);
+    int answered = 0;
+    for(int k=0; k<UNREACHABLE && pocket.row >= 0; k++)
+        answered += load.query(reachable[k], pocket) == PathServer::STATUS_NO_PATH;
+    string stats = load.fetchStats();
+    bool counted = stats.find("), " + to_string(UNREACHABLE) + " without a path") != string::npos;
+    cout<<"  "<<answered<<" of "<<UNREACHABLE<<" queries to "<<pocket<<" answered without a path, "
+        <<(counted ? "all" : "not all")<<" counted"<<endl;
+    cout<<"Server: "<<stats<<endl;
+
+    load.shutdownServer();
+    serving.join();
+    return answered == UNREACHABLE && counted ? 0 : 1;
+}
+static int benchLayouts(int size, uint64_t seed)
 {
-    vector<NodeHandle> neighbours = getNeighbours(curr);
-    for(int i=0; i<neighbours.size(); i++)
+    // the same boards and queries in every layout, through the Node based engines 
+    const int QUERIES = 10;
+    SearchAlgorithm algorithms[] = {BREADTH_FIRST_SEARCH, BEST_FIRST_SEARCH, A_STAR_SEARCH};
+    Board::Layout layouts[] = {Board::ROW_MAJOR, Board::TILED, Board::MORTON};
+    MazeGenerator::GeneratorType types[] = {MazeGenerator::CELLULAR_AUTOMATA, MazeGenerator::RANDOM_FILL};
+    CacheMissCounter misses;
+    cout<<"Board layouts on "<<size<<"x"<<size<<" boards, "<<QUERIES<<" queries per engine, "<<sizeof(Node)<<" byte Nodes, cache miss counter "
+        <<(misses.isAvailable() ? "available" : "not available")<<endl;
+
+    for(int t=0; t<2; t++)
     {
-        
-        if(!neighbours[i].isWalkable())
-            continue;
-        
-        float new_neighbour_cost = curr.getGCost() + getChessBoardDistance(curr, neighbours[i]);
-        if(new_neighbour_cost < neighbours[i].getGCost())
+        cout<<MazeGenerator::getName(types[t])<<":"<<endl;
+        vector<float> reference;
+        for(int l=0; l<3; l++)
         {
-            neighbours[i].setGCost(new_neighbour_cost);
-            neighbours[i].setHCost(getChessBoardDistance(curr, neighbours[i]));
-            neighbours[i].setParent(curr);
+            Game game(size, layouts[l]);
+            game.setVisualize(false);
+            game.getPathCache().setBudget(0);
+            game.generateBoard(types[t], seed, 0.4f);
+            vector<Position> cells = shuffledReachableCells(game, seed);
+            int queries = min(QUERIES, (int)cells.size()/2);
+
+            cout<<"  "<<Board::getName(layouts[l])<<":";
+            int mismatches = 0, checked = 0;
+            for(int a=0; a<3; a++)
+            {
+                long long expanded = 0, missed = 0;
+                double ms = 0;
+                for(int q=0; q<queries; q++)
+                {
+                    game.setEndpoints(cells[2*q], cells[2*q+1]);
+                    auto begin = chrono::steady_clock::now();
+                    misses.start();
+                    vector<Position> path = game.solve(algorithms[a]);
+                    missed += misses.stop();
+                    ms += elapsedMs(begin);
+                    expanded += game.getResult().getSearchCost();
+
+                    // every layout has to find the same paths as row-major 
+                    if(l == 0)
+                        reference.push_back(octileLength(path));
+                    else if(fabs(reference[checked] - octileLength(path)) > 1e-3f)
+                        mismatches++;
+                    checked++;
+                }
+                cout<<" "<<Game::getAlgorithmName(algorithms[a])<<" "<<expanded/(ms*1000)<<" M expansions/s";
+                if(misses.isAvailable())
+                    cout<<" ("<<missed/(double)max(1LL, expanded)<<" misses per expansion)";
+                cout<<",";
+            }
+            cout<<" "<<mismatches<<" mismatches"<<endl;
         }
     }
+    return 0;
 }
-
-
-
-// Node Method definations --> 
-Node::Node()
+static int benchRoutes(int size, uint64_t seed)
 {
-    is_walkable = true;
-    visited=false;
-    explored = false;
-    parent = NULL;
-    gCost = 100000;
-    hCost = 100000;
+    // the same searches returning vectors and compact routes, then round trips of both kinds of paths 
+    const int QUERIES = 200;
+    cout<<"Compact paths on "<<size<<"x"<<size<<" boards, "<<QUERIES<<" queries per board"<<endl;
+    MazeGenerator::GeneratorType types[] = {MazeGenerator::RECURSIVE_BACKTRACKER, MazeGenerator::CELLULAR_AUTOMATA};
+    for(int t=0; t<2; t++)
+    {
+        Game game(size);
+        game.setVisualize(false);
+        game.generateBoard(types[t], seed, 0.4f);
+        WalkableBitset grid(game.snapshot());
+        AnytimeSearch<> search(grid);
+        AnyAngleSearch any_angle(grid);
+        vector<Position> cells = shuffledReachableCells(game, seed);
+        int queries = min(QUERIES, (int)cells.size()/2);
+
+        double vector_ms = 0, route_ms = 0, walk_ms = 0;
+        long long positions = 0, route_bytes = 0, waypoints = 0, waypoint_bytes = 0;
+        int mismatches = 0;
+        for(int q=0; q<queries; q++)
+        {
+            auto begin = chrono::steady_clock::now();
+            vector<Position> path = search.weightedAStar(cells[2*q], cells[2*q+1], 1.0f);
+            vector_ms += elapsedMs(begin);
+
+            begin = chrono::steady_clock::now();
+            const CompactPath &route = search.weightedAStarRoute(cells[2*q], cells[2*q+1], 1.0f);
+            route_ms += elapsedMs(begin);
+
+            // a walk over the lazily expanded cells, the way a consumer reads a route 
+            begin = chrono::steady_clock::now();
+            long long checksum = 0;
+            for(CompactPath::Iterator it=route.begin(); it!=route.end(); ++it)
+                checksum += (*it).row ^ (*it).col;
+            walk_ms += elapsedMs(begin);
+            positions += route.size();
+            route_bytes += route.getByteSize();
+
+            string wire;
+            route.encode(wire);
+            CompactPath decoded;
+            vector<Position> expanded = decoded.decode((const uint8_t*)wire.data(), wire.size()) ? decoded.toVector() : vector<Position>(1);
+            bool same = expanded.size() == path.size();
+            for(int k=0; k<path.size() && same; k++)
+            {
+                same = expanded[k].row == path[k].row && expanded[k].col == path[k].col;
+                checksum -= path[k].row ^ path[k].col;
+            }
+            same = same && checksum == 0;
+            if(!same || fabs(route.getLength() - octileLength(path)) > 1e-2f*max(1.0f, octileLength(path)))
+                mismatches++;
+            if(q == 0)
+            {
+                string file = "/tmp/maze-bench-" + to_string(getpid()) + ".route";
+                CompactPath loaded;
+                if(!route.save(file) || !loaded.load(file) || loaded.toVector().size() != path.size() || !(loaded.getEnd() == route.getEnd()))
+                    mismatches++;
+                remove(file.c_str());
+            }
+
+            // any-angle waypoints are mostly jumps 
+            vector<Position> taut = any_angle.thetaStar(cells[2*q], cells[2*q+1]);
+            CompactPath jumps(taut);
+            expanded = jumps.toVector();
+            same = expanded.size() == taut.size();
+            for(int k=0; k<taut.size() && same; k++)
+                same = expanded[k].row == taut[k].row && expanded[k].col == taut[k].col;
+            if(!same)
+                mismatches++;
+            waypoints += taut.size();
+            waypoint_bytes += jumps.getByteSize();
+        }
+        cout<<"  "<<MazeGenerator::getName(types[t])<<": "<<positions/max(1, queries)<<" cells per path, "
+            <<(double)route_bytes/max(1LL, positions)<<" bytes per cell compact vs "<<sizeof(Position)<<" as Positions and 4 as uint16 pairs; "
+            <<"search "<<vector_ms<<" ms returning vectors, "<<route_ms<<" ms returning routes, walk "<<walk_ms<<" ms; "
+            <<"any-angle "<<(double)waypoint_bytes/max(1LL, waypoints)<<" bytes per waypoint; "<<mismatches<<" mismatches"<<endl;
+    }
+    return 0;
 }
-bool Node::isWalkable() const
+static int benchPortfolio(int size, uint64_t seed)
 {
-    return is_walkable;
+    // first every racer runs to the end to learn the margins, then the losers are cancelled 
+    const int QUERIES = 10;
+    vector<SearchAlgorithm> algorithms;
+    for(int algorithm=DEPTH_FIRST_SEARCH; algorithm<=A_STAR_SEARCH; algorithm++)
+        algorithms.push_back((SearchAlgorithm)algorithm);
+    cout<<"Portfolio of the five Node based searches on "<<size<<"x"<<size<<" boards, "<<QUERIES<<" queries per board, "
+        <<thread::hardware_concurrency()<<" hardware threads"<<endl;
+
+    for(int type=MazeGenerator::RECURSIVE_BACKTRACKER; type<=MazeGenerator::RANDOM_FILL; type++)
+    {
+        MazeGenerator::GeneratorType generator = (MazeGenerator::GeneratorType)type;
+        Game game(size);
+        game.setVisualize(false);
+        game.getPathCache().setBudget(0);
+        game.generateBoard(generator, seed, generator == MazeGenerator::RANDOM_FILL ? 0.25f : 0.42f);
+        vector<Position> cells = shuffledReachableCells(game, seed);
+        int queries = min(QUERIES, (int)cells.size()/2);
+        cout<<MazeGenerator::getName(generator)<<":"<<endl;
+
+        PortfolioSolver learning(game, algorithms);
+        learning.setCancelLosers(false);
+        for(int q=0; q<queries; q++)
+        {
+            game.setEndpoints(cells[2*q], cells[2*q+1]);
+            learning.solve(INFINITY);
+        }
+        cout<<"  any path, all finish   : "<<learning.summary()<<endl;
+
+        float ratios[] = {INFINITY, sqrtf(2.0f), 1.0f};
+        for(int r=0; r<3; r++)
+        {
+            PortfolioSolver portfolio(game, algorithms);
+            double portfolio_ms = 0, a_star_ms = 0;
+            int violations = 0;
+            for(int q=0; q<queries; q++)
+            {
+                game.setEndpoints(cells[2*q], cells[2*q+1]);
+                auto begin = chrono::steady_clock::now();
+                vector<Position> path = game.solve(A_STAR_SEARCH);
+                a_star_ms += elapsedMs(begin);
+                float optimal = octileLength(path);
+
+                begin = chrono::steady_clock::now();
+                path = portfolio.solve(ratios[r]);
+                portfolio_ms += elapsedMs(begin);
+                if(octileLength(path) > ratios[r]*optimal*1.0001f || path.empty() != (optimal == 0 && path.empty()))
+                    violations++;
+            }
+            cout<<"  ratio "<<ratios[r]<<(r == 0 ? "      " : r == 1 ? " " : "          ")<<": "<<portfolio_ms<<" ms against "<<a_star_ms
+                <<" ms for A* alone, "<<violations<<" ratio violations; "<<portfolio.summary()<<endl;
+        }
+    }
+    return 0;
 }
-void Node::setPosition(Position pos)
+static int benchKernels(int size, uint64_t seed)
 {
-    this->pos=pos;
-}
-
+    // whole searches per kernel, then the kernel alone on the expanded cells of those searches 
+    const int QUERIES = 40;
+    NeighbourKernel::Kind kinds[] = {NeighbourKernel::SCALAR, NeighbourKernel::SSE2, NeighbourKernel::AVX2};
+    cout<<"Neighbour kernels on "<<size<<"x"<<size<<" boards, "<<QUERIES<<" weighted A* queries, best kernel here: "
+        <<NeighbourKernel::getName(NeighbourKernel::best())<<endl;
+    MazeGenerator::GeneratorType types[] = {MazeGenerator::CELLULAR_AUTOMATA, MazeGenerator::RANDOM_FILL};
+    for(int t=0; t<2; t++)
+    {
+        Game game(size);
+        game.setVisualize(false);
+        game.generateBoard(types[t], seed, types[t] == MazeGenerator::RANDOM_FILL ? 0.25f : 0.4f);
+        WalkableBitset grid(game.snapshot());
+        AnytimeSearch<> search(grid);
+        vector<Position> cells = shuffledReachableCells(game, seed);
+        int queries = min(QUERIES, (int)cells.size()/2);
+        cout<<MazeGenerator::getName(types[t])<<":"<<endl;
+
+        vector<float> g((size_t)size*size);
+        Random random(seed);
+        for(size_t k=0; k<g.size(); k++)
+            g[k] = random.nextInt(1000);
+        vector<int> probes;
+        for(int k=0; k<cells.size() && probes.size() < 100000; k++)
+            probes.push_back(cells[k].row*size + cells[k].col);
+
+        vector<float> reference;
+        for(int k=0; k<3; k++)
+        {
+            if(!NeighbourKernel::isSupported(kinds[k]))
+                continue;
+            search.setKernel(kinds[k]);
+            long long expansions = 0;
+            int mismatches = 0;
+            double ms = 0;
+            for(int q=0; q<queries; q++)
+            {
+                float epsilon = q % 2 == 0 ? 1.0f : 3.0f;
+                auto begin = chrono::steady_clock::now();
+                search.weightedAStar(cells[2*q], cells[2*q+1], epsilon);
+                ms += elapsedMs(begin);
+                expansions += search.getExpansions();
+                // every kernel has to reproduce the scalar search exactly 
+                if(k == 0)
+                    reference.push_back(search.getPathCost() + search.getExpansions());
+                else if(reference[q] != search.getPathCost() + search.getExpansions())
+                    mismatches++;
+            }
 
+            NeighbourKernel::Function kernel = NeighbourKernel::get(kinds[k]);
+            NeighbourKernel::Batch batch;
+            long long improved = 0;
+            auto begin = chrono::steady_clock::now();
+            for(int repeat=0; repeat<10; repeat++)
+                for(int p=0; p<probes.size(); p++)
+                {
+                    int cell = probes[p];
+                    improved += __builtin_popcount(kernel(&g[0], cell, size, grid.neighbourMask(cell/size, cell%size), probes[0], 1.0f, batch));
+                }
+            double kernel_ns = elapsedMs(begin)*1e6/(10.0*max((size_t)1, probes.size()));
 
-// NodeHandle Method definations --> 
-NodeHandle::NodeHandle(Node *ptr)
-{
-    node = ptr;
-}
-NodeHandle::NodeHandle(Node &node)
-{
-    this->node = &node;
+            cout<<"  "<<NeighbourKernel::getName(kinds[k])<<": "<<ms*1e6/max(1LL, expansions)<<" ns per expansion in weighted A*, "
+                <<kernel_ns<<" ns per kernel call ("<<improved<<" improvements), "<<mismatches<<" mismatches"<<endl;
+        }
+    }
+    return 0;
 }
-float NodeHandle::getGCost() const
+static int benchAdaptive(int size, uint64_t seed)
 {
-    return node->gCost;
+    // a stream of queries from random starts to a few goals, with a wall opened or closed every 
+    // EDIT_EVERY queries; plain A* on the same stream is the reference 
+    const int QUERIES = 400, GOALS = 4, EDIT_EVERY = 20;
+    cout<<"Adaptive A* on "<<size<<"x"<<size<<" boards, "<<QUERIES<<" queries to "<<GOALS<<" goals, a wall edit every "<<EDIT_EVERY<<" queries"<<endl;
+    MazeGenerator::GeneratorType types[] = {MazeGenerator::CELLULAR_AUTOMATA, MazeGenerator::ROOMS_AND_CORRIDORS, MazeGenerator::RANDOM_FILL};
+    for(int t=0; t<3; t++)
+    {
+        Game game(size);
+        game.setVisualize(false);
+        game.generateBoard(types[t], seed, types[t] == MazeGenerator::RANDOM_FILL ? 0.25f : 0.4f);
+        WalkableBitset grid(game.snapshot());
+        AdaptiveAStar<> plain(grid), adaptive(grid);
+        plain.setLearning(false);
+        vector<Position> cells = shuffledReachableCells(game, seed);
+        if(cells.size() < GOALS + 1)
+            continue;
+
+        Random random(seed + t);
+        long long plain_expansions = 0, adaptive_expansions = 0, learned = 0, second_half[2] = {0, 0};
+        double plain_ms = 0, adaptive_ms = 0;
+        int mismatches = 0, edits = 0;
+        for(int q=0; q<QUERIES; q++)
+        {
+            if(q > 0 && q % EDIT_EVERY == 0)
+            {
+                // toggle a random cell that is not a goal 
+                Position pos(random.nextInt(size), random.nextInt(size));
+                bool goal = false;
+                for(int k=0; k<GOALS; k++)
+                    goal = goal || (cells[k].row == pos.row && cells[k].col == pos.col);
+                if(!goal)
+                {
+                    bool wall = grid.isWalkable(pos.row, pos.col);
+                    grid.setWalkable(pos.row, pos.col, !wall);
+                    plain.setWall(pos, wall);
+                    adaptive.setWall(pos, wall);
+                    edits++;
+                }
+            }
+            Position from = cells[GOALS + random.nextInt(cells.size() - GOALS)], to = cells[q % GOALS];
+            auto begin = chrono::steady_clock::now();
+            plain.findPath(from, to);
+            plain_ms += elapsedMs(begin);
+            begin = chrono::steady_clock::now();
+            adaptive.findPath(from, to);
+            adaptive_ms += elapsedMs(begin);
+
+            plain_expansions += plain.getExpansions();
+            adaptive_expansions += adaptive.getExpansions();
+            learned += adaptive.getLearnedCount();
+            if(q >= QUERIES/2)
+            {
+                second_half[0] += plain.getExpansions();
+                second_half[1] += adaptive.getExpansions();
+            }
+            // learning must never cost optimality 
+            if(fabs(plain.getPathCost() - adaptive.getPathCost()) > 1e-3f * max(1.0f, plain.getPathCost())
+               && !(plain.getPathCost() == INFINITY && adaptive.getPathCost() == INFINITY))
+                mismatches++;
+        }
+        cout<<"  "<<MazeGenerator::getName(types[t])<<": A* "<<plain_expansions<<" expansions in "<<plain_ms<<" ms, adaptive "
+            <<adaptive_expansions<<" in "<<adaptive_ms<<" ms ("<<100.0*(plain_expansions - adaptive_expansions)/max(1LL, plain_expansions)
+            <<"% fewer, "<<100.0*(second_half[0] - second_half[1])/max(1LL, second_half[0])<<"% fewer in the second half), "
+            <<learned<<" h values learned, "<<adaptive.getRepairedCount()<<" repaired over "<<edits<<" edits, "<<mismatches<<" cost mismatches"<<endl;
+    }
+    return 0;
 }
-float NodeHandle::getHCost() const
+static int benchMemoryBounded(int size, uint64_t seed)
 {
-    return Game::getChessBoardDistance(*this, *end);
+    // each query gets room for its A* path plus a fraction of the other cells A* expands for it, 
+    // in SMA* nodes; a path SMA* returns must cost what A*'s does. Each query may generate at 
+    // most MAX_GENERATED nodes, SMA* can take exponential time with no room to spare 
+    const int QUERIES = 20;
+    const long long MAX_GENERATED = 500000;
+    const double FRACTIONS[] = {1, 0.5, 0.25, 0};
+    cout<<"SMA* on "<<size<<"x"<<size<<" boards, "<<QUERIES<<" queries, "<<MemoryBoundedSearch::getBytesPerNode()<<" bytes a node"<<endl;
+    MazeGenerator::GeneratorType types[] = {MazeGenerator::CELLULAR_AUTOMATA, MazeGenerator::ROOMS_AND_CORRIDORS, MazeGenerator::RANDOM_FILL};
+    for(int t=0; t<3; t++)
+    {
+        Game game(size);
+        game.setVisualize(false);
+        game.generateBoard(types[t], seed, types[t] == MazeGenerator::RANDOM_FILL ? 0.25f : 0.4f);
+        WalkableBitset grid(game.snapshot());
+        AdaptiveAStar<> plain(grid);
+        plain.setLearning(false);
+        vector<Position> cells = shuffledReachableCells(game, seed);
+        int queries = min(QUERIES, (int)cells.size()/2);
+        cout<<"  "<<MazeGenerator::getName(types[t])<<endl;
+        for(int f=0; f<4; f++)
+        {
+            long long regenerations = 0, forgotten = 0, generated = 0, astar_expansions = 0;
+            double ms = 0, budget_sum = 0, peak_sum = 0;
+            int solved = 0, gave_up = 0, mismatches = 0, over_budget = 0;
+            for(int q=0; q<queries; q++)
+            {
+                Position from = cells[2*q], to = cells[2*q+1];
+                long long length = plain.findPath(from, to).size();
+                astar_expansions += plain.getExpansions();
+                size_t nodes = length + (size_t)(FRACTIONS[f]*max(0LL, plain.getExpansions() - length));
+                size_t budget = nodes*MemoryBoundedSearch::getBytesPerNode() + 64;
+                MemoryBoundedSearch search(grid, budget);
+                auto begin = chrono::steady_clock::now();
+                vector<Position> path = search.findPath(from, to, SearchBudget(MAX_GENERATED));
+                ms += elapsedMs(begin);
+
+                regenerations += search.getRegenerations();
+                forgotten += search.getForgottenCount();
+                generated += search.getExpansions();
+                budget_sum += budget;
+                peak_sum += search.getPeakBytes();
+                if(search.getPeakBytes() > budget)
+                    over_budget++;
+                if(search.isOutOfBudget())
+                    gave_up++;
+                if(path.empty())
+                    continue;
+                solved++;
+                if(fabs(plain.getPathCost() - search.getPathCost()) > 1e-3f * max(1.0f, plain.getPathCost()))
+                    mismatches++;
+            }
+            cout<<"    path + "<<FRACTIONS[f]<<" of the rest of A*: "<<solved<<"/"<<queries<<" solved, "<<gave_up<<" gave up, "
+                <<ms<<" ms, peak "<<peak_sum/1024/queries<<" of "<<budget_sum/1024/queries<<" KiB on average, "
+                <<generated<<" generated ("<<astar_expansions<<" A* expansions), "<<regenerations<<" regenerated, "<<forgotten
+                <<" forgotten, "<<mismatches<<" cost mismatches, "<<over_budget<<" over budget"<<endl;
+        }
+    }
+    return 0;
 }
-float NodeHandle::getFCost() const
+template<class OpenList>
+static void benchVoxelRun(VoxelSearch<OpenList> &search, SearchAlgorithm algorithm, Voxel from, Voxel to, long long max_expansions,
+                          double &ms, long long &expansions, double &scratch_mib, int &gave_up)
 {
-    return getGCost()+getHCost();
+    auto begin = chrono::steady_clock::now();
+    search.begin(algorithm, from, to);
+    if(search.step(max_expansions) == VoxelSearch<OpenList>::RUNNING)
+        gave_up++;
+    ms += elapsedMs(begin);
+    expansions += search.getExpansions();
+    scratch_mib += search.getScratchBytes() / 1048576.0;
 }
-
-Node* NodeHandle::getParent()
+static int benchVoxels(int size, uint64_t seed)
 {
-    return node->parent;
+    // a random fill and a building of size^3 voxels, saved and loaded back, then A* between 
+    // voxels up to RADIUS apart and breadth-first search up to BFS_RADIUS apart with every 
+    // connectivity. With faces only every move costs 1 and BFS must match A*; otherwise A* is 
+    // never worse. A query gives up after MAX_EXPANSIONS, as a walled in voxel would flood the volume 
+    const int QUERIES = 20, RADIUS = 128, BFS_RADIUS = 24;
+    const long long MAX_EXPANSIONS = 4000000;
+    cout<<"Voxel grids of "<<size<<"^3, "<<QUERIES<<" queries, A* up to "<<RADIUS<<" and BFS up to "<<BFS_RADIUS<<" voxels apart"<<endl;
+    string file = "/tmp/maze_voxels_" + to_string(getpid()) + ".vox";
+    for(int kind=0; kind<2; kind++)
+    {
+        auto begin = chrono::steady_clock::now();
+        VoxelGrid generated(size, size, size);
+        if(kind == 0)
+            generated.fillRandom(seed, 0.25f);
+        else
+            generated.fillBuilding(seed, 8, 0.25f);
+        double generate_ms = elapsedMs(begin);
+        begin = chrono::steady_clock::now();
+        bool saved = generated.save(file);
+        double save_ms = elapsedMs(begin);
+        begin = chrono::steady_clock::now();
+        VoxelGrid grid;
+        bool loaded = saved && grid.load(file);
+        double load_ms = elapsedMs(begin);
+        remove(file.c_str());
+        if(!loaded || grid.checksum() != generated.checksum())
+        {
+            cout<<"  could not save and load "<<file<<endl;
+            return 1;
+        }
+        cout<<"  "<<(kind == 0 ? "Random fill" : "Building, storeys of 8")<<": "<<grid.countWalkable()<<" walkable, generated in "
+            <<generate_ms<<" ms, "<<(size_t)size*size*((size + 63)/64*8)/1048576.0<<" MiB saved in "<<save_ms<<" ms, loaded in "<<load_ms<<" ms"<<endl;
+
+        // endpoints: a walkable voxel, and one at most radius away on every axis 
+        Random random(seed + kind);
+        auto pick = [&](int radius, Voxel &from, Voxel &to) {
+            do
+                from = Voxel(random.nextInt(size), random.nextInt(size), random.nextInt(size));
+            while(!grid.isWalkable(from.row, from.col, from.layer));
+            do
+                to = Voxel(from.row + (int)random.nextInt(2*radius + 1) - radius, from.col + (int)random.nextInt(2*radius + 1) - radius,
+                           from.layer + (int)random.nextInt(2*radius + 1) - radius);
+            while(!grid.isWalkable(to.row, to.col, to.layer) || to == from);
+        };
+        VoxelGrid::Connectivity connectivities[] = {VoxelGrid::FACES, VoxelGrid::EDGES, VoxelGrid::CORNERS};
+        for(int c=0; c<3; c++)
+        {
+            VoxelSearch<> astar(grid, connectivities[c]), bfs(grid, connectivities[c]);
+            VoxelSearch<BucketQueueOpenList<uint32_t> > bucket(grid, connectivities[c]);
+            double ms[4] = {0, 0, 0, 0}, scratch[4] = {0, 0, 0, 0};
+            long long expansions[4] = {0, 0, 0, 0};
+            int gave_up = 0, mismatches = 0;
+            float worst_gap = 0;
+            for(int q=0; q<QUERIES; q++)
+            {
+                Voxel from, to;
+                pick(RADIUS, from, to);
+                benchVoxelRun(astar, A_STAR_SEARCH, from, to, MAX_EXPANSIONS, ms[0], expansions[0], scratch[0], gave_up);
+                benchVoxelRun(bucket, A_STAR_SEARCH, from, to, MAX_EXPANSIONS, ms[1], expansions[1], scratch[1], gave_up);
+                if(astar.getStatus() == VoxelSearch<>::FOUND)
+                    worst_gap = max(worst_gap, bucket.getPathCost() - astar.getPathCost());
+
+                pick(BFS_RADIUS, from, to);
+                benchVoxelRun(bfs, BREADTH_FIRST_SEARCH, from, to, MAX_EXPANSIONS, ms[2], expansions[2], scratch[2], gave_up);
+                benchVoxelRun(astar, A_STAR_SEARCH, from, to, MAX_EXPANSIONS, ms[3], expansions[3], scratch[3], gave_up);
+                if(bfs.getStatus() != astar.getStatus()
+                   || (connectivities[c] == VoxelGrid::FACES && bfs.getPathCost() != astar.getPathCost())
+                   || astar.getPathCost() > bfs.getPathCost() + 1e-3f)
+                    mismatches++;
+            }
+            cout<<"    "<<connectivities[c]<<"-connected: A* "<<expansions[0]/QUERIES<<" expansions, "<<ms[0]/QUERIES<<" ms, "
+                <<scratch[0]/QUERIES<<" MiB scratch a query (bucket queue "<<ms[1]/QUERIES<<" ms, at most "<<worst_gap
+                <<" longer); BFS "<<expansions[2]/QUERIES<<" expansions, "<<ms[2]/QUERIES<<" ms, "<<scratch[2]/QUERIES
+                <<" MiB against A* "<<expansions[3]/QUERIES<<", "<<ms[3]/QUERIES<<" ms; "<<mismatches<<" mismatches, "<<gave_up<<" gave up"<<endl;
+        }
+    }
+    return 0;
 }
-Position NodeHandle::getPosition() const
+static int benchViewport(int size, uint64_t seed)
 {
-    return node->pos;
+    // an A* search watched the way stepSearch draws it, STEP expansions between frames, at a 
+    // few terminal sizes, against drawing the whole board once. The tile counts kept along 
+    // the way are checked against a recount at the end 
+    const int FRAMES = 200, STEP = 2000;
+    const int TERMINALS[3][2] = {{24, 80}, {50, 200}, {100, 400}};
+    Game game(size);
+    game.setVisualize(false);
+    auto begin = chrono::steady_clock::now();
+    game.generateBoard(MazeGenerator::RANDOM_FILL, seed, 0.25f);
+    cout<<"Viewport on a "<<size<<"x"<<size<<" board, generated in "<<elapsedMs(begin)<<" ms, "<<FRAMES
+        <<" frames of an A* search, "<<STEP<<" expansions apart"<<endl;
+    game.setEndpoints(Position(size/8, size/8), Position(size - size/8, size - size/8));
+
+    for(int t=0; t<3; t++)
+    {
+        game.clearBuffer(BUFFER_ALL_BIT);
+        game.getResult().reset();
+        game.setTerminalSize(TERMINALS[t][0], TERMINALS[t][1]);
+        GameSearch<> search(game, A_STAR_SEARCH);
+        double ms = 0, worst_ms = 0;
+        size_t bytes = 0;
+        int frames = 0;
+        for(; frames<FRAMES && search.step(STEP) == GameSearch<>::RUNNING; frames++)
+        {
+            begin = chrono::steady_clock::now();
+            vector<Position> frontier;
+            search.forEachFrontier([&](NodeHandle node) { frontier.push_back(node.getPosition()); });
+            game.getViewport().follow(search.getCurrent().getPosition());
+            bytes += game.renderFrame(true, false, frontier).size();
+            double frame_ms = elapsedMs(begin);
+            ms += frame_ms;
+            worst_ms = max(worst_ms, frame_ms);
+        }
+        Viewport &viewport = game.getViewport();
+        cout<<"  "<<TERMINALS[t][0]<<"x"<<TERMINALS[t][1]<<" terminal: "<<viewport.getRows()<<"x"<<viewport.getCols()<<" cells and "
+            <<viewport.getBlocks()<<"x"<<viewport.getBlocks()<<" minimap blocks, "<<ms/max(1, frames)<<" ms a frame (worst "<<worst_ms
+            <<"), "<<bytes/max(1, frames)<<" bytes, "<<search.getExpansions()<<" expanded"<<endl;
+    }
+
+    // a terminal the whole board fits in, as every frame used to be drawn 
+    game.setTerminalSize(size + Viewport::RESERVED_ROWS, 2*size);
+    begin = chrono::steady_clock::now();
+    size_t bytes = game.renderFrame(true, false).size();
+    cout<<"  whole board: "<<elapsedMs(begin)<<" ms a frame, "<<bytes<<" bytes"<<endl;
+
+    // every mark of every tile against a recount of the board, mid-search and once a 
+    // search ran to the end and retraced its path 
+    int mismatches = 0;
+    auto check = [&]() {
+        const TileSummary &tiles = game.getTileSummary();
+        TileSummary recount = game.recountTiles();
+        for(int i=0; i<tiles.getTilesPerRow(); i++)
+            for(int j=0; j<tiles.getTilesPerRow(); j++)
+            {
+                TileSummary::Counts kept = tiles.sum(i, j, i+1, j+1), counted = recount.sum(i, j, i+1, j+1);
+                for(int m=0; m<TileSummary::MARKS; m++)
+                    mismatches += kept.marks[m] != counted.marks[m];
+            }
+    };
+    check();
+    game.setEndpoints(Position(size/2, size/2), Position(min(size-1, size/2 + 64), min(size-1, size/2 + 48)));
+    game.getResult().reset();
+    game.aStarSearch();
+    game.renderFrame(false, true);
+    check();
+    cout<<"  finished search: "<<game.getResult().getSearchCost()<<" expanded, "<<game.getResult().getPathCost()<<" path cells; "
+        <<mismatches<<" tile summary mismatches"<<endl;
+    return mismatches == 0 ? 0 : 1;
 }
-void NodeHandle::insertWall()
+static int benchAlternatives(int size, uint64_t seed)
 {
-    if(*start != *this && *end != *this)
-        node->is_walkable = false;
+    // K shortest loopless routes with the goal's tree reused and without it (every spur an A* 
+    // from the octile distance, as plain Yen), which must agree on every cost, then K diverse 
+    // routes from the penalty method on the tree Yen grew. Half the queries share a goal with the query before. 
+    // Times per extra route leave out the first route and the tree grown for it 
+    const int QUERIES = 20, K = 8;
+    cout<<"Alternative routes on "<<size<<"x"<<size<<" boards, "<<QUERIES<<" queries, "<<K<<" routes each"<<endl;
+    MazeGenerator::GeneratorType types[] = {MazeGenerator::RANDOM_FILL, MazeGenerator::CELLULAR_AUTOMATA, MazeGenerator::ROOMS_AND_CORRIDORS};
+    for(int t=0; t<3; t++)
+    {
+        Game game(size);
+        game.setVisualize(false);
+        game.generateBoard(types[t], seed, types[t] == MazeGenerator::RANDOM_FILL ? 0.25f : 0.4f);
+        WalkableBitset grid(game.snapshot());
+        AlternativeRoutes<> reused(grid), plain(grid);
+        plain.setTreeReuse(false);
+        vector<Position> cells = shuffledReachableCells(game, seed);
+        if(cells.size() < QUERIES + 1)
+            continue;
+
+        // first route ms, extra routes ms, extra routes, expansions; for reused, plain and diverse 
+        double first_ms[3] = {0, 0, 0}, extra_ms[3] = {0, 0, 0};
+        long long extra_routes[3] = {0, 0, 0}, expansions[3] = {0, 0, 0};
+        int mismatches = 0, invalid = 0;
+        float overlap = 0, worst_ratio = 1;
+        AlternativeRoutes<> *searches[3] = {&reused, &plain, &reused};
+        for(int q=0; q<QUERIES; q++)
+        {
+            Position from = cells[q+1], to = cells[q - q%2];
+            vector<AlternativeRoutes<>::Route> routes[3];
+            for(int s=0; s<3; s++)
+            {
+                routes[s] = s < 2 ? searches[s]->kShortest(from, to, K) : searches[s]->diverse(from, to, K);
+                expansions[s] += searches[s]->getExpansions();
+                for(int r=0; r<routes[s].size(); r++)
+                {
+                    (r == 0 ? first_ms[s] : extra_ms[s]) += routes[s][r].ms;
+                    extra_routes[s] += r > 0;
+                }
+            }
+
+            // every route loopless, in steps of one cell, distinct, and Yen's in order of cost 
+            for(int s=0; s<3; s++)
+            {
+                set<vector<int> > distinct;
+                for(int r=0; r<routes[s].size(); r++)
+                {
+                    const vector<Position> &path = routes[s][r].path;
+                    vector<int> flat;
+                    set<int> visited;
+                    Position first = path.front(), last = path.back();
+                    bool valid = first == from && last == to;
+                    for(int k=0; k<path.size(); k++)
+                    {
+                        flat.push_back(path[k].row*size + path[k].col);
+                        valid = valid && visited.insert(flat.back()).second && !game.wallAt(path[k].row, path[k].col);
+                        if(k > 0)
+                            valid = valid && max(abs(path[k].row - path[k-1].row), abs(path[k].col - path[k-1].col)) == 1;
+                    }
+                    valid = valid && distinct.insert(flat).second;
+                    if(s < 2 && r > 0)
+                        valid = valid && routes[s][r].cost >= routes[s][r-1].cost - 1e-3f;
+                    invalid += !valid;
+                }
+            }
+            if(routes[0].size() != routes[1].size())
+                mismatches++;
+            else
+                for(int r=0; r<routes[0].size(); r++)
+                    if(fabs(routes[0][r].cost - routes[1][r].cost) > 1e-3f)
+                        mismatches++;
+            for(int r=1; r<routes[2].size(); r++)
+            {
+                overlap += routes[2][r].overlap / (routes[2].size() - 1) / QUERIES;
+                worst_ratio = max(worst_ratio, routes[2][r].cost / routes[2][0].cost);
+            }
+        }
+
+        const char *labels[3] = {"Yen, tree reused", "Yen, plain", "Diverse, penalty 1"};
+        cout<<MazeGenerator::getName(types[t])<<": "<<reused.getTreeBuilds()<<" trees grown, "<<reused.getTreeMs()<<" ms the last"<<endl;
+        for(int s=0; s<3; s++)
+        {
+            cout<<"  "<<labels[s]<<": first route "<<first_ms[s]/QUERIES<<" ms, "<<extra_routes[s]<<" extra routes at "
+                <<extra_ms[s]/max(1LL, extra_routes[s])<<" ms each, "<<expansions[s]/QUERIES<<" expansions a query";
+            if(s == 2)
+                cout<<", "<<100*overlap<<"% of cells shared with earlier routes, at most "<<worst_ratio<<"x the shortest";
+            cout<<endl;
+        }
+        cout<<"  "<<mismatches<<" cost mismatches, "<<invalid<<" invalid routes"<<endl;
+    }
+    return 0;
 }
-bool NodeHandle::isExplored()
+template<class OpenList>
+static int benchOpenListPolicy(const string &name, Game &game, const vector<Position> &cells, int queries, vector<double> &exact)
 {
-    return node->explored;
+    // the first policy run (an exact one) fills exact with the cost per algorithm and query; 
+    // A* and best-first paths of a quantized policy may cost up to KEY_STEP more per move; 
+    // greedy has no bound, but on a MONOTONE policy it runs on the binary heap and must match 
+    double ms[3] = {0, 0, 0}, cost[3] = {0, 0, 0}, worst[3] = {0, 0, 0};
+    long long expansions[3] = {0, 0, 0};
+    int out_of_tolerance = 0;
+    bool reference = exact.empty();
+    for(int algorithm=0; algorithm<3; algorithm++)
+    {
+        for(int q=0; q<queries; q++)
+        {
+            game.setEndpoints(cells[2*q], cells[2*q+1]);
+            game.getResult().reset();
+
+            auto begin = chrono::steady_clock::now();
+            if(algorithm == 0)
+                game.aStarSearch<OpenList>();
+            else if(algorithm == 1)
+                game.bestFirstSearch<OpenList>();
+            else
+                game.greedyBestFirstSearch<OpenList>();
+            ms[algorithm] += elapsedMs(begin);
+
+            expansions[algorithm] += game.getResult().getSearchCost();
+            vector<Position> path = game.getPath();
+            double length = octileLength(path);
+            cost[algorithm] += length;
+            if(reference)
+                exact.push_back(length);
+            else
+            {
+                double excess = length - exact[algorithm*queries + q];
+                double tolerance = algorithm == 2 ? (OpenList::MONOTONE ? 1e-3 : INFINITY) : 1e-3 + OpenList::KEY_STEP*path.size();
+                worst[algorithm] = max(worst[algorithm], excess);
+                out_of_tolerance += excess > tolerance;
+            }
+        }
+    }
+
+    cout<<"  "<<name;
+    for(int k=name.size(); k<12; k++)
+        cout<<" ";
+    const char *labels[3] = {"A*", "Best-first", "Greedy"};
+    for(int algorithm=0; algorithm<3; algorithm++)
+        cout<<" | "<<labels[algorithm]<<" "<<ms[algorithm]<<" ms, "<<expansions[algorithm]<<" exp, cost "<<cost[algorithm]
+            <<" (+"<<worst[algorithm]<<")";
+    if(out_of_tolerance)
+        cout<<" | "<<out_of_tolerance<<" PATHS OVER TOLERANCE";
+    cout<<endl;
+    return out_of_tolerance;
 }
-bool NodeHandle::isVisited() const
+template<class OpenList>
+static int benchFlatOpenListPolicy(const string &name, const WalkableBitset &grid, const vector<Position> &cells, int queries, vector<double> &exact)
 {
-    return node->visited;
+    // A* of a flat grid engine (AdaptiveAStar, nothing learned) with the same tolerance 
+    AdaptiveAStar<OpenList> search(grid);
+    search.setLearning(false);
+    double ms = 0, cost = 0, worst = 0;
+    long long expansions = 0;
+    int out_of_tolerance = 0;
+    bool reference = exact.empty();
+    for(int q=0; q<queries; q++)
+    {
+        auto begin = chrono::steady_clock::now();
+        vector<Position> path = search.findPath(cells[2*q], cells[2*q+1]);
+        ms += elapsedMs(begin);
+        expansions += search.getExpansions();
+        double length = octileLength(path);
+        cost += length;
+        if(reference)
+            exact.push_back(length);
+        else
+        {
+            double excess = length - exact[q];
+            worst = max(worst, excess);
+            out_of_tolerance += excess > 1e-3 + OpenList::KEY_STEP*path.size();
+        }
+    }
+    cout<<"  "<<name;
+    for(int k=name.size(); k<12; k++)
+        cout<<" ";
+    cout<<" | flat A* "<<ms<<" ms, "<<expansions<<" exp, cost "<<cost<<" (+"<<worst<<")";
+    if(out_of_tolerance)
+        cout<<" | "<<out_of_tolerance<<" PATHS OVER TOLERANCE";
+    cout<<endl;
+    return out_of_tolerance;
 }
-bool NodeHandle::isWalkable() const
+static int benchOpenLists(int size, uint64_t seed)
 {
-    return node->is_walkable;
+    const int QUERIES = 10;
+    Game game(size);
+    game.setVisualize(false);
+    cout<<"Open list policies on "<<size<<"x"<<size<<" boards, "<<QUERIES<<" queries per algorithm, "
+        <<"(+n) the most a path costs over the binary heap's"<<endl;
+    int failures = 0;
+
+    for(int type=MazeGenerator::RECURSIVE_BACKTRACKER; type<=MazeGenerator::RANDOM_FILL; type++)
+    {
+        MazeGenerator::GeneratorType generator = (MazeGenerator::GeneratorType)type;
+        game.generateBoard(generator, seed, generator == MazeGenerator::RANDOM_FILL ? 0.25f : 0.42f);
+        vector<Position> cells = shuffledReachableCells(game, seed);
+        int queries = min(QUERIES, (int)cells.size()/2);
+
+        cout<<MazeGenerator::getName(generator)<<":"<<endl;
+        vector<double> exact;
+        failures += benchOpenListPolicy<BinaryHeapOpenList<NodeHandle> >("binary", game, cells, queries, exact);
+        failures += benchOpenListPolicy<QuaternaryHeapOpenList<NodeHandle> >("4-ary", game, cells, queries, exact);
+        failures += benchOpenListPolicy<PairingHeapOpenList<NodeHandle> >("pairing", game, cells, queries, exact);
+        failures += benchOpenListPolicy<RadixHeapOpenList<NodeHandle> >("radix", game, cells, queries, exact);
+        failures += benchOpenListPolicy<BucketQueueOpenList<NodeHandle> >("bucket", game, cells, queries, exact);
+        failures += benchOpenListPolicy<TwoLevelBucketOpenList<NodeHandle> >("2-level", game, cells, queries, exact);
+
+        WalkableBitset grid(game);
+        vector<double> flat_exact;
+        failures += benchFlatOpenListPolicy<BinaryHeapOpenList<int> >("binary", grid, cells, queries, flat_exact);
+        failures += benchFlatOpenListPolicy<PairingHeapOpenList<int> >("pairing", grid, cells, queries, flat_exact);
+        failures += benchFlatOpenListPolicy<RadixHeapOpenList<int> >("radix", grid, cells, queries, flat_exact);
+        failures += benchFlatOpenListPolicy<BucketQueueOpenList<int> >("bucket", grid, cells, queries, flat_exact);
+        failures += benchFlatOpenListPolicy<TwoLevelBucketOpenList<int> >("2-level", grid, cells, queries, flat_exact);
+    }
+    return failures > 0;
 }
-void NodeHandle::markAsExplored(bool val)
+int runBenchmark(int argc, char** argv)
 {
-    node->explored = val;
+    string suite = argc > 2 ? argv[2] : "";
+    int size = argc > 3 ? atoi(argv[3]) : -1;
+    uint64_t seed = argc > 4 ? strtoull(argv[4], NULL, 10) : 1;
+
+    if(suite == "generators")
+        return benchGenerators(size > 0 ? size : 2001, seed);
+    if(suite == "agents")
+        return benchAgents(size > 0 ? size : 129, seed);
+    if(suite == "anyangle")
+        return benchAnyAngle(size > 0 ? size : 257, seed);
+    if(suite == "cache")
+        return benchCache(size > 0 ? size : 257, seed);
+    if(suite == "openlist")
+        return benchOpenLists(size > 0 ? size : 257, seed);
+    if(suite == "anytime")
+        return benchAnytime(size > 0 ? size : 257, seed);
+    if(suite == "subgoal")
+        return benchSubgoals(size > 0 ? size : 257, seed);
+    if(suite == "cpd")
+        return benchPathDatabase(size > 0 ? size : 97, seed);
+    if(suite == "junction")
+        return benchJunctions(size > 0 ? size : 257, seed);
+    if(suite == "trace")
+        return benchTrace(size > 0 ? size : 129, seed);
+    if(suite == "targets")
+        return benchTargets(size > 0 ? size : 257, seed);
+    if(suite == "bfs")
+        return benchParallelBfs(size > 0 ? size : 10000, seed);
+    if(suite == "snapshot")
+        return benchSnapshots(size > 0 ? size : 1025, seed);
+    if(suite == "daemon")
+        return benchDaemon(size > 0 ? size : 257, seed);
+    if(suite == "layout")
+        return benchLayouts(size > 0 ? size : 1025, seed);
+    if(suite == "route")
+        return benchRoutes(size > 0 ? size : 257, seed);
+    if(suite == "portfolio")
+        return benchPortfolio(size > 0 ? size : 257, seed);
+    if(suite == "kernel")
+        return benchKernels(size > 0 ? size : 1025, seed);
+    if(suite == "adaptive")
+        return benchAdaptive(size > 0 ? size : 257, seed);
+    if(suite == "sma")
+        return benchMemoryBounded(size > 0 ? size : 129, seed);
+    if(suite == "voxel")
+        return benchVoxels(size > 0 ? size : 512, seed);
+    if(suite == "viewport")
+        return benchViewport(size > 0 ? size : 5000, seed);
+    if(suite == "alternatives")
+        return benchAlternatives(size > 0 ? size : 257, seed);
+
+    cout<<"Usage: "<<argv[0]<<" --bench <suite> [size] [seed]"<<endl;
+    cout<<"Suites: generators, agents, anyangle, cache, openlist, anytime, subgoal, cpd, junction, trace, targets, bfs, snapshot, daemon, layout, route, portfolio, kernel, adaptive, sma, voxel, viewport, alternatives"<<endl;
+    return 1;
 }
-void NodeHandle::markAsVisited(bool val)
+
+
+// Path server section --> 
+PathServer::PathServer(const WalkableBitset &grid, int threads) : grid(grid), next_job(0)
 {
-    node->visited = val;
+    listen_fd = -1;
+    thread_count = threads > 0 ? threads : max(1u, thread::hardware_concurrency());
+    for(int t=0; t<thread_count; t++)
+        searches.push_back(new AnytimeSearch<>(grid));
+    serving = team_done = false;
+    requests = batches = accepted = bad_requests = unreachable = 0;
+    largest_batch = 0;
+    started = chrono::steady_clock::now();
 }
-void NodeHandle::operator=(Node* node_ptr)
+PathServer::~PathServer()
 {
-    node=node_ptr;
+    for(int k=0; k<connections.size(); k++)
+        close(connections[k].fd);
+    if(listen_fd >= 0)
+    {
+        close(listen_fd);
+        unlink(socket_path.c_str());
+    }
+    for(int t=0; t<searches.size(); t++)
+        delete searches[t];
 }
-void NodeHandle::operator=(Node &other)
+void PathServer::acceptConnections()
 {
-    node=&other;
+    while(true)
+    {
+        int fd = accept(listen_fd, NULL, NULL);
+        if(fd < 0)
+            return;
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        Connection connection;
+        connection.fd = fd;
+        connection.closed = false;
+        connections.push_back(connection);
+        accepted++;
+    }
 }
-bool NodeHandle::operator==(const NodeHandle &second) const
+string PathServer::encode(const Request &request, uint8_t status, float cost, const string &payload)
 {
-    if(node == second.node)
-        return true;
-    return false;
+    Response response;
+    memset(&response, 0, sizeof(response));
+    response.id = request.id;
+    response.status = status;
+    response.cost = cost;
+    response.length = payload.size();
+    string bytes((const char*)&response, sizeof(response));
+    return bytes + payload;
 }
-bool NodeHandle::operator!=(const NodeHandle &second) const
+string PathServer::getStats() const
 {
-    if(node != second.node)
-        return true;
-    return false;
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+    ostringstream out;
+    out<<"uptime "<<seconds<<" s, "<<thread_count<<" threads, "<<accepted<<" connections ("<<connections.size()<<" open), "
+       <<requests<<" queries ("<<requests/max(1e-9, seconds)<<" per second), "<<batches<<" batches (mean "
+       <<requests/(double)max(1LL, batches)<<", largest "<<largest_batch<<"), "<<unreachable<<" without a path, "
+       <<bad_requests<<" bad requests";
+    return out.str();
 }
-bool NodeHandle::operator<(const NodeHandle &second) const
+bool PathServer::listen(const string &socket_path)
 {
-    if(getPosition().row < second.getPosition().row)
-        return true;
-    return false;
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if(socket_path.size() >= sizeof(address.sun_path))
+    {
+        errno = ENAMETOOLONG;
+        return false;
+    }
+    strcpy(address.sun_path, socket_path.c_str());
+
+    // a socket file left behind by an earlier run is replaced 
+    unlink(socket_path.c_str());
+    listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(listen_fd < 0)
+        return false;
+    if(bind(listen_fd, (sockaddr*)&address, sizeof(address)) != 0 || ::listen(listen_fd, 128) != 0)
+    {
+        close(listen_fd);
+        listen_fd = -1;
+        return false;
+    }
+    fcntl(listen_fd, F_SETFL, fcntl(listen_fd, F_GETFL) | O_NONBLOCK);
+    this->socket_path = socket_path;
+    return true;
 }
-bool NodeHandle::pointsTo(const Node &node) const
+void PathServer::parseRequests(int index)
 {
-    if(this->node == &node)
-        return true;
-    return false;
+    // whole requests only; what does not fit in this batch waits for the next 
+    Connection &connection = connections[index];
+    size_t used = 0;
+    while(connection.in.size() - used >= sizeof(Request) && batch.size() < MAX_BATCH && serving)
+    {
+        Request request;
+        memcpy(&request, connection.in.data() + used, sizeof(request));
+        used += sizeof(request);
+
+        if(request.op == OP_PATH || request.op == OP_COST || request.op == OP_ROUTE)
+        {
+            if(request.from_row >= grid.getSize() || request.from_col >= grid.getSize()
+               || request.to_row >= grid.getSize() || request.to_col >= grid.getSize())
+            {
+                bad_requests++;
+                connection.out += encode(request, STATUS_BAD_REQUEST, INFINITY, "");
+                continue;
+            }
+            Job job;
+            job.connection = index;
+            job.request = request;
+            batch.push_back(job);
+        }
+        else if(request.op == OP_STATS)
+            connection.out += encode(request, STATUS_OK, 0, getStats());
+        else if(request.op == OP_SHUTDOWN)
+        {
+            connection.out += encode(request, STATUS_OK, 0, "");
+            serving = false;
+        }
+        else
+        {
+            bad_requests++;
+            connection.out += encode(request, STATUS_BAD_REQUEST, INFINITY, "");
+        }
+    }
+    connection.in.erase(0, used);
 }
-void NodeHandle::removeWall()
+void PathServer::readIn(Connection &connection)
 {
-    node->is_walkable = true;
+    char buffer[1<<16];
+    while(true)
+    {
+        ssize_t count = read(connection.fd, buffer, sizeof(buffer));
+        if(count > 0)
+            connection.in.append(buffer, count);
+        else
+        {
+            // requests already read are still answered after the peer closes its end 
+            if(count == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+                connection.closed = true;
+            if(count == 0 || errno != EINTR)
+                return;
+        }
+    }
 }
-void NodeHandle::setGCost(float cost)
+void PathServer::run()
 {
-    node->gCost=cost;
+    // the calling thread runs the event loop and is worker 0 of the team 
+    serving = true;
+    team_done = false;
+    ThreadBarrier barrier(thread_count);
+    vector<thread> team;
+    for(int t=1; t<thread_count; t++)
+        team.emplace_back(&PathServer::work, this, t, ref(barrier));
+
+    vector<pollfd> fds;
+    while(serving)
+    {
+        bool backlog = false;
+        fds.assign(1, pollfd());
+        fds[0].fd = listen_fd;
+        fds[0].events = POLLIN;
+        for(int k=0; k<connections.size(); k++)
+        {
+            pollfd entry;
+            entry.fd = connections[k].fd;
+            entry.events = POLLIN | (connections[k].out.empty() ? 0 : POLLOUT);
+            entry.revents = 0;
+            fds.push_back(entry);
+            backlog = backlog || connections[k].in.size() >= sizeof(Request);
+        }
+        if(poll(&fds[0], fds.size(), backlog ? 0 : -1) < 0 && errno != EINTR)
+            break;
+
+        if(fds[0].revents & POLLIN)
+            acceptConnections();
+        for(int k=0; k+1<fds.size(); k++)
+            if(fds[k+1].revents & (POLLIN | POLLHUP | POLLERR))
+                readIn(connections[k]);
+
+        // one batch from every connection, searched by the whole team 
+        batch.clear();
+        for(int k=0; k<connections.size() && batch.size() < MAX_BATCH; k++)
+            parseRequests(k);
+        if(!batch.empty())
+        {
+            next_job = 0;
+            barrier.wait();
+            searchBatch(0);
+            barrier.wait();
+            for(int j=0; j<batch.size(); j++)
+                connections[batch[j].connection].out += batch[j].response;
+            requests += batch.size();
+            batches++;
+            largest_batch = max(largest_batch, batch.size());
+        }
+
+        for(int k=0; k<connections.size(); k++)
+            if(!connections[k].out.empty())
+                writeOut(connections[k]);
+        for(int k=connections.size()-1; k>=0; k--)
+            if(connections[k].closed && connections[k].out.empty() && connections[k].in.size() < sizeof(Request))
+            {
+                close(connections[k].fd);
+                connections.erase(connections.begin() + k);
+            }
+    }
+
+    // release the team from its barrier 
+    team_done = true;
+    barrier.wait();
+    for(int t=0; t<team.size(); t++)
+        team[t].join();
 }
-void NodeHandle::setHCost(float cost)
+void PathServer::searchBatch(int thread)
 {
-    node->hCost = cost;
+    AnytimeSearch<> &search = *searches[thread];
+    while(true)
+    {
+        int j = next_job.fetch_add(1);
+        if(j >= batch.size())
+            return;
+        Job &job = batch[j];
+        const Request &request = job.request;
+        const CompactPath &path = search.weightedAStarRoute(Position(request.from_row, request.from_col), Position(request.to_row, request.to_col), 1.0f);
+        if(path.empty())
+        {
+            job.response = encode(request, STATUS_NO_PATH, INFINITY, "");
+            unreachable++;
+            continue;
+        }
+
+        // expanded straight from the runs, the search's buffer is never copied 
+        string payload;
+        if(request.op == OP_PATH)
+        {
+            payload.resize(path.size() * 2 * sizeof(uint16_t));
+            uint16_t *cells = (uint16_t*)&payload[0];
+            for(CompactPath::Iterator it=path.begin(); it!=path.end(); ++it, cells+=2)
+            {
+                cells[0] = (*it).row;
+                cells[1] = (*it).col;
+            }
+        }
+        else if(request.op == OP_ROUTE)
+            path.encode(payload);
+        job.response = encode(request, STATUS_OK, search.getPathCost(), payload);
+    }
 }
-void NodeHandle::setNodeHandle(Node &node)
+void PathServer::work(int thread, ThreadBarrier &barrier)
 {
-    this->node = &node;
+    while(true)
+    {
+        barrier.wait();
+        if(team_done)
+            return;
+        searchBatch(thread);
+        barrier.wait();
+    }
 }
-void NodeHandle::setParent(NodeHandle new_parent)
+void PathServer::writeOut(Connection &connection)
 {
-    node->parent =  new_parent.node;
+    // MSG_NOSIGNAL: a client that went away is an error here, not SIGPIPE 
+    size_t written = 0;
+    while(written < connection.out.size())
+    {
+        ssize_t count = send(connection.fd, connection.out.data() + written, connection.out.size() - written, MSG_NOSIGNAL);
+        if(count > 0)
+            written += count;
+        else if(count < 0 && errno == EINTR)
+            continue;
+        else
+        {
+            if(errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                // nobody left to answer 
+                connection.closed = true;
+                connection.in.clear();
+                written = connection.out.size();
+            }
+            break;
+        }
+    }
+    connection.out.erase(0, written);
 }
-void NodeHandle::setPosition(Position pos)
+
+
+// PathLoadGenerator Method definations --> 
+PathLoadGenerator::PathLoadGenerator(const string &socket_path, const vector<Position> &cells)
 {
-    node->setPosition(pos);
+    this->socket_path = socket_path;
+    this->cells = cells;
+    failed = 0;
+    seconds = 0;
 }
-void NodeHandle::toggle()
+bool PathLoadGenerator::client(int index, int requests, int pipeline, uint8_t op, vector<double> &latencies, long long &failures)
 {
-    node->is_walkable = !node->is_walkable;
-}
+    int fd = connectTo(socket_path);
+    if(fd < 0)
+        return false;
+
+    Random random(Random::mix(index, cells.size()));
+    vector<chrono::steady_clock::time_point> sent_at(requests);
+    int sent = 0, received = 0;
+    bool ok = true;
+    string payload;
+    while(received < requests && ok)
+    {
+        // top the pipeline up in one write, then wait for one response 
+        string out;
+        while(sent < requests && sent - received < pipeline)
+        {
+            PathServer::Request request;
+            memset(&request, 0, sizeof(request));
+            request.id = sent;
+            request.op = op;
+            Position from = cells[random.nextInt(cells.size())], to = cells[random.nextInt(cells.size())];
+            request.from_row = from.row;
+            request.from_col = from.col;
+            request.to_row = to.row;
+            request.to_col = to.col;
+            out.append((const char*)&request, sizeof(request));
+            sent_at[sent++] = chrono::steady_clock::now();
+        }
+        if(!out.empty() && !writeFully(fd, out.data(), out.size()))
+            break;
 
-// Position Method definations -->
-Position::Position(int r, int c)
-{
-    this->row=r;
-    this->col=c;
+        PathServer::Response response;
+        ok = readFully(fd, &response, sizeof(response)) && response.id < sent;
+        payload.resize(ok ? response.length : 0);
+        ok = ok && readFully(fd, &payload[0], payload.size());
+        if(!ok)
+            break;
+        latencies.push_back(chrono::duration<double, milli>(chrono::steady_clock::now() - sent_at[response.id]).count());
+        CompactPath route;
+        if(response.status != PathServer::STATUS_OK || (op == PathServer::OP_ROUTE && !route.decode((const uint8_t*)payload.data(), payload.size())))
+            failures++;
+        received++;
+    }
+    close(fd);
+    return received == requests;
 }
-bool Position::operator == (const Position &pos)
+int PathLoadGenerator::connectTo(const string &socket_path)
 {
-    if(row == pos.row && col == pos.col)
-        return true;
-    return false;
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if(socket_path.size() >= sizeof(address.sun_path))
+        return -1;
+    strcpy(address.sun_path, socket_path.c_str());
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(fd >= 0 && connect(fd, (sockaddr*)&address, sizeof(address)) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
 }
-Position Position::operator - (const Position &second_pos) const
+string PathLoadGenerator::fetchStats()
 {
-    Position distance;
-    distance.row = second_pos.row-row;
-    distance.col = second_pos.col-col;
-    return distance;
+    string payload;
+    return request(PathServer::OP_STATS, payload) ? payload : "";
 }
-
-std::ostream& operator<<(std::ostream& os, const Position& pos)
+int PathLoadGenerator::query(Position from, Position to)
 {
-    os << "(" << pos.row << ", " << pos.col << ")";
-    return os;
+    // one cost query on its own connection, the response status or -1 
+    string payload;
+    int status = -1;
+    return request(PathServer::OP_COST, payload, from, to, &status) ? status : -1;
 }
-
-Result::Result()
+bool PathLoadGenerator::readFully(int fd, void *data, size_t length)
 {
-    algorithm = "None";
-    search_cost = path_cost = 0;
-    status = "None";
+    size_t done = 0;
+    while(done < length)
+    {
+        ssize_t count = read(fd, (char*)data + done, length - done);
+        if(count < 0 && errno == EINTR)
+            continue;
+        if(count <= 0)
+            return false;
+        done += count;
+    }
+    return true;
 }
-void Result::reset()
+string PathLoadGenerator::report() const
 {
-    algorithm = "None";
-    search_cost = path_cost = 0;
-    status = "None";
+    if(latencies_ms.empty())
+        return "no responses";
+    vector<double> sorted = latencies_ms;
+    sort(sorted.begin(), sorted.end());
+    ostringstream out;
+    out<<sorted.size()<<" queries in "<<seconds*1000<<" ms: "<<sorted.size()/max(1e-9, seconds)<<" QPS, p50 "
+       <<sorted[sorted.size()/2]<<" ms, p99 "<<sorted[sorted.size()*99/100]<<" ms, p999 "<<sorted[sorted.size()*999/1000]
+       <<" ms, max "<<sorted.back()<<" ms, "<<failed<<" failed";
+    return out.str();
 }
-void Result::incSearchCost()
+bool PathLoadGenerator::request(uint8_t op, string &payload, Position from, Position to, int *status)
 {
-    search_cost++;
+    int fd = connectTo(socket_path);
+    if(fd < 0)
+        return false;
+    PathServer::Request request;
+    memset(&request, 0, sizeof(request));
+    request.op = op;
+    request.from_row = from.row;
+    request.from_col = from.col;
+    request.to_row = to.row;
+    request.to_col = to.col;
+    PathServer::Response response;
+    bool ok = writeFully(fd, &request, sizeof(request)) && readFully(fd, &response, sizeof(response));
+    payload.resize(ok ? response.length : 0);
+    ok = ok && readFully(fd, &payload[0], payload.size());
+    close(fd);
+    if(ok && status != NULL)
+        *status = response.status;
+    return ok;
 }
-void Result::incPathCost()
+bool PathLoadGenerator::run(int clients, int requests, int pipeline, uint8_t op)
 {
-    path_cost++;
+    // requests per client, each client on its own thread and connection 
+    if(cells.empty())
+        return false;
+    vector<vector<double> > latencies(clients);
+    vector<long long> failures(clients, 0);
+    vector<thread> threads;
+    atomic<int> complete(0);
+    auto begin = chrono::steady_clock::now();
+    for(int c=0; c<clients; c++)
+        threads.emplace_back([&, c]() {
+            latencies[c].reserve(requests);
+            if(client(c, requests, max(1, pipeline), op, latencies[c], failures[c]))
+                complete++;
+        });
+    for(int c=0; c<clients; c++)
+        threads[c].join();
+    seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+
+    latencies_ms.clear();
+    failed = 0;
+    for(int c=0; c<clients; c++)
+    {
+        latencies_ms.insert(latencies_ms.end(), latencies[c].begin(), latencies[c].end());
+        failed += failures[c];
+    }
+    return complete == clients;
 }
-void Result::display()
+bool PathLoadGenerator::shutdownServer()
 {
-    cout<<"\t===Result==="<<endl;
-    cout<<"Algorithm: "<<algorithm<<endl;
-    cout<<"Status: "<<status<<endl;
-    cout<<"Search nodes = "<<search_cost<<endl;
-    cout<<"Path nodes = "<<path_cost<<endl;
+    string payload;
+    return request(PathServer::OP_SHUTDOWN, payload);
 }
-void Result::setSuccess()
+bool PathLoadGenerator::writeFully(int fd, const void *data, size_t length)
 {
-    search_cost--;
-    path_cost++;
-    status = "Path Found Successfully";
+    size_t done = 0;
+    while(done < length)
+    {
+        ssize_t count = send(fd, (const char*)data + done, length - done, MSG_NOSIGNAL);
+        if(count < 0 && errno == EINTR)
+            continue;
+        if(count <= 0)
+            return false;
+        done += count;
+    }
+    return true;
 }
-void Result::setFailure()
+
+int runServer(int argc, char** argv)
 {
-    status = "Path Not Found!";
+    if(argc < 3)
+    {
+        cout<<"Usage: "<<argv[0]<<" --serve <socket> [size] [seed] [threads]"<<endl;
+        return 1;
+    }
+    string socket_path = argv[2];
+    int size = argc > 3 ? atoi(argv[3]) : 257;
+    uint64_t seed = argc > 4 ? strtoull(argv[4], NULL, 10) : 1;
+    int threads = argc > 5 ? atoi(argv[5]) : 0;
+    if(size < 2 || size > 65535)
+    {
+        cout<<"Board size has to be between 2 and 65535"<<endl;
+        return 1;
+    }
+
+    // the same cave board the load generator (and the benchmarks) build for a size and seed 
+    Game game(size);
+    game.setVisualize(false);
+    game.generateBoard(MazeGenerator::CELLULAR_AUTOMATA, seed, 0.4f);
+    WalkableBitset grid(game.snapshot());
+
+    PathServer server(grid, threads);
+    if(!server.listen(socket_path))
+    {
+        cout<<"Can not listen on "<<socket_path<<": "<<strerror(errno)<<endl;
+        return 1;
+    }
+    cout<<"Serving a "<<size<<"x"<<size<<" cave board (seed "<<seed<<") on "<<socket_path<<endl;
+    server.run();
+    cout<<server.getStats()<<endl;
+    return 0;
 }
-void Result::setAlgorithm(string algo)
+int runLoadGenerator(int argc, char** argv)
 {
-    algorithm = algo;
+    if(argc < 3)
+    {
+        cout<<"Usage: "<<argv[0]<<" --load <socket> [size] [seed] [clients] [requests per client] [pipeline] [shutdown]"<<endl;
+        return 1;
+    }
+    string socket_path = argv[2];
+    int size = argc > 3 ? atoi(argv[3]) : 257;
+    uint64_t seed = argc > 4 ? strtoull(argv[4], NULL, 10) : 1;
+    int clients = argc > 5 ? atoi(argv[5]) : 4;
+    int requests = argc > 6 ? atoi(argv[6]) : 1000;
+    int pipeline = argc > 7 ? atoi(argv[7]) : 16;
+    bool shutdown = argc > 8 && string(argv[8]) == "shutdown";
+
+    // endpoints from the server's board, so most queries have a path 
+    Game game(size);
+    game.setVisualize(false);
+    game.generateBoard(MazeGenerator::CELLULAR_AUTOMATA, seed, 0.4f);
+    PathLoadGenerator load(socket_path, shuffledReachableCells(game, seed));
+
+    bool ok = load.run(clients, requests, pipeline);
+    cout<<clients<<" clients, pipeline "<<pipeline<<": "<<load.report()<<endl;
+    cout<<"Server: "<<load.fetchStats()<<endl;
+    if(shutdown)
+        load.shutdownServer();
+    return ok ? 0 : 1;
 }
-
-